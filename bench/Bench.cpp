@@ -0,0 +1,103 @@
+#include "Bench.hpp"
+#include "CpuFeatures.hpp"
+#include <ctime>
+#include <thread>
+
+#define BENCH_DEFAULT_MIN_TIME 0.2    // seconds per case
+#define BENCH_MAX_ITERATIONS   (1ull << 30)
+
+static volatile uint32_t gSinkWord;
+static const void* volatile gSinkPointer;
+
+void BenchKeep(uint32_t value) { gSinkWord = value; }
+void BenchKeep(const void* pointer) { gSinkPointer = pointer; }
+
+double BenchResult::BytesPerSecond() const {
+    return bytes ? (double)bytes * (double)iterations / seconds : 0.0;
+}
+
+double BenchResult::NsPerWord() const {
+    if (words) return seconds * 1e9 / ((double)words * (double)iterations);
+    if (bytes) return seconds * 1e9 / ((double)bytes / 4.0 * (double)iterations);
+    return 0.0;
+}
+
+BenchRunner::BenchRunner() : mMinTime(BENCH_DEFAULT_MIN_TIME) {}
+
+bool BenchRunner::Matches(const std::string& name) const {
+    return mFilter.empty() || name.find(mFilter) != std::string::npos;
+}
+
+void BenchRunner::Run(const std::string& name, size_t bytes, size_t words, size_t threads,
+                      const std::function<void()>& fn) {
+    if (!Matches(name)) return;
+
+    using Clock = std::chrono::steady_clock;
+    fn();  // warm-up: page in buffers, fill caches, spin up pool workers
+
+    uint64_t iterations = 1;
+    double seconds = 0.0;
+    for (;;) {
+        const auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) fn();
+        seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= mMinTime || iterations >= BENCH_MAX_ITERATIONS) break;
+
+        // Aim past the minimum time using the rate seen so far, at most 10x per step
+        const double scale = seconds > 0.0 ? (mMinTime * 1.4) / seconds : 10.0;
+        iterations = (uint64_t)((double)iterations * std::clamp(scale, 2.0, 10.0));
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.bytes = bytes;
+    result.words = words;
+    result.threads = threads;
+    result.iterations = iterations;
+    result.seconds = seconds;
+    mResults.push_back(result);
+
+    if (bytes) {
+        std::printf("%-48s %12.1f ns %10.3f GB/s %8.3f ns/word\n", name.c_str(),
+                    result.NsPerIteration(), result.BytesPerSecond() / 1e9, result.NsPerWord());
+    } else {
+        std::printf("%-48s %12.1f ns %10s      %8.3f ns/word\n", name.c_str(),
+                    result.NsPerIteration(), "", result.NsPerWord());
+    }
+    std::fflush(stdout);
+}
+
+bool BenchRunner::WriteJson(const char* path) const {
+    FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+
+    const CpuFeatures& cpu = GetCpuFeatures();
+    char date[32] = {};
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::fprintf(file, "{\n  \"context\": {\n");
+    std::fprintf(file, "    \"date\": \"%s\",\n", date);
+    std::fprintf(file, "    \"num_cpus\": %u,\n", std::thread::hardware_concurrency());
+    std::fprintf(file, "    \"aesni\": %s, \"avx2\": %s, \"avx512f\": %s, \"vaes\": %s,\n",
+                 cpu.aesni ? "true" : "false", cpu.avx2 ? "true" : "false",
+                 cpu.avx512f ? "true" : "false", cpu.vaes ? "true" : "false");
+#ifdef NDEBUG
+    std::fprintf(file, "    \"library_build_type\": \"release\"\n");
+#else
+    std::fprintf(file, "    \"library_build_type\": \"debug\"\n");
+#endif
+    std::fprintf(file, "  },\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < mResults.size(); ++i) {
+        const BenchResult& r = mResults[i];
+        std::fprintf(file,
+                     "    {\"name\": \"%s\", \"iterations\": %llu, \"real_time\": %.3f, "
+                     "\"time_unit\": \"ns\", \"threads\": %zu, \"bytes\": %zu, "
+                     "\"bytes_per_second\": %.1f, \"ns_per_word\": %.4f}%s\n",
+                     r.name.c_str(), (unsigned long long)r.iterations, r.NsPerIteration(),
+                     r.threads, r.bytes, r.BytesPerSecond(), r.NsPerWord(),
+                     i + 1 < mResults.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    return std::fclose(file) == 0;
+}
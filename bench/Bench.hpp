@@ -0,0 +1,52 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "stdafx.h"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+
+// Minimal in-house benchmark harness in the spirit of Google Benchmark: each case is timed over
+// a doubling number of iterations until it runs for at least the minimum time, and the results
+// are written as JSON so two builds can be diffed for regressions.
+struct BenchResult {
+    std::string name;
+    size_t      bytes = 0;       // bytes processed per iteration (0 = word benchmark)
+    size_t      words = 0;       // 32-bit words produced per iteration (0 = byte benchmark)
+    size_t      threads = 1;
+    uint64_t    iterations = 0;
+    double      seconds = 0.0;   // total wall time over all iterations
+
+    double NsPerIteration() const { return seconds * 1e9 / (double)iterations; }
+    double BytesPerSecond() const;
+    double NsPerWord() const;
+};
+
+class BenchRunner {
+public:
+    BenchRunner();
+
+    void SetMinTime(double seconds) { mMinTime = seconds; }
+    void SetFilter(std::string filter) { mFilter = std::move(filter); }
+
+    bool Matches(const std::string& name) const;
+
+    // fn runs one iteration; bytes/words describe the work one iteration does.
+    void Run(const std::string& name, size_t bytes, size_t words, size_t threads,
+             const std::function<void()>& fn);
+
+    const std::vector<BenchResult>& Results() const { return mResults; }
+    bool WriteJson(const char* path) const;
+
+private:
+    double                   mMinTime;
+    std::string              mFilter;
+    std::vector<BenchResult> mResults;
+};
+
+// Keeps a value alive so the optimizer cannot drop the work that produced it.
+void BenchKeep(uint32_t value);
+void BenchKeep(const void* pointer);
+
+#endif
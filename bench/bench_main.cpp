@@ -0,0 +1,216 @@
+#include "Bench.hpp"
+#include "Mersenne.hpp"
+#include "ChaCha20Counter.hpp"
+#include "AESCounter.hpp"
+#include "CopyCipher.h"
+#include "AesCtrCipher.h"
+#include "ChaCha20Cipher.h"
+#include "ChaCha20Poly1305Cipher.h"
+#include "ParallelCipher.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <thread>
+
+// hello-qt-bench [--json=FILE] [--filter=SUBSTRING] [--max-size=BYTES] [--min-time=SECONDS]
+//                [--max-threads=N]
+
+#define BENCH_MIN_SIZE        64ull
+#define BENCH_MAX_SIZE        (1ull << 30)   // 1 GiB
+#define BENCH_SLOW_MAX_SIZE   (16ull << 20)  // software AES / scalar paths stop here
+#define BENCH_PARALLEL_MIN    (64ull << 10)  // thread sweeps start here
+#define BENCH_GET_WORDS       4096
+
+static const uint8_t kKey[32] = {
+    0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+    0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f
+};
+static const uint8_t kIV[16] = { 0,0,0,0,0,0,0,0x4a,0,0,0,0,0,0,0,0 };
+
+static std::string SizeLabel(size_t n) {
+    char text[32];
+    if (n >= (1u << 30) && n % (1u << 30) == 0)      std::snprintf(text, sizeof(text), "%zuG", n >> 30);
+    else if (n >= (1u << 20) && n % (1u << 20) == 0) std::snprintf(text, sizeof(text), "%zuM", n >> 20);
+    else if (n >= (1u << 10) && n % (1u << 10) == 0) std::snprintf(text, sizeof(text), "%zuK", n >> 10);
+    else                                             std::snprintf(text, sizeof(text), "%zu", n);
+    return text;
+}
+
+static const char* AesBackendName(AESBackend backend) {
+    switch (backend) {
+    case AESBackend::Reference: return "Reference";
+    case AESBackend::TTable:    return "TTable";
+    case AESBackend::Bitsliced: return "Bitsliced";
+    case AESBackend::AESNI:     return "AESNI";
+    case AESBackend::VAES:      return "VAES";
+    default:                    return "Auto";
+    }
+}
+
+static const char* ChaChaBackendName(ChaChaBackend backend) {
+    switch (backend) {
+    case ChaChaBackend::Scalar: return "Scalar";
+    case ChaChaBackend::SSE2:   return "SSE2";
+    case ChaChaBackend::AVX2:   return "AVX2";
+    case ChaChaBackend::AVX512: return "AVX512";
+    default:                    return "Auto";
+    }
+}
+
+static const char* CopyModeName(CopyCipherMode mode) {
+    switch (mode) {
+    case CopyCipherMode::ByteByByte: return "ByteByByte";
+    case CopyCipherMode::Wide:       return "Wide";
+    default:                         return "Streaming";
+    }
+}
+
+template<typename Generator>
+static void BenchGet(BenchRunner& runner, const std::string& name, Generator& generator) {
+    runner.Run(name, 0, BENCH_GET_WORDS, 1, [&] {
+        uint32_t acc = 0;
+        for (int i = 0; i < BENCH_GET_WORDS; ++i) acc ^= generator.Get();
+        BenchKeep(acc);
+    });
+}
+
+template<typename CipherType>
+static void BenchCipher(BenchRunner& runner, const std::string& name, CipherType& cipher,
+                        std::span<const std::byte> in, std::byte* out, size_t threads) {
+    runner.Run(name, in.size(), 0, threads, [&] {
+        (void)cipher.encrypt(in, out);
+        BenchKeep(out);
+    });
+}
+
+int main(int argc, char** argv) {
+    BenchRunner runner;
+    const char* jsonPath = nullptr;
+    size_t maxSize = BENCH_MAX_SIZE;
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strncmp(arg, "--json=", 7) == 0)             jsonPath = arg + 7;
+        else if (std::strncmp(arg, "--filter=", 9) == 0)      runner.SetFilter(arg + 9);
+        else if (std::strncmp(arg, "--max-size=", 11) == 0)   maxSize = std::strtoull(arg + 11, nullptr, 10);
+        else if (std::strncmp(arg, "--min-time=", 11) == 0)   runner.SetMinTime(std::atof(arg + 11));
+        else if (std::strncmp(arg, "--max-threads=", 14) == 0) maxThreads = std::strtoull(arg + 14, nullptr, 10);
+        else {
+            std::fprintf(stderr, "usage: %s [--json=FILE] [--filter=SUBSTRING] [--max-size=BYTES] "
+                                 "[--min-time=SECONDS] [--max-threads=N]\n", argv[0]);
+            return 2;
+        }
+    }
+    maxSize = std::clamp<size_t>(maxSize, BENCH_MIN_SIZE, BENCH_MAX_SIZE);
+    maxThreads = std::max<size_t>(1, maxThreads);
+
+    // ---- word generators ----
+    {
+        Mersenne mersenne(5489u);
+        BenchGet(runner, "Mersenne/Get", mersenne);
+
+        std::vector<uint32_t> words(BENCH_GET_WORDS);
+        runner.Run("Mersenne/Fill", 0, BENCH_GET_WORDS, 1, [&] {
+            mersenne.Fill(words);
+            BenchKeep(words.data());
+        });
+
+        ChaCha20Counter chacha;
+        chacha.SeedKeyNonce(kKey, kIV);
+        BenchGet(runner, "ChaCha20Counter/Get", chacha);
+
+        AESCounter aes;
+        aes.SeedKeyIV(kKey, kIV);
+        BenchGet(runner, "AESCounter/Get", aes);
+    }
+
+    // ---- bulk APIs, one buffer pair shared by every size ----
+    std::unique_ptr<std::byte[]> inStorage, outStorage;
+    while (!inStorage || !outStorage) {
+        inStorage.reset(new (std::nothrow) std::byte[maxSize]);
+        outStorage.reset(new (std::nothrow) std::byte[maxSize]);
+        if (inStorage && outStorage) break;
+        if (maxSize <= BENCH_MIN_SIZE) { std::fprintf(stderr, "out of memory\n"); return 1; }
+        maxSize /= 2;
+        std::fprintf(stderr, "allocation failed, capping --max-size at %zu\n", maxSize);
+    }
+    for (size_t i = 0; i < maxSize; ++i) inStorage[i] = std::byte(i * 131u + 7u);
+    std::memset(outStorage.get(), 0, maxSize);
+
+    std::vector<size_t> threadCounts;
+    for (size_t t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    for (size_t size = BENCH_MIN_SIZE; size <= maxSize; size *= 4) {
+        const std::string label = SizeLabel(size);
+        const std::span<const std::byte> in(inStorage.get(), size);
+        const std::span<std::byte> out(outStorage.get(), size);
+        const bool slowAllowed = size <= BENCH_SLOW_MAX_SIZE;
+
+        for (AESBackend backend : { AESBackend::Reference, AESBackend::TTable, AESBackend::Bitsliced,
+                                    AESBackend::AESNI, AESBackend::VAES }) {
+            if (!AESCounter::IsBackendSupported(backend)) continue;
+            const bool hardware = backend == AESBackend::AESNI || backend == AESBackend::VAES;
+            if (!hardware && !slowAllowed) continue;
+            AESCounter aes;
+            aes.SetBackend(backend);
+            aes.SeedKeyIV(kKey, kIV);
+            runner.Run(std::string("AESCounter/Generate/") + AesBackendName(backend) + "/" + label,
+                       size, 0, 1, [&] { aes.Generate(out); BenchKeep(out.data()); });
+        }
+
+        for (ChaChaBackend backend : { ChaChaBackend::Scalar, ChaChaBackend::SSE2,
+                                       ChaChaBackend::AVX2, ChaChaBackend::AVX512 }) {
+            if (!ChaCha20Counter::IsBackendSupported(backend)) continue;
+            if (backend == ChaChaBackend::Scalar && !slowAllowed) continue;
+            ChaCha20Counter chacha;
+            chacha.SetBackend(backend);
+            chacha.SeedKeyNonce(kKey, kIV);
+            runner.Run(std::string("ChaCha20Counter/Generate/") + ChaChaBackendName(backend) + "/" + label,
+                       size, 0, 1, [&] { chacha.Generate(out); BenchKeep(out.data()); });
+        }
+
+        for (CopyCipherMode mode : { CopyCipherMode::ByteByByte, CopyCipherMode::Wide,
+                                     CopyCipherMode::Streaming }) {
+            CopyCipher copy{ mode };
+            BenchCipher(runner, std::string("CopyCipher/") + CopyModeName(mode) + "/" + label,
+                        copy, in, out.data(), 1);
+        }
+
+        AesCtrCipher aesCipher(kKey, kIV);
+        BenchCipher(runner, "AesCtrCipher/" + label, aesCipher, in, out.data(), 1);
+        ChaCha20Cipher chachaCipher(kKey, kIV);
+        BenchCipher(runner, "ChaCha20Cipher/" + label, chachaCipher, in, out.data(), 1);
+        ChaCha20Poly1305Cipher aeadCipher(kKey, kIV);
+        runner.Run("ChaCha20Poly1305Cipher/" + label, size, 0, 1, [&] {
+            aeadCipher.restart(0);   // one sealed message per run, tag included
+            (void)aeadCipher.encrypt(in, out.data());
+            const Poly1305Tag tag = aeadCipher.tag();
+            BenchKeep(tag.data());
+        });
+
+        if (size < BENCH_PARALLEL_MIN) continue;
+        for (size_t threads : threadCounts) {
+            // The pool plus the calling thread make `threads` workers; one thread gets one chunk
+            ThreadPool pool(threads > 1 ? threads - 1 : 1);
+            const size_t chunk = threads > 1
+                ? std::max<size_t>(BENCH_PARALLEL_MIN / 4, size / (threads * 4)) : size;
+            const std::string suffix = "/" + label + "/threads:" + std::to_string(threads);
+
+            ParallelCipher<AesCtrCipher> parallelAes(AesCtrCipher(kKey, kIV), pool, chunk);
+            BenchCipher(runner, "ParallelCipher<AesCtrCipher>" + suffix, parallelAes, in, out.data(), threads);
+            ParallelCipher<ChaCha20Cipher> parallelChaCha(ChaCha20Cipher(kKey, kIV), pool, chunk);
+            BenchCipher(runner, "ParallelCipher<ChaCha20Cipher>" + suffix, parallelChaCha, in, out.data(), threads);
+            ParallelCipher<CopyCipher> parallelCopy(CopyCipher{ CopyCipherMode::Wide }, pool, chunk);
+            BenchCipher(runner, "ParallelCipher<CopyCipher>" + suffix, parallelCopy, in, out.data(), threads);
+        }
+    }
+
+    if (jsonPath && !runner.WriteJson(jsonPath)) {
+        std::fprintf(stderr, "could not write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,314 @@
+#include "PackEngine.hpp"
+#include "PackFormat.hpp"
+#include "ThreadPool.hpp"
+#include <chrono>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+// hello-qt-cli: the pack engine without the window, for scripts, CI and headless servers.
+//
+//   hello-qt-cli pack    INPUT OUTPUT_DIR          -> OUTPUT_DIR/<input name>.pack
+//   hello-qt-cli unpack  PACK OUTPUT_DIR [PATTERN...]   only entries matching a path or glob, if any
+//   hello-qt-cli extract PACK ENTRY OUTPUT_DIR
+//   hello-qt-cli list    PACK
+//   hello-qt-cli verify  PACK                      every chunk's checksum and the hash tree; no key needed
+//   hello-qt-cli batch   FILE|-                    one command per line, '#' starts a comment
+//
+// Options, before or after the operands (on a batch line they override the batch's own):
+//   --threads=N         pool size up to CLI_MAX_THREADS, 0 = one per core (default)
+//   --cipher=NAME       none | chacha20 (default) | aes-ctr | chacha20-poly1305 (authenticated chunks)
+//   --key=HEX           64 hex digits; all-zero by default
+//   --chunk-size=SIZE   bytes, or with a K / M suffix; PACK_MIN_CHUNK .. PACK_MAX_CHUNK
+//   --io=NAME           auto (default) | io_uring | threads
+//   --level=N           LZ77 level, 0 (store) .. LZ77_MAX_LEVEL
+//   --dedup             content-defined chunks, each stored once (version 2 archive)
+//   --tree              keep a hash tree root over every chunk in the index
+//   --progress          progress on stderr
+//
+// A batch runs every job in one process on one engine, so thread pools, chunk buffers and the
+// extraction I/O backend are set up once rather than per job; it keeps going past failures. The exit status is 0
+// when every job succeeded, 1 when any failed, 2 on a usage error.
+
+#define CLI_PROGRESS_INTERVAL_MS 100
+#define CLI_MAX_THREADS 1024
+
+struct CliJob {
+    std::string              command;
+    std::vector<std::string> operands;
+    PackOptions              options;
+    IoBackendKind            io = IoBackendKind::Auto;
+    size_t                   threads = 0;
+    bool                     progress = false;
+};
+
+static const char* kUsage =
+    "usage: hello-qt-cli pack INPUT OUTPUT_DIR | unpack PACK OUTPUT_DIR [PATTERN...] | extract PACK ENTRY OUTPUT_DIR\n"
+    "                    | list PACK | verify PACK | batch FILE|-\n"
+    "       [--threads=N] [--cipher=none|chacha20|aes-ctr|chacha20-poly1305] [--key=HEX] [--chunk-size=SIZE]\n"
+    "       [--io=auto|io_uring|threads] [--level=N] [--dedup] [--tree] [--progress]\n";
+
+static const char* CipherName(PackCipher cipher) {
+    switch (cipher) {
+    case PackCipher::None:     return "none";
+    case PackCipher::ChaCha20: return "chacha20";
+    case PackCipher::AesCtr:   return "aes-ctr";
+    case PackCipher::ChaCha20Poly1305: return "chacha20-poly1305";
+    }
+    return "unknown";
+}
+
+// Digits only: strtoull would also take leading space and a sign, and wrap "-1" to 2^64 - 1.
+static bool ParseSize(const char* text, uint64_t& out) {
+    if (!std::isdigit((unsigned char)text[0])) return false;
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long value = std::strtoull(text, &end, 10);
+    if (errno == ERANGE) return false;
+    uint64_t scale = 1;
+    if (*end == 'K' || *end == 'k') { scale = 1ull << 10; ++end; }
+    else if (*end == 'M' || *end == 'm') { scale = 1ull << 20; ++end; }
+    if (*end != '\0' || value > UINT64_MAX / scale) return false;
+    out = value * scale;
+    return true;
+}
+
+static bool ParseKey(const char* hex, uint8_t key[PACK_KEY_SIZE]) {
+    if (std::strlen(hex) != 2 * PACK_KEY_SIZE) return false;
+    for (size_t i = 0; i < PACK_KEY_SIZE; ++i) {
+        const char pair[3] = { hex[2 * i], hex[2 * i + 1], '\0' };
+        if (!std::isxdigit((unsigned char)pair[0]) || !std::isxdigit((unsigned char)pair[1])) return false;
+        key[i] = (uint8_t)std::strtoul(pair, nullptr, 16);
+    }
+    return true;
+}
+
+// Applies one argument to `job`: an option, or the command / next operand. Returns an error
+// message, empty on success.
+static std::string ParseArgument(const std::string& arg, CliJob& job) {
+    const size_t eq = arg.find('=');
+    const std::string name = arg.substr(0, eq);
+    const char* value = eq == std::string::npos ? "" : arg.c_str() + eq + 1;
+    uint64_t number = 0;
+
+    if (arg.rfind("--", 0) != 0) {
+        if (job.command.empty()) job.command = arg;
+        else job.operands.push_back(arg);
+    } else if (name == "--threads") {
+        if (!ParseSize(value, number) || number > CLI_MAX_THREADS) return "bad --threads: " + arg;
+        job.threads = (size_t)number;
+    } else if (name == "--cipher") {
+        const std::string cipher = value;
+        if (cipher == "none")          job.options.cipher = PackCipher::None;
+        else if (cipher == "chacha20") job.options.cipher = PackCipher::ChaCha20;
+        else if (cipher == "aes-ctr")  job.options.cipher = PackCipher::AesCtr;
+        else if (cipher == "chacha20-poly1305") job.options.cipher = PackCipher::ChaCha20Poly1305;
+        else return "unknown cipher: " + cipher;
+    } else if (name == "--key") {
+        if (!ParseKey(value, job.options.key)) return "--key wants 64 hex digits";
+    } else if (name == "--chunk-size") {
+        if (!ParseSize(value, number) || number < PACK_MIN_CHUNK || number > PACK_MAX_CHUNK) {
+            return "bad --chunk-size: " + arg;
+        }
+        job.options.chunkSize = (uint32_t)number;
+    } else if (name == "--io") {
+        const std::string io = value;
+        if (io == "auto")                           job.io = IoBackendKind::Auto;
+        else if (io == "io_uring" || io == "uring") job.io = IoBackendKind::Uring;
+        else if (io == "threads")                   job.io = IoBackendKind::Threads;
+        else return "unknown I/O backend: " + io;
+    } else if (name == "--level") {
+        if (!ParseSize(value, number) || number > LZ77_MAX_LEVEL) return "bad --level: " + arg;
+        job.options.compressionLevel = (int)number;
+    } else if (arg == "--dedup") {
+        job.options.dedup = true;
+    } else if (arg == "--tree") {
+        job.options.tree = true;
+    } else if (arg == "--progress") {
+        job.progress = true;
+    } else {
+        return "unknown option: " + arg;
+    }
+    return "";
+}
+
+static std::string CheckOperands(const CliJob& job) {
+    static const std::map<std::string, std::pair<size_t, size_t>> kOperands = {   // least, most
+        { "pack", { 2, 2 } }, { "unpack", { 2, SIZE_MAX } }, { "extract", { 3, 3 } }, { "list", { 1, 1 } },
+        { "verify", { 1, 1 } }, { "batch", { 1, 1 } } };
+    const auto found = kOperands.find(job.command);
+    if (found == kOperands.end()) return job.command.empty() ? "no command" : "unknown command: " + job.command;
+    if (job.operands.size() < found->second.first || job.operands.size() > found->second.second) {
+        return job.command + ": wrong number of operands";
+    }
+    return "";
+}
+
+// Splits a batch line on whitespace; double quotes group a path with spaces in it.
+static std::vector<std::string> Tokenize(const std::string& line) {
+    std::vector<std::string> tokens;
+    std::string token;
+    bool quoted = false;
+    bool any = false;
+    for (char c : line) {
+        if (c == '"') { quoted = !quoted; any = true; continue; }
+        if (!quoted && c == '#') break;
+        if (!quoted && std::isspace((unsigned char)c)) {
+            if (any) tokens.push_back(std::move(token));
+            token.clear();
+            any = false;
+            continue;
+        }
+        token += c;
+        any = true;
+    }
+    if (any) tokens.push_back(std::move(token));
+    return tokens;
+}
+
+// One pool per thread count asked for, made on first use and kept for the whole process.
+class CliPools {
+public:
+    ThreadPool& Get(size_t threads) {
+        std::unique_ptr<ThreadPool>& pool = mPools[threads];
+        if (!pool) pool = std::make_unique<ThreadPool>(threads);
+        return *pool;
+    }
+
+private:
+    std::map<size_t, std::unique_ptr<ThreadPool>> mPools;
+};
+
+static int RunJob(const CliJob& job, PackEngine& engine, CliPools& pools) {
+    engine.SetOptions(job.options);
+    engine.SetIoBackend(job.io);
+    engine.SetThreadPool(pools.Get(job.threads));
+
+    auto lastReport = std::chrono::steady_clock::now();
+    engine.SetProgressCallback([&](const PackProgress& p) {
+        if (!job.progress) return;
+        const auto now = std::chrono::steady_clock::now();
+        if (p.bytesDone != p.bytesTotal && now - lastReport < std::chrono::milliseconds(CLI_PROGRESS_INTERVAL_MS)) return;
+        lastReport = now;
+        const double percent = p.bytesTotal ? 100.0 * (double)p.bytesDone / (double)p.bytesTotal : 100.0;
+        std::fprintf(stderr, "\r%5.1f%%  %8.1f MB/s  ETA %6.1fs", percent, p.BytesPerSecond() / 1e6,
+                     std::max(0.0, p.EtaSeconds()));
+        if (p.bytesDone == p.bytesTotal) std::fputc('\n', stderr);
+    });
+
+    std::error_code ec;
+    std::expected<std::string, PackError> result;
+    if (job.command == "pack") {
+        std::filesystem::create_directories(job.operands[1], ec);
+        result = engine.Pack(job.operands[0], job.operands[1]);
+    } else if (job.command == "unpack") {
+        result = engine.Unpack(job.operands[0], job.operands[1], std::span<const std::string>(job.operands).subspan(2));
+    } else if (job.command == "extract") {
+        result = engine.ExtractFile(job.operands[0], job.operands[1], job.operands[2]);
+    } else if (job.command == "verify") {
+        result = engine.Verify(job.operands[0]);
+    } else {
+        PackReader reader;
+        auto opened = reader.Open(job.operands[0], job.options.key);
+        if (!opened) {
+            result = std::unexpected(opened.error());
+        } else {
+            std::printf("# version %u, cipher %s, chunk size %u, %s, %zu entries, %zu chunks\n",
+                        (unsigned)reader.Version(), CipherName(reader.Cipher()), reader.ChunkSize(),
+                        reader.Compression() == PackCompression::Lz77 ? "lz77" : "stored",
+                        reader.Entries().size(), reader.Chunks().size());
+            if (reader.HasTree()) {
+                std::printf("# tree ");
+                for (uint8_t b : reader.TreeRoot()) std::printf("%02x", b);
+                std::printf("\n");
+            }
+            for (const PackEntry& e : reader.Entries()) {
+                std::printf("%12llu  %s\n", (unsigned long long)e.length, e.path.c_str());
+            }
+            return 0;
+        }
+    }
+
+    if (!result) {
+        std::fprintf(stderr, "hello-qt-cli: %s %s: %s\n", job.command.c_str(), job.operands[0].c_str(),
+                     PackErrorString(result.error()));
+        return 1;
+    }
+    std::printf("%s\n", result->c_str());
+    return 0;
+}
+
+static int RunBatch(const CliJob& defaults, PackEngine& engine, CliPools& pools) {
+    std::ifstream file;
+    const bool fromStdin = defaults.operands[0] == "-";
+    if (!fromStdin) {
+        file.open(defaults.operands[0]);
+        if (!file) {
+            std::fprintf(stderr, "hello-qt-cli: cannot open batch file %s\n", defaults.operands[0].c_str());
+            return 2;
+        }
+    }
+    std::istream& in = fromStdin ? std::cin : file;
+
+    size_t jobs = 0, failed = 0, lineNumber = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        const std::vector<std::string> tokens = Tokenize(line);
+        if (tokens.empty()) continue;
+
+        CliJob job = defaults;
+        job.command.clear();
+        job.operands.clear();
+        std::string error;
+        for (const std::string& token : tokens) {
+            error = ParseArgument(token, job);
+            if (!error.empty()) break;
+        }
+        if (error.empty()) error = CheckOperands(job);
+        if (error.empty() && job.command == "batch") error = "batches do not nest";
+        ++jobs;
+        if (!error.empty()) {
+            std::fprintf(stderr, "hello-qt-cli: line %zu: %s\n", lineNumber, error.c_str());
+            ++failed;
+            continue;
+        }
+        failed += RunJob(job, engine, pools) != 0;
+    }
+    std::fprintf(stderr, "hello-qt-cli: %zu jobs, %zu failed\n", jobs, failed);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    CliJob job;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            std::fputs(kUsage, stdout);
+            return 0;
+        }
+        std::string error = ParseArgument(arg, job);
+        if (!error.empty()) {
+            std::fprintf(stderr, "hello-qt-cli: %s\n%s", error.c_str(), kUsage);
+            return 2;
+        }
+    }
+    const std::string error = CheckOperands(job);
+    if (!error.empty()) {
+        std::fprintf(stderr, "hello-qt-cli: %s\n%s", error.c_str(), kUsage);
+        return 2;
+    }
+
+    CliPools pools;
+    PackEngine engine;
+    if (job.command == "batch") return RunBatch(job, engine, pools);
+    return RunJob(job, engine, pools);
+}
@@ -1,8 +1,11 @@
 #include "AESCounter.hpp"
+#include "AESCounterNI.hpp"
+#include "CpuFeatures.hpp"
 #include <cstring>
+#include <array>
 
 // ==================== S-BOX and RCON ====================
-static const uint8_t AES_SBOX[256] = {
+static constexpr uint8_t AES_SBOX[256] = {
     // 0x00 .. 0x0F
     0x63,0x7C,0x77,0x7B,0xF2,0x6B,0x6F,0xC5,0x30,0x01,0x67,0x2B,0xFE,0xD7,0xAB,0x76,
     // 0x10 .. 0x1F
@@ -45,6 +48,29 @@ static const uint32_t AES_RCON[15] = {
     0x6C000000u, 0xD8000000u, 0xAB000000u, 0x4D000000u
 };
 
+// ==================== T-tables ====================
+// AES_TE0[x] is the MixColumns column for S(x) entering row 0: (2*S, S, S, 3*S) big-endian.
+// Rows 1..3 are the same column rotated right by 8/16/24 bits, so one lookup per byte
+// does SubBytes and MixColumns together, and ShiftRows becomes the choice of source word.
+static constexpr uint8_t aes_xtime_c(uint8_t x) { return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1B : 0)); }
+
+static constexpr std::array<uint32_t, 256> MakeTe(unsigned rotate) {
+    std::array<uint32_t, 256> t{};
+    for (unsigned x = 0; x < 256; ++x) {
+        const uint8_t s1 = AES_SBOX[x];
+        const uint8_t s2 = aes_xtime_c(s1);
+        const uint8_t s3 = (uint8_t)(s2 ^ s1);
+        const uint32_t w = (uint32_t)s2 << 24 | (uint32_t)s1 << 16 | (uint32_t)s1 << 8 | (uint32_t)s3;
+        t[x] = rotate ? (w >> rotate) | (w << (32 - rotate)) : w;
+    }
+    return t;
+}
+
+static constexpr std::array<uint32_t, 256> AES_TE0 = MakeTe(0);
+static constexpr std::array<uint32_t, 256> AES_TE1 = MakeTe(8);
+static constexpr std::array<uint32_t, 256> AES_TE2 = MakeTe(16);
+static constexpr std::array<uint32_t, 256> AES_TE3 = MakeTe(24);
+
 // ==================== Utility ====================
 inline uint32_t AESCounter::LoadBE32(const uint8_t* p) {
     return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | (uint32_t)p[3];
@@ -69,9 +95,12 @@ void AESCounter::SecureZero(void* p, size_t n) {
 
 // ==================== Constructor / Clear ====================
 AESCounter::AESCounter()
-: mRoundCount(AES_ROUNDS), mBufUsed(sizeof(mBuf)), mSeeded(false) {
+: mRoundCount(AES_ROUNDS), mBlockIndex(0), mBufUsed(sizeof(mBuf)), mSeeded(false), mBackend(BestBackend()) {
     std::memset(mRoundKeys, 0, sizeof(mRoundKeys));
+    std::memset(mRoundKeyBytes, 0, sizeof(mRoundKeyBytes));
+    std::memset(mRoundKeyPlanes, 0, sizeof(mRoundKeyPlanes));
     std::memset(mCounter,   0, sizeof(mCounter));
+    std::memset(mIV,        0, sizeof(mIV));
     std::memset(mBuf,       0, sizeof(mBuf));
 }
 
@@ -81,16 +110,69 @@ AESCounter::~AESCounter() {
 
 void AESCounter::Clear() {
     SecureZero(mRoundKeys, sizeof(mRoundKeys));
+    SecureZero(mRoundKeyBytes, sizeof(mRoundKeyBytes));
+    SecureZero(mRoundKeyPlanes, sizeof(mRoundKeyPlanes));
     SecureZero(mCounter,   sizeof(mCounter));
+    SecureZero(mIV,        sizeof(mIV));
     SecureZero(mBuf,       sizeof(mBuf));
+    mBlockIndex = 0;
     mBufUsed = sizeof(mBuf);
     mSeeded = false;
 }
 
+bool AESCounter::IsBackendSupported(AESBackend backend) {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    switch (backend) {
+    case AESBackend::Auto:
+    case AESBackend::Reference:
+    case AESBackend::TTable:
+    case AESBackend::Bitsliced:
+        return true;
+    case AESBackend::AESNI:
+        return cpu.aesni && cpu.sse41;
+    case AESBackend::VAES:
+        return cpu.aesni && cpu.sse41 && cpu.avx512f && cpu.vaes;
+    }
+    return false;
+}
+
+AESBackend AESCounter::BestBackend() {
+    if (IsBackendSupported(AESBackend::VAES))  return AESBackend::VAES;
+    if (IsBackendSupported(AESBackend::AESNI)) return AESBackend::AESNI;
+    // No crypto extensions: prefer the constant-time kernel over the (faster, cache-leaky) tables
+    return AESBackend::Bitsliced;
+}
+
+bool AESCounter::SetBackend(AESBackend backend) {
+    if (backend == AESBackend::Auto) backend = BestBackend();
+    if (!IsBackendSupported(backend)) return false;
+    mBackend = backend;
+    return true;
+}
+
 // ==================== Key Expansion (AES-256) ====================
 static inline uint32_t rotl8(uint32_t w) { return (w << 8) | (w >> 24); }
 
 void AESCounter::ExpandKey256(const uint8_t key[AES_KEY_SIZE_BYTES]) {
+    if (IsHardwareBackend()) {
+        // aeskeygenassist emits the hardware layout directly; mirror it into words for software rounds
+        AesNiExpandKey256(key, mRoundKeyBytes);
+        for (int i = 0; i < 60; ++i) mRoundKeys[i] = LoadBE32(mRoundKeyBytes + 4 * i);
+        BitslicedKeyPlanes(mRoundKeyBytes, mRoundKeyPlanes);
+        mRoundCount = AES_ROUNDS;
+        return;
+    }
+
+    // The bitsliced backend evaluates SubWord as a circuit so the schedule is table-free too
+    const bool constantTime = (mBackend == AESBackend::Bitsliced);
+    auto subWord = [constantTime](uint32_t w) -> uint32_t {
+        if (constantTime) return BitslicedSubWord(w);
+        return ((uint32_t)AES_SBOX[(w >> 24) & 0xFF] << 24) |
+               ((uint32_t)AES_SBOX[(w >> 16) & 0xFF] << 16) |
+               ((uint32_t)AES_SBOX[(w >> 8)  & 0xFF] << 8)  |
+               ((uint32_t)AES_SBOX[(w)       & 0xFF]);
+    };
+
     // AES-256 key expansion yields 60 32-bit words
     uint32_t* W = mRoundKeys;
 
@@ -108,24 +190,18 @@ void AESCounter::ExpandKey256(const uint8_t key[AES_KEY_SIZE_BYTES]) {
             // RotWord
             temp = rotl8(temp);
             // SubWord
-            temp =
-                ((uint32_t)AES_SBOX[(temp >> 24) & 0xFF] << 24) |
-                ((uint32_t)AES_SBOX[(temp >> 16) & 0xFF] << 16) |
-                ((uint32_t)AES_SBOX[(temp >> 8)  & 0xFF] << 8)  |
-                ((uint32_t)AES_SBOX[(temp)       & 0xFF]);
+            temp = subWord(temp);
             // RCON
             temp ^= AES_RCON[i / 8];
         } else if (i % 8 == 4) {
             // SubWord only
-            temp =
-                ((uint32_t)AES_SBOX[(temp >> 24) & 0xFF] << 24) |
-                ((uint32_t)AES_SBOX[(temp >> 16) & 0xFF] << 16) |
-                ((uint32_t)AES_SBOX[(temp >> 8)  & 0xFF] << 8)  |
-                ((uint32_t)AES_SBOX[(temp)       & 0xFF]);
+            temp = subWord(temp);
         }
         W[i] = W[i - 8] ^ temp;
     }
 
+    for (int i = 0; i < 60; ++i) StoreBE32(mRoundKeyBytes + 4 * i, W[i]);
+    BitslicedKeyPlanes(mRoundKeyBytes, mRoundKeyPlanes);
     mRoundCount = AES_ROUNDS; // 14
 }
 
@@ -144,85 +220,142 @@ static void MixColumns(uint8_t s[16]) {
     }
 }
 
-void AESCounter::EncryptBlock(const uint8_t in[16], uint8_t out[16]) const {
-    // State as bytes
-    uint8_t s[16];
-    // Initial AddRoundKey: round 0
-    const uint32_t* rk = mRoundKeys;
-    // Load state (big-endian words per spec order)
+static inline void SubBytes(uint8_t s[16]) {
+    for (int i = 0; i < 16; ++i) s[i] = AES_SBOX[s[i]];
+}
+
+static inline void ShiftRows(uint8_t s[16]) {
+    uint8_t t;
+
+    // row 1: 1-byte left rotation
+    t = s[1]; s[1] = s[5]; s[5] = s[9]; s[9] = s[13]; s[13] = t;
+
+    // row 2: 2-byte rotation
+    t = s[2]; s[2] = s[10]; s[10] = t;
+    t = s[6]; s[6] = s[14]; s[14] = t;
+
+    // row 3: 3-byte rotation (or 1-byte right)
+    t = s[15]; s[15] = s[11]; s[11] = s[7]; s[7] = s[3]; s[3] = t;
+}
+
+static inline void AddRoundKey(const uint8_t in[16], uint8_t out[16], const uint32_t* rk) {
     for (int i = 0; i < 4; ++i) {
         uint32_t w = (uint32_t)in[4*i] << 24 |
                      (uint32_t)in[4*i+1] << 16 |
                      (uint32_t)in[4*i+2] << 8 |
                      (uint32_t)in[4*i+3];
         w ^= rk[i];
-        s[4*i+0] = (uint8_t)(w >> 24);
-        s[4*i+1] = (uint8_t)(w >> 16);
-        s[4*i+2] = (uint8_t)(w >> 8);
-        s[4*i+3] = (uint8_t)(w);
+        out[4*i+0] = (uint8_t)(w >> 24);
+        out[4*i+1] = (uint8_t)(w >> 16);
+        out[4*i+2] = (uint8_t)(w >> 8);
+        out[4*i+3] = (uint8_t)(w);
     }
+}
+
+void AESCounter::EncryptBlock(const uint8_t in[16], uint8_t out[16]) const {
+    if (mBackend != AESBackend::Reference) {
+        EncryptBlocks(in, out, 1);
+        return;
+    }
+
+    // State as bytes
+    uint8_t s[16];
+    // Initial AddRoundKey: round 0 (big-endian words per spec order)
+    const uint32_t* rk = mRoundKeys;
+    AddRoundKey(in, s, rk);
     rk += 4;
 
     // Rounds 1..Nr-1
     for (uint32_t round = 1; round < mRoundCount; ++round) {
-        // SubBytes
-        for (int i = 0; i < 16; ++i) s[i] = AES_SBOX[s[i]];
-
-        // ShiftRows
-        uint8_t t;
+        SubBytes(s);
+        ShiftRows(s);
+        MixColumns(s);
+        AddRoundKey(s, s, rk);
+        rk += 4;
+    }
 
-        // row 1: 1-byte left rotation
-        t = s[1]; s[1] = s[5]; s[5] = s[9]; s[9] = s[13]; s[13] = t;
+    // Final Round (no MixColumns)
+    SubBytes(s);
+    ShiftRows(s);
+    AddRoundKey(s, out, rk);
+}
 
-        // row 2: 2-byte rotation
-        t = s[2]; s[2] = s[10]; s[10] = t;
-        t = s[6]; s[6] = s[14]; s[14] = t;
+static_assert(AES_CTR_PIPELINE_BLOCKS <= AES_BITSLICED_BLOCKS, "bitsliced batch must hold a whole pipeline group");
+
+void AESCounter::EncryptBlocks(const uint8_t* in, uint8_t* out, size_t count) const {
+    // Software rounds only; the hardware backends run whole CTR batches in CtrBlocks()
+    switch (mBackend) {
+    case AESBackend::Reference:
+        EncryptBlocksReference(in, out, count);
+        break;
+    case AESBackend::Bitsliced:
+        BitslicedEncryptBlocks(mRoundKeyPlanes, in, out, count);
+        break;
+    default:
+        EncryptBlocksTTable(in, out, count);
+        break;
+    }
+}
 
-        // row 3: 3-byte rotation (or 1-byte right)
-        t = s[15]; s[15] = s[11]; s[11] = s[7]; s[7] = s[3]; s[3] = t;
+void AESCounter::EncryptBlocksReference(const uint8_t* in, uint8_t* out, size_t count) const {
+    uint8_t s[AES_CTR_PIPELINE_BLOCKS][16];
+    const uint32_t* rk = mRoundKeys;
 
-        // MixColumns
-        MixColumns(s);
+    for (size_t b = 0; b < count; ++b) AddRoundKey(in + 16 * b, s[b], rk);
+    rk += 4;
 
-        // AddRoundKey
-        for (int i = 0; i < 4; ++i) {
-            uint32_t w = (uint32_t)s[4*i] << 24 |
-                         (uint32_t)s[4*i+1] << 16 |
-                         (uint32_t)s[4*i+2] << 8 |
-                         (uint32_t)s[4*i+3];
-            w ^= rk[i];
-            s[4*i+0] = (uint8_t)(w >> 24);
-            s[4*i+1] = (uint8_t)(w >> 16);
-            s[4*i+2] = (uint8_t)(w >> 8);
-            s[4*i+3] = (uint8_t)(w);
+    // Round-major, block-minor: consecutive iterations touch unrelated state
+    for (uint32_t round = 1; round < mRoundCount; ++round) {
+        for (size_t b = 0; b < count; ++b) {
+            SubBytes(s[b]);
+            ShiftRows(s[b]);
+            MixColumns(s[b]);
+            AddRoundKey(s[b], s[b], rk);
         }
         rk += 4;
     }
 
-    // Final Round (no MixColumns)
-    for (int i = 0; i < 16; ++i) s[i] = AES_SBOX[s[i]];
+    for (size_t b = 0; b < count; ++b) {
+        SubBytes(s[b]);
+        ShiftRows(s[b]);
+        AddRoundKey(s[b], out + 16 * b, rk);
+    }
+    SecureZero(s, sizeof(s));
+}
 
-    // ShiftRows
-    uint8_t t;
-    t = s[1]; s[1] = s[5]; s[5] = s[9]; s[9] = s[13]; s[13] = t;
+void AESCounter::EncryptBlocksTTable(const uint8_t* in, uint8_t* out, size_t count) const {
+    // State as big-endian column words, exactly as the round keys are laid out
+    uint32_t s[AES_CTR_PIPELINE_BLOCKS][4];
+    const uint32_t* rk = mRoundKeys;
 
-    t = s[2]; s[2] = s[10]; s[10] = t;
-    t = s[6]; s[6] = s[14]; s[14] = t;
+    for (size_t b = 0; b < count; ++b) {
+        for (int c = 0; c < 4; ++c) s[b][c] = LoadBE32(in + 16 * b + 4 * c) ^ rk[c];
+    }
+    rk += 4;
 
-    t = s[15]; s[15] = s[11]; s[11] = s[7]; s[7] = s[3]; s[3] = t;
+    for (uint32_t round = 1; round < mRoundCount; ++round) {
+        for (size_t b = 0; b < count; ++b) {
+            const uint32_t s0 = s[b][0], s1 = s[b][1], s2 = s[b][2], s3 = s[b][3];
+            s[b][0] = AES_TE0[s0 >> 24] ^ AES_TE1[(s1 >> 16) & 0xFF] ^ AES_TE2[(s2 >> 8) & 0xFF] ^ AES_TE3[s3 & 0xFF] ^ rk[0];
+            s[b][1] = AES_TE0[s1 >> 24] ^ AES_TE1[(s2 >> 16) & 0xFF] ^ AES_TE2[(s3 >> 8) & 0xFF] ^ AES_TE3[s0 & 0xFF] ^ rk[1];
+            s[b][2] = AES_TE0[s2 >> 24] ^ AES_TE1[(s3 >> 16) & 0xFF] ^ AES_TE2[(s0 >> 8) & 0xFF] ^ AES_TE3[s1 & 0xFF] ^ rk[2];
+            s[b][3] = AES_TE0[s3 >> 24] ^ AES_TE1[(s0 >> 16) & 0xFF] ^ AES_TE2[(s1 >> 8) & 0xFF] ^ AES_TE3[s2 & 0xFF] ^ rk[3];
+        }
+        rk += 4;
+    }
 
-    // AddRoundKey
-    for (int i = 0; i < 4; ++i) {
-        uint32_t w = (uint32_t)s[4*i] << 24 |
-                     (uint32_t)s[4*i+1] << 16 |
-                     (uint32_t)s[4*i+2] << 8 |
-                     (uint32_t)s[4*i+3];
-        w ^= rk[i];
-        out[4*i+0] = (uint8_t)(w >> 24);
-        out[4*i+1] = (uint8_t)(w >> 16);
-        out[4*i+2] = (uint8_t)(w >> 8);
-        out[4*i+3] = (uint8_t)(w);
+    // Final round: SubBytes + ShiftRows + AddRoundKey, no MixColumns
+    for (size_t b = 0; b < count; ++b) {
+        for (int c = 0; c < 4; ++c) {
+            const uint32_t w =
+                (uint32_t)AES_SBOX[ s[b][c]           >> 24        ] << 24 |
+                (uint32_t)AES_SBOX[(s[b][(c + 1) & 3] >> 16) & 0xFF] << 16 |
+                (uint32_t)AES_SBOX[(s[b][(c + 2) & 3] >> 8)  & 0xFF] << 8  |
+                (uint32_t)AES_SBOX[ s[b][(c + 3) & 3]        & 0xFF];
+            StoreBE32(out + 16 * b + 4 * c, w ^ rk[c]);
+        }
     }
+    SecureZero(s, sizeof(s));
 }
 
 // ==================== CTR core ====================
@@ -233,16 +366,117 @@ void AESCounter::IncrementCounter() {
     }
 }
 
+void AESCounter::CtrBlocks(const uint8_t* in, uint8_t* out, size_t blocks) {
+    mBlockIndex += blocks;
+    switch (mBackend) {
+    case AESBackend::VAES:
+        VaesCtr(mRoundKeyBytes, mCounter, in, out, blocks);
+        return;
+    case AESBackend::AESNI:
+        AesNiCtr(mRoundKeyBytes, mCounter, in, out, blocks);
+        return;
+    default:
+        break;
+    }
+
+    uint8_t ctr[AES_CTR_PIPELINE_BLOCKS * AES_BLOCK_SIZE_BYTES];
+    uint8_t ks[AES_CTR_PIPELINE_BLOCKS * AES_BLOCK_SIZE_BYTES];
+    while (blocks != 0) {
+        const size_t n = blocks < AES_CTR_PIPELINE_BLOCKS ? blocks : AES_CTR_PIPELINE_BLOCKS;
+        const size_t bytes = n * AES_BLOCK_SIZE_BYTES;
+
+        for (size_t b = 0; b < n; ++b) {
+            std::memcpy(ctr + AES_BLOCK_SIZE_BYTES * b, mCounter, AES_BLOCK_SIZE_BYTES);
+            IncrementCounter();
+        }
+
+        if (!in) {
+            EncryptBlocks(ctr, out, n);
+        } else {
+            EncryptBlocks(ctr, ks, n);
+            for (size_t i = 0; i < bytes; i += 8) {
+                uint64_t a, k;
+                std::memcpy(&a, in + i, 8);
+                std::memcpy(&k, ks + i, 8);
+                a ^= k;
+                std::memcpy(out + i, &a, 8);
+            }
+            in += bytes;
+        }
+        out += bytes;
+        blocks -= n;
+    }
+    SecureZero(ks, sizeof(ks));
+}
+
+void AESCounter::Seek(uint64_t byteOffset) {
+    EnsureSeeded();
+
+    // mCounter = mIV + block, 128-bit big-endian add
+    const uint64_t block = byteOffset / AES_BLOCK_SIZE_BYTES;
+    uint64_t add = block;
+    unsigned carry = 0;
+    for (int i = 15; i >= 0; --i) {
+        const unsigned sum = (unsigned)mIV[i] + (unsigned)(add & 0xFF) + carry;
+        mCounter[i] = (uint8_t)sum;
+        carry = sum >> 8;
+        add >>= 8;
+    }
+    mBlockIndex = block;
+    mBufUsed = sizeof(mBuf);
+
+    // Mid-block: buffer from the containing block and skip into it
+    const uint32_t within = (uint32_t)(byteOffset % AES_BLOCK_SIZE_BYTES);
+    if (within != 0) {
+        Refill();
+        mBufUsed = within;
+    }
+}
+
+uint64_t AESCounter::Tell() const {
+    return mBlockIndex * AES_BLOCK_SIZE_BYTES - (sizeof(mBuf) - mBufUsed);
+}
+
 void AESCounter::Refill() {
     // Fill mBuf (64 bytes) with 4 consecutive CTR blocks
-    uint8_t out[16];
+    CtrBlocks(nullptr, mBuf, sizeof(mBuf) / AES_BLOCK_SIZE_BYTES);
+    mBufUsed = 0;
+}
 
-    for (int blk = 0; blk < 4; ++blk) {
-        EncryptBlock(mCounter, out);
-        std::memcpy(mBuf + 16 * blk, out, 16);
-        IncrementCounter();
+void AESCounter::Process(const uint8_t* in, uint8_t* out, size_t len) {
+    EnsureSeeded();
+
+    // 1) Drain whatever Get()/an earlier call left in mBuf
+    while (len != 0 && mBufUsed < sizeof(mBuf)) {
+        *out++ = (uint8_t)((in ? *in++ : 0) ^ mBuf[mBufUsed++]);
+        --len;
     }
-    mBufUsed = 0;
+
+    // 2) Whole blocks straight into the caller's buffer
+    const size_t blocks = len / AES_BLOCK_SIZE_BYTES;
+    if (blocks != 0) {
+        CtrBlocks(in, out, blocks);
+        const size_t bytes = blocks * AES_BLOCK_SIZE_BYTES;
+        if (in) in += bytes;
+        out += bytes;
+        len -= bytes;
+    }
+
+    // 3) Sub-block tail: buffer a fresh block group so the remainder stays available to Get()
+    if (len != 0) {
+        Refill();
+        while (len--) {
+            *out++ = (uint8_t)((in ? *in++ : 0) ^ mBuf[mBufUsed++]);
+        }
+    }
+}
+
+void AESCounter::Generate(std::span<std::byte> out) {
+    Process(nullptr, (uint8_t*)out.data(), out.size());
+}
+
+void AESCounter::XorKeystream(std::span<const std::byte> src, std::byte* dst) {
+    Process((const uint8_t*)src.data(), (uint8_t*)dst, src.size());
 }
 
 // ==================== Seeding ====================
@@ -254,6 +488,8 @@ bool AESCounter::SeedKeyIV(const uint8_t* key32, const uint8_t* iv16, uint32_t c
     // Load IV, then inject counter in last 4 bytes (big-endian)
     std::memcpy(mCounter, iv16, 16);
     StoreBE32(mCounter + 12, counter);
+    std::memcpy(mIV, mCounter, 16);
+    mBlockIndex = 0;
 
     mBufUsed = sizeof(mBuf);
     mSeeded = true;
@@ -319,13 +555,23 @@ void AESCounter::Seed(const uint8_t* bytes, size_t len) {
 }
 
 // ==================== Output ====================
-uint32_t AESCounter::Get() {
+void AESCounter::EnsureSeeded() {
     if (!mSeeded) {
         // Deterministic all-zero seed if user forgets to seed (NOT secure)
         uint8_t zkey[32] = {0}, ziv[16] = {0};
         SeedKeyIV(zkey, ziv, 0);
     }
+}
+
+uint32_t AESCounter::Get() {
+    EnsureSeeded();
     if (mBufUsed > sizeof(mBuf) - 4) {
+        if (mBufUsed != sizeof(mBuf)) {
+            // A byte-granular Generate() left 1..3 bytes behind; stitch the word across the refill
+            uint8_t w[4];
+            Process(nullptr, w, 4);
+            return (uint32_t)w[0] | (uint32_t)w[1] << 8 | (uint32_t)w[2] << 16 | (uint32_t)w[3] << 24;
+        }
         Refill();
     }
     uint32_t v = (uint32_t)mBuf[mBufUsed] << 0
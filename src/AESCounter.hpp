@@ -2,6 +2,7 @@
 #define AESCOUNTER_HPP
 
 #include "stdafx.h"
+#include "AESCounterBitsliced.hpp"
 #include <cstdint>
 #include <cstddef>
 
@@ -10,11 +11,31 @@
 #define AES_BLOCK_SIZE_BYTES    16u
 #define AES_ROUNDS              14u   // AES-256 -> 14 rounds
 #define AES_ROUND_KEYS_WORDS    60u   // 4 * (Nr + 1) = 4 * 15 = 60
+#define AES_CTR_PIPELINE_BLOCKS 8u    // counter blocks encrypted side by side in the bulk path
+
+// Round-function implementations. All backends are bit-exact with each other;
+// Reference is the byte-wise FIPS-197 transcription and stays as the oracle.
+enum class AESBackend {
+    Auto,       // best backend the running CPU supports (resolved by SetBackend)
+    Reference,  // byte-wise SubBytes/ShiftRows/MixColumns
+    TTable,     // 32-bit combined SubBytes+ShiftRows+MixColumns lookups (4 x 1 KiB tables)
+    Bitsliced,  // constant-time: 8 blocks as 128-bit bit-planes, S-box as a boolean circuit
+    AESNI,      // x86 aesenc/aesenclast, 8 blocks in flight
+    VAES        // x86 AVX-512 VAES, 16 blocks per iteration
+};
 
 class AESCounter {
 public:
     AESCounter();
 
+    // Select the round function (default: Auto). Does not disturb key, counter or buffered bytes.
+    // Returns false, leaving the backend unchanged, if this CPU cannot run the requested one.
+    bool SetBackend(AESBackend backend);
+    AESBackend Backend() const { return mBackend; }
+
+    static bool IsBackendSupported(AESBackend backend);
+    static AESBackend BestBackend();   // VAES > AESNI > Bitsliced, probed with CPUID
+
     // Seed with authoritative inputs (preferred):
     // key32: 32 bytes (AES-256 key)
     // iv16 : 16 bytes (initial counter block, usually nonce||counter)
@@ -28,6 +49,20 @@ public:
     // Core generation
     uint32_t Get();    // 32 bits
 
+    // Bulk generation. Both continue the exact byte stream that Get() walks through
+    // (Get() returns the next 4 keystream bytes little-endian), so the calls can be mixed.
+    // Whole counter blocks are written straight into the caller's memory,
+    // AES_CTR_PIPELINE_BLOCKS at a time; only a sub-block tail goes through mBuf.
+    void Generate(std::span<std::byte> out);
+
+    // dst[i] = src[i] ^ keystream[i]. dst may alias src (in-place), but must not partially overlap it.
+    void XorKeystream(std::span<const std::byte> src, std::byte* dst);
+
+    // Random access: position the stream at keystream byte byteOffset (0 = first byte after seeding)
+    // by recomputing the counter block as iv + byteOffset / 16, so no keystream is generated to get there.
+    void Seek(uint64_t byteOffset);
+    uint64_t Tell() const;             // keystream byte the next Get()/Generate() starts at
+
     // Zeroize keys and internal buffers
     void Clear();
     ~AESCounter();
@@ -37,10 +72,21 @@ private:
     void ExpandKey256(const uint8_t key[AES_KEY_SIZE_BYTES]); // sets mRoundKeys and mRoundCount
     void EncryptBlock(const uint8_t in[AES_BLOCK_SIZE_BYTES],
                       uint8_t out[AES_BLOCK_SIZE_BYTES]) const;
+    // Encrypts count (<= AES_CTR_PIPELINE_BLOCKS) independent blocks round by round in lockstep,
+    // so the per-block dependency chains overlap instead of running back to back.
+    void EncryptBlocks(const uint8_t* in, uint8_t* out, size_t count) const;
+    void EncryptBlocksReference(const uint8_t* in, uint8_t* out, size_t count) const;
+    void EncryptBlocksTTable(const uint8_t* in, uint8_t* out, size_t count) const;
 
     // CTR machinery
+    // blocks whole counter blocks: out = in ^ E(counter++), plain keystream when in == nullptr
+    void CtrBlocks(const uint8_t* in, uint8_t* out, size_t blocks);
+    bool IsHardwareBackend() const { return mBackend == AESBackend::AESNI || mBackend == AESBackend::VAES; }
     void Refill();                       // refill mBuf with fresh keystream
     void IncrementCounter();             // 128-bit big-endian increment of mCounter
+    void EnsureSeeded();                 // all-zero key/iv fallback used by Get() and the bulk API
+    // Shared body of Generate/XorKeystream; in == nullptr means plain keystream.
+    void Process(const uint8_t* in, uint8_t* out, size_t len);
     static inline uint32_t LoadBE32(const uint8_t* p);
     static inline void     StoreBE32(uint8_t* p, uint32_t v);
 
@@ -54,16 +100,25 @@ private:
 private:
     // Expanded round keys (AES-256 -> 60 x 32-bit words)
     uint32_t mRoundKeys[AES_ROUND_KEYS_WORDS];
+    // The same schedule in the hardware layout (15 x 16-byte round keys, FIPS byte order).
+    // Both forms are kept in sync so the backend can change after keying.
+    alignas(16) uint8_t mRoundKeyBytes[AES_ROUND_KEYS_WORDS * 4];
+    // ...and broadcast into bit-planes for the bitsliced rounds
+    alignas(16) uint64_t mRoundKeyPlanes[AES_BITSLICED_PLANE_WORDS];
     uint32_t mRoundCount; // number of rounds (14)
 
     // 128-bit counter block (IV || counter), big-endian increment
     uint8_t  mCounter[AES_BLOCK_SIZE_BYTES];
+    uint8_t  mIV[AES_BLOCK_SIZE_BYTES];  // counter block at stream offset 0 (what Seek counts from)
+    uint64_t mBlockIndex;                // blocks encrypted since mIV, i.e. mCounter == mIV + mBlockIndex
 
     // Small keystream buffer (64 bytes = 4 blocks) to amortize EncryptBlock calls
     uint8_t  mBuf[64];
     uint32_t mBufUsed; // bytes already consumed in mBuf
 
     bool     mSeeded;
+
+    AESBackend mBackend;
 };
 
 #endif // AESCOUNTER_HPP
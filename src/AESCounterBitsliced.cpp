@@ -0,0 +1,330 @@
+#include "AESCounterBitsliced.hpp"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AES_BS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// ==================== 128-bit plane ====================
+// Byte p of a plane is state byte p (column-major, p = 4*col + row), bit k is block k.
+// So each 32-bit lane is one state column and byte r of a lane is row r.
+struct BsPlane {
+#if defined(AES_BS_SSE2)
+    __m128i v;
+#else
+    uint64_t lo, hi;
+#endif
+};
+
+#if defined(AES_BS_SSE2)
+static inline BsPlane operator^(BsPlane a, BsPlane b) { return { _mm_xor_si128(a.v, b.v) }; }
+static inline BsPlane operator&(BsPlane a, BsPlane b) { return { _mm_and_si128(a.v, b.v) }; }
+static inline BsPlane operator|(BsPlane a, BsPlane b) { return { _mm_or_si128(a.v, b.v) }; }
+static inline BsPlane operator~(BsPlane a) { return { _mm_xor_si128(a.v, _mm_set1_epi32(-1)) }; }
+
+static inline BsPlane LoadPlane(const void* p) { return { _mm_loadu_si128((const __m128i*)p) }; }
+static inline void StorePlane(void* p, BsPlane a) { _mm_storeu_si128((__m128i*)p, a.v); }
+
+// new lane c = old lane (c + k) % 4
+static inline BsPlane RotateLanes1(BsPlane a) { return { _mm_shuffle_epi32(a.v, 0x39) }; }
+static inline BsPlane RotateLanes2(BsPlane a) { return { _mm_shuffle_epi32(a.v, 0x4E) }; }
+static inline BsPlane RotateLanes3(BsPlane a) { return { _mm_shuffle_epi32(a.v, 0x93) }; }
+
+// new row r = old row (r + k) % 4 inside every column
+static inline BsPlane RotateRows1(BsPlane a) { return { _mm_or_si128(_mm_srli_epi32(a.v, 8),  _mm_slli_epi32(a.v, 24)) }; }
+static inline BsPlane RotateRows2(BsPlane a) { return { _mm_or_si128(_mm_srli_epi32(a.v, 16), _mm_slli_epi32(a.v, 16)) }; }
+
+static inline BsPlane RowMask(int r) { return { _mm_set1_epi32((int)(0xFFu << (8 * r))) }; }
+#else
+static inline BsPlane operator^(BsPlane a, BsPlane b) { return { a.lo ^ b.lo, a.hi ^ b.hi }; }
+static inline BsPlane operator&(BsPlane a, BsPlane b) { return { a.lo & b.lo, a.hi & b.hi }; }
+static inline BsPlane operator|(BsPlane a, BsPlane b) { return { a.lo | b.lo, a.hi | b.hi }; }
+static inline BsPlane operator~(BsPlane a) { return { ~a.lo, ~a.hi }; }
+
+static inline uint64_t Load64LE(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+static inline void Store64LE(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) { p[i] = (uint8_t)v; v >>= 8; }
+}
+static inline BsPlane LoadPlane(const void* p) {
+    return { Load64LE((const uint8_t*)p), Load64LE((const uint8_t*)p + 8) };
+}
+static inline void StorePlane(void* p, BsPlane a) {
+    Store64LE((uint8_t*)p, a.lo);
+    Store64LE((uint8_t*)p + 8, a.hi);
+}
+
+static inline BsPlane RotateLanes1(BsPlane a) { return { (a.lo >> 32) | (a.hi << 32), (a.hi >> 32) | (a.lo << 32) }; }
+static inline BsPlane RotateLanes2(BsPlane a) { return { a.hi, a.lo }; }
+static inline BsPlane RotateLanes3(BsPlane a) { return { (a.hi >> 32) | (a.lo << 32), (a.lo >> 32) | (a.hi << 32) }; }
+
+static inline uint64_t RotLanes64(uint64_t x, int bits) {
+    const uint64_t keep = 0xFFFFFFFFu >> bits;
+    const uint64_t low  = (keep << 32) | keep;
+    return ((x >> bits) & low) | ((x << (32 - bits)) & ~low);
+}
+static inline BsPlane RotateRows1(BsPlane a) { return { RotLanes64(a.lo, 8),  RotLanes64(a.hi, 8) }; }
+static inline BsPlane RotateRows2(BsPlane a) { return { RotLanes64(a.lo, 16), RotLanes64(a.hi, 16) }; }
+
+static inline BsPlane RowMask(int r) {
+    const uint64_t m = (uint64_t)(0xFFu << (8 * r)) * 0x0000000100000001ull;
+    return { m, m };
+}
+#endif
+
+// ==================== S-box circuit ====================
+// Boyar-Peralta depth-16 circuit (113 gates). q[0] is the least significant bit plane.
+// Templated so the same gates serve the 8-block planes and the key schedule's SubWord.
+template<class T>
+static inline void SboxCircuit(T q[8]) {
+    const T x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4];
+    const T x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+    // Top linear transformation
+    const T y14 = x3 ^ x5;
+    const T y13 = x0 ^ x6;
+    const T y9  = x0 ^ x3;
+    const T y8  = x0 ^ x5;
+    const T t0  = x1 ^ x2;
+    const T y1  = t0 ^ x7;
+    const T y4  = y1 ^ x3;
+    const T y12 = y13 ^ y14;
+    const T y2  = y1 ^ x0;
+    const T y5  = y1 ^ x6;
+    const T y3  = y5 ^ y8;
+    const T t1  = x4 ^ y12;
+    const T y15 = t1 ^ x5;
+    const T y20 = t1 ^ x1;
+    const T y6  = y15 ^ x7;
+    const T y10 = y15 ^ t0;
+    const T y11 = y20 ^ y9;
+    const T y7  = x7 ^ y11;
+    const T y17 = y10 ^ y11;
+    const T y19 = y10 ^ y8;
+    const T y16 = t0 ^ y11;
+    const T y21 = y13 ^ y16;
+    const T y18 = x0 ^ y16;
+
+    // Non-linear section
+    const T t2  = y12 & y15;
+    const T t3  = y3 & y6;
+    const T t4  = t3 ^ t2;
+    const T t5  = y4 & x7;
+    const T t6  = t5 ^ t2;
+    const T t7  = y13 & y16;
+    const T t8  = y5 & y1;
+    const T t9  = t8 ^ t7;
+    const T t10 = y2 & y7;
+    const T t11 = t10 ^ t7;
+    const T t12 = y9 & y11;
+    const T t13 = y14 & y17;
+    const T t14 = t13 ^ t12;
+    const T t15 = y8 & y10;
+    const T t16 = t15 ^ t12;
+    const T t17 = t4 ^ t14;
+    const T t18 = t6 ^ t16;
+    const T t19 = t9 ^ t14;
+    const T t20 = t11 ^ t16;
+    const T t21 = t17 ^ y20;
+    const T t22 = t18 ^ y19;
+    const T t23 = t19 ^ y21;
+    const T t24 = t20 ^ y18;
+
+    const T t25 = t21 ^ t22;
+    const T t26 = t21 & t23;
+    const T t27 = t24 ^ t26;
+    const T t28 = t25 & t27;
+    const T t29 = t28 ^ t22;
+    const T t30 = t23 ^ t24;
+    const T t31 = t22 ^ t26;
+    const T t32 = t31 & t30;
+    const T t33 = t32 ^ t24;
+    const T t34 = t23 ^ t33;
+    const T t35 = t27 ^ t33;
+    const T t36 = t24 & t35;
+    const T t37 = t36 ^ t34;
+    const T t38 = t27 ^ t36;
+    const T t39 = t29 & t38;
+    const T t40 = t25 ^ t39;
+
+    const T t41 = t40 ^ t37;
+    const T t42 = t29 ^ t33;
+    const T t43 = t29 ^ t40;
+    const T t44 = t33 ^ t37;
+    const T t45 = t42 ^ t41;
+    const T z0  = t44 & y15;
+    const T z1  = t37 & y6;
+    const T z2  = t33 & x7;
+    const T z3  = t43 & y16;
+    const T z4  = t40 & y1;
+    const T z5  = t29 & y7;
+    const T z6  = t42 & y11;
+    const T z7  = t45 & y17;
+    const T z8  = t41 & y10;
+    const T z9  = t44 & y12;
+    const T z10 = t37 & y3;
+    const T z11 = t33 & y4;
+    const T z12 = t43 & y13;
+    const T z13 = t40 & y5;
+    const T z14 = t29 & y2;
+    const T z15 = t42 & y9;
+    const T z16 = t45 & y14;
+    const T z17 = t41 & y8;
+
+    // Bottom linear transformation
+    const T t46 = z15 ^ z16;
+    const T t47 = z10 ^ z11;
+    const T t48 = z5 ^ z13;
+    const T t49 = z9 ^ z10;
+    const T t50 = z2 ^ z12;
+    const T t51 = z2 ^ z5;
+    const T t52 = z7 ^ z8;
+    const T t53 = z0 ^ z3;
+    const T t54 = z6 ^ z7;
+    const T t55 = z16 ^ z17;
+    const T t56 = z12 ^ t48;
+    const T t57 = t50 ^ t53;
+    const T t58 = z4 ^ t46;
+    const T t59 = z3 ^ t54;
+    const T t60 = t46 ^ t57;
+    const T t61 = z14 ^ t57;
+    const T t62 = t52 ^ t58;
+    const T t63 = t49 ^ t58;
+    const T t64 = z4 ^ t59;
+    const T t65 = t61 ^ t62;
+    const T t66 = z1 ^ t63;
+    const T s0  = t59 ^ t63;
+    const T s6  = t56 ^ ~t62;
+    const T s7  = t48 ^ ~t60;
+    const T t67 = t64 ^ t65;
+    const T s3  = t53 ^ t66;
+    const T s4  = t51 ^ t66;
+    const T s5  = t47 ^ t65;
+    const T s1  = t64 ^ ~s3;
+    const T s2  = t55 ^ ~t67;
+
+    q[7] = s0; q[6] = s1; q[5] = s2; q[4] = s3;
+    q[3] = s4; q[2] = s5; q[1] = s6; q[0] = s7;
+}
+
+uint32_t BitslicedSubWord(uint32_t w) {
+    // Plane b, bit j = bit b of byte j
+    uint32_t q[8];
+    for (int b = 0; b < 8; ++b) {
+        uint32_t p = 0;
+        for (int j = 0; j < 4; ++j) p |= ((w >> (8 * j + b)) & 1u) << j;
+        q[b] = p;
+    }
+    SboxCircuit(q);
+    uint32_t r = 0;
+    for (int b = 0; b < 8; ++b) {
+        for (int j = 0; j < 4; ++j) r |= ((q[b] >> j) & 1u) << (8 * j + b);
+    }
+    return r;
+}
+
+// ==================== Transposition ====================
+// 8x8 bit transpose: bit j of byte i <-> bit i of byte j.
+static inline uint64_t Transpose8x8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7))  & 0x00AA00AA00AA00AAull; x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull; x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull; x ^= t ^ (t << 28);
+    return x;
+}
+
+// blocks[k*16 + p] -> planes[b][p] bit k = bit b of blocks[k][p]
+static void ToPlanes(const uint8_t* blocks, size_t count, BsPlane q[8]) {
+    uint8_t planes[8][16];
+    for (int p = 0; p < 16; ++p) {
+        uint64_t x = 0;
+        for (size_t k = 0; k < count; ++k) x |= (uint64_t)blocks[16 * k + p] << (8 * k);
+        x = Transpose8x8(x);
+        for (int b = 0; b < 8; ++b) planes[b][p] = (uint8_t)(x >> (8 * b));
+    }
+    for (int b = 0; b < 8; ++b) q[b] = LoadPlane(planes[b]);
+}
+
+static void FromPlanes(const BsPlane q[8], uint8_t* blocks, size_t count) {
+    uint8_t planes[8][16];
+    for (int b = 0; b < 8; ++b) StorePlane(planes[b], q[b]);
+    for (int p = 0; p < 16; ++p) {
+        uint64_t x = 0;
+        for (int b = 0; b < 8; ++b) x |= (uint64_t)planes[b][p] << (8 * b);
+        x = Transpose8x8(x);
+        for (size_t k = 0; k < count; ++k) blocks[16 * k + p] = (uint8_t)(x >> (8 * k));
+    }
+}
+
+// ==================== Round steps ====================
+static inline void ShiftRowsPlanes(BsPlane q[8]) {
+    const BsPlane m0 = RowMask(0), m1 = RowMask(1), m2 = RowMask(2), m3 = RowMask(3);
+    for (int b = 0; b < 8; ++b) {
+        const BsPlane a = q[b];
+        q[b] = (a & m0) | (RotateLanes1(a) & m1) | (RotateLanes2(a) & m2) | (RotateLanes3(a) & m3);
+    }
+}
+
+// out = 2*a ^ 3*rot1(a) ^ rot2(a) ^ rot3(a) = xtime(a ^ rot1(a)) ^ rot1(a) ^ rot2(a ^ rot1(a))
+static inline void MixColumnsPlanes(BsPlane q[8]) {
+    BsPlane u[8], t[8];
+    for (int b = 0; b < 8; ++b) {
+        u[b] = RotateRows1(q[b]);
+        t[b] = q[b] ^ u[b];
+    }
+    // xtime over planes: shift up one plane, fold the carry back with 0x1B (bits 0, 1, 3, 4)
+    const BsPlane hi = t[7];
+    BsPlane x[8];
+    x[0] = hi;
+    x[1] = t[0] ^ hi;
+    x[2] = t[1];
+    x[3] = t[2] ^ hi;
+    x[4] = t[3] ^ hi;
+    x[5] = t[4];
+    x[6] = t[5];
+    x[7] = t[6];
+    for (int b = 0; b < 8; ++b) q[b] = x[b] ^ u[b] ^ RotateRows2(t[b]);
+}
+
+static inline void AddRoundKeyPlanes(BsPlane q[8], const uint64_t* rk) {
+    for (int b = 0; b < 8; ++b) q[b] = q[b] ^ LoadPlane(rk + 2 * b);
+}
+
+// ==================== Public entry points ====================
+void BitslicedKeyPlanes(const uint8_t roundKeys[240], uint64_t planes[AES_BITSLICED_PLANE_WORDS]) {
+    for (int r = 0; r < 15; ++r) {
+        uint8_t bytes[8][16];
+        for (int b = 0; b < 8; ++b) {
+            for (int p = 0; p < 16; ++p) {
+                // 0x00 or 0xFF: the key bit broadcast to all eight block lanes (no branches)
+                bytes[b][p] = (uint8_t)(0u - ((roundKeys[16 * r + p] >> b) & 1u));
+            }
+        }
+        std::memcpy(planes + 16 * r, bytes, sizeof(bytes));
+        volatile uint8_t* v = &bytes[0][0];
+        for (size_t i = 0; i < sizeof(bytes); ++i) v[i] = 0;
+    }
+}
+
+void BitslicedEncryptBlocks(const uint64_t planes[AES_BITSLICED_PLANE_WORDS],
+                            const uint8_t* in, uint8_t* out, size_t count) {
+    BsPlane q[8];
+    ToPlanes(in, count, q);
+
+    AddRoundKeyPlanes(q, planes);
+    for (int r = 1; r < 14; ++r) {
+        SboxCircuit(q);
+        ShiftRowsPlanes(q);
+        MixColumnsPlanes(q);
+        AddRoundKeyPlanes(q, planes + 16 * r);
+    }
+    SboxCircuit(q);
+    ShiftRowsPlanes(q);
+    AddRoundKeyPlanes(q, planes + 16 * 14);
+
+    FromPlanes(q, out, count);
+}
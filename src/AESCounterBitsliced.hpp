@@ -0,0 +1,25 @@
+#ifndef AESCOUNTERBITSLICED_HPP
+#define AESCOUNTERBITSLICED_HPP
+
+#include "stdafx.h"
+
+// Constant-time bitsliced AES-256 kernels behind AESBackend::Bitsliced.
+// Eight blocks are transposed into eight 128-bit bit-planes (plane b holds bit b of every
+// state byte of every block, one bit per block), so SubBytes is the Boyar-Peralta boolean
+// circuit and ShiftRows/MixColumns are lane shuffles and shifts: no table lookups and no
+// secret-dependent branches or addresses anywhere in the round function or key schedule.
+
+#define AES_BITSLICED_BLOCKS       8u
+#define AES_BITSLICED_PLANE_WORDS  (15u * 8u * 2u)   // 15 round keys x 8 planes x 128 bits
+
+// S-box applied to each byte of a word, evaluated as the same circuit (key schedule SubWord).
+uint32_t BitslicedSubWord(uint32_t w);
+
+// Broadcast the hardware-layout round keys (15 x 16 bytes) into bit-planes.
+void BitslicedKeyPlanes(const uint8_t roundKeys[240], uint64_t planes[AES_BITSLICED_PLANE_WORDS]);
+
+// Encrypt count (<= AES_BITSLICED_BLOCKS) independent 16-byte blocks; in and out may alias.
+void BitslicedEncryptBlocks(const uint64_t planes[AES_BITSLICED_PLANE_WORDS],
+                            const uint8_t* in, uint8_t* out, size_t count);
+
+#endif
@@ -0,0 +1,178 @@
+#include "AESCounterNI.hpp"
+#include <cstring>
+#include <bit>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define AESNI_TARGET
+#define VAES_TARGET
+#else
+#define AESNI_TARGET __attribute__((target("aes,sse4.1")))
+#define VAES_TARGET  __attribute__((target("aes,sse4.1,avx2,avx512f,vaes")))
+#endif
+
+// ==================== Counter helpers ====================
+// The CTR block is a 128-bit big-endian integer; keep it as (hi, lo) 64-bit halves.
+static inline uint64_t LoadBE64(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return std::endian::native == std::endian::little ? std::byteswap(v) : v;
+}
+static inline void StoreBE64(uint8_t* p, uint64_t v) {
+    if constexpr (std::endian::native == std::endian::little) v = std::byteswap(v);
+    std::memcpy(p, &v, 8);
+}
+static inline void FillCounterBlocks(uint8_t* dst, uint64_t& hi, uint64_t& lo, size_t n) {
+    for (size_t b = 0; b < n; ++b) {
+        StoreBE64(dst + 16 * b,     hi);
+        StoreBE64(dst + 16 * b + 8, lo);
+        if (++lo == 0) ++hi;
+    }
+}
+
+// ==================== Key schedule ====================
+AESNI_TARGET static inline __m128i ExpandAssistA(__m128i t1, __m128i t2) {
+    t2 = _mm_shuffle_epi32(t2, 0xFF);
+    __m128i t4 = _mm_slli_si128(t1, 4);
+    t1 = _mm_xor_si128(t1, t4);
+    t4 = _mm_slli_si128(t4, 4);
+    t1 = _mm_xor_si128(t1, t4);
+    t4 = _mm_slli_si128(t4, 4);
+    t1 = _mm_xor_si128(t1, t4);
+    return _mm_xor_si128(t1, t2);
+}
+
+AESNI_TARGET static inline __m128i ExpandAssistB(__m128i t1, __m128i t3) {
+    // SubWord without RotWord for the odd half of each AES-256 step
+    const __m128i t2 = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(t1, 0x00), 0xAA);
+    __m128i t4 = _mm_slli_si128(t3, 4);
+    t3 = _mm_xor_si128(t3, t4);
+    t4 = _mm_slli_si128(t4, 4);
+    t3 = _mm_xor_si128(t3, t4);
+    t4 = _mm_slli_si128(t4, 4);
+    t3 = _mm_xor_si128(t3, t4);
+    return _mm_xor_si128(t3, t2);
+}
+
+#define AESNI_EXPAND_STEP(i, rcon)                                          \
+    t1 = ExpandAssistA(t1, _mm_aeskeygenassist_si128(t3, rcon));            \
+    _mm_store_si128(ks + (i), t1);                                          \
+    if ((i) + 1 < 15) {                                                     \
+        t3 = ExpandAssistB(t1, t3);                                         \
+        _mm_store_si128(ks + (i) + 1, t3);                                  \
+    }
+
+AESNI_TARGET void AesNiExpandKey256(const uint8_t key[32], uint8_t roundKeys[240]) {
+    __m128i* ks = (__m128i*)roundKeys;
+    __m128i t1 = _mm_loadu_si128((const __m128i*)key);
+    __m128i t3 = _mm_loadu_si128((const __m128i*)(key + 16));
+    _mm_store_si128(ks + 0, t1);
+    _mm_store_si128(ks + 1, t3);
+
+    AESNI_EXPAND_STEP(2,  0x01)
+    AESNI_EXPAND_STEP(4,  0x02)
+    AESNI_EXPAND_STEP(6,  0x04)
+    AESNI_EXPAND_STEP(8,  0x08)
+    AESNI_EXPAND_STEP(10, 0x10)
+    AESNI_EXPAND_STEP(12, 0x20)
+    AESNI_EXPAND_STEP(14, 0x40)
+
+    t1 = _mm_setzero_si128();
+    t3 = _mm_setzero_si128();
+}
+
+#undef AESNI_EXPAND_STEP
+
+// ==================== CTR (128-bit lanes) ====================
+// N is a compile-time batch so the state array lives entirely in xmm registers.
+template<size_t N>
+AESNI_TARGET static inline void AesNiCtrBatch(const __m128i rk[15], const uint8_t* ctr,
+                                              const uint8_t* in, uint8_t* out) {
+    __m128i s[N];
+    for (size_t b = 0; b < N; ++b) s[b] = _mm_xor_si128(_mm_load_si128((const __m128i*)ctr + b), rk[0]);
+    for (int r = 1; r < 14; ++r) {
+        for (size_t b = 0; b < N; ++b) s[b] = _mm_aesenc_si128(s[b], rk[r]);
+    }
+    for (size_t b = 0; b < N; ++b) s[b] = _mm_aesenclast_si128(s[b], rk[14]);
+
+    if (in) {
+        for (size_t b = 0; b < N; ++b) s[b] = _mm_xor_si128(s[b], _mm_loadu_si128((const __m128i*)in + b));
+    }
+    for (size_t b = 0; b < N; ++b) _mm_storeu_si128((__m128i*)out + b, s[b]);
+}
+
+AESNI_TARGET void AesNiCtr(const uint8_t roundKeys[240], uint8_t counter[16],
+                           const uint8_t* in, uint8_t* out, size_t blocks) {
+    const __m128i* ks = (const __m128i*)roundKeys;
+    __m128i rk[15];
+    for (int i = 0; i < 15; ++i) rk[i] = _mm_load_si128(ks + i);
+
+    uint64_t hi = LoadBE64(counter), lo = LoadBE64(counter + 8);
+    alignas(16) uint8_t ctr[8 * 16];
+
+    while (blocks >= 8) {
+        FillCounterBlocks(ctr, hi, lo, 8);
+        AesNiCtrBatch<8>(rk, ctr, in, out);
+        if (in) in += 128;
+        out += 128;
+        blocks -= 8;
+    }
+    while (blocks != 0) {
+        FillCounterBlocks(ctr, hi, lo, 1);
+        AesNiCtrBatch<1>(rk, ctr, in, out);
+        if (in) in += 16;
+        out += 16;
+        --blocks;
+    }
+
+    StoreBE64(counter, hi);
+    StoreBE64(counter + 8, lo);
+}
+
+// ==================== CTR (VAES, 4 blocks per zmm) ====================
+VAES_TARGET void VaesCtr(const uint8_t roundKeys[240], uint8_t counter[16],
+                         const uint8_t* in, uint8_t* out, size_t blocks) {
+    const __m128i* ks = (const __m128i*)roundKeys;
+    __m512i rk[15];
+    for (int i = 0; i < 15; ++i) rk[i] = _mm512_maskz_broadcast_i32x4(0xFFFF, _mm_load_si128(ks + i));
+
+    uint64_t hi = LoadBE64(counter), lo = LoadBE64(counter + 8);
+    alignas(64) uint8_t ctr[16 * 16];
+
+    while (blocks >= 16) {
+        FillCounterBlocks(ctr, hi, lo, 16);
+
+        __m512i s[4];
+        for (int v = 0; v < 4; ++v) s[v] = _mm512_xor_si512(_mm512_load_si512(ctr + 64 * v), rk[0]);
+        for (int r = 1; r < 14; ++r) {
+            for (int v = 0; v < 4; ++v) s[v] = _mm512_aesenc_epi128(s[v], rk[r]);
+        }
+        for (int v = 0; v < 4; ++v) s[v] = _mm512_aesenclast_epi128(s[v], rk[14]);
+
+        if (in) {
+            for (int v = 0; v < 4; ++v) s[v] = _mm512_xor_si512(s[v], _mm512_loadu_si512(in + 64 * v));
+            in += 256;
+        }
+        for (int v = 0; v < 4; ++v) _mm512_storeu_si512(out + 64 * v, s[v]);
+
+        out += 256;
+        blocks -= 16;
+    }
+
+    StoreBE64(counter, hi);
+    StoreBE64(counter + 8, lo);
+    _mm256_zeroupper();
+
+    // Fewer than 16 left: finish on the 128-bit path
+    if (blocks != 0) AesNiCtr(roundKeys, counter, in, out, blocks);
+}
+
+#else
+
+void AesNiExpandKey256(const uint8_t*, uint8_t*) {}
+void AesNiCtr(const uint8_t*, uint8_t*, const uint8_t*, uint8_t*, size_t) {}
+void VaesCtr(const uint8_t*, uint8_t*, const uint8_t*, uint8_t*, size_t) {}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef AESCOUNTERNI_HPP
+#define AESCOUNTERNI_HPP
+
+#include "stdafx.h"
+
+// x86 AES-NI / VAES kernels behind AESCounter's hardware backends.
+// Round keys use the hardware layout: 15 x 16-byte round keys in memory (FIPS byte) order,
+// 16-byte aligned. The counter is the 128-bit big-endian CTR block and is advanced in place.
+// Callers must check GetCpuFeatures() first; on non-x86 builds these are never selected.
+
+// AES-256 key schedule with aeskeygenassist, written straight into the hardware layout.
+void AesNiExpandKey256(const uint8_t key[32], uint8_t roundKeys[240]);
+
+// blocks whole CTR blocks: out = in ^ E(counter++), or plain keystream when in == nullptr.
+// 8 blocks in flight per iteration.
+void AesNiCtr(const uint8_t roundKeys[240], uint8_t counter[16],
+              const uint8_t* in, uint8_t* out, size_t blocks);
+
+// Same contract, 16 blocks per iteration as 4 x 512-bit VAES lanes (needs AVX-512F + VAES).
+void VaesCtr(const uint8_t roundKeys[240], uint8_t counter[16],
+             const uint8_t* in, uint8_t* out, size_t blocks);
+
+#endif
@@ -0,0 +1,25 @@
+#include "AesCtrCipher.h"
+#include "stdafx.h"
+
+AesCtrCipher::AesCtrCipher(const uint8_t key32[AES_KEY_SIZE_BYTES], const uint8_t iv16[AES_BLOCK_SIZE_BYTES],
+                           uint32_t counter)
+: mKeyed(mCounter.SeedKeyIV(key32, iv16, counter)) {
+}
+
+std::expected<void, AesCtrCipher::error_type>
+AesCtrCipher::encrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+    if (!mKeyed) return std::unexpected(AesCtrCipherError::NotKeyed);
+    mCounter.XorKeystream(source, destination);
+    return {};
+}
+
+std::expected<void, AesCtrCipher::error_type>
+AesCtrCipher::decrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+    if (!mKeyed) return std::unexpected(AesCtrCipherError::NotKeyed);
+    mCounter.XorKeystream(source, destination);
+    return {};
+}
+
+void AesCtrCipher::seek(uint64_t offset) noexcept {
+    if (mKeyed) mCounter.Seek(offset);
+}
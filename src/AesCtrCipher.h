@@ -0,0 +1,35 @@
+#ifndef AESCTRCIPHER_H
+#define AESCTRCIPHER_H
+
+#include "stdafx.h"
+#include "Cipher.h"
+#include "AESCounter.hpp"
+
+enum class AesCtrCipherError { None, NotKeyed };
+
+// AES-256-CTR over AESCounter's bulk keystream. Successive encrypt/decrypt calls continue the
+// stream (CTR is symmetric, so both XOR the same keystream); seek() repositions it.
+struct AesCtrCipher {
+    using error_type = AesCtrCipherError;
+
+    AesCtrCipher() = default;    // unkeyed: encrypt/decrypt fail with NotKeyed
+    AesCtrCipher(const uint8_t key32[AES_KEY_SIZE_BYTES], const uint8_t iv16[AES_BLOCK_SIZE_BYTES],
+                 uint32_t counter = 0);
+
+    std::expected<void, error_type>
+    encrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
+
+    std::expected<void, error_type>
+    decrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
+
+    void seek(uint64_t offset) noexcept;
+
+private:
+    AESCounter mCounter;
+    bool       mKeyed = false;
+};
+
+static_assert(Cipher<AesCtrCipher>);
+static_assert(SeekableCipher<AesCtrCipher>);
+
+#endif
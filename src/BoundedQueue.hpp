@@ -0,0 +1,77 @@
+#ifndef BOUNDEDQUEUE_HPP
+#define BOUNDEDQUEUE_HPP
+
+#include "stdafx.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Fixed-capacity multi-producer / multi-consumer FIFO. Push blocks while the queue is full,
+// which is what keeps a fast producer from running arbitrarily far ahead of its consumers;
+// Pop blocks while it is empty. Close() wakes everyone: pushes then fail, and pops drain what
+// is left before returning nullopt.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : mCapacity(capacity ? capacity : 1), mClosed(false) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool Push(T item) {
+        std::unique_lock<std::mutex> guard(mLock);
+        mNotFull.wait(guard, [this] { return mClosed || mItems.size() < mCapacity; });
+        if (mClosed) return false;
+        mItems.push_back(std::move(item));
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    // Non-blocking; leaves `item` untouched and returns false when full or closed.
+    bool TryPush(T& item) {
+        std::lock_guard<std::mutex> guard(mLock);
+        if (mClosed || mItems.size() >= mCapacity) return false;
+        mItems.push_back(std::move(item));
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    std::optional<T> Pop() {
+        std::unique_lock<std::mutex> guard(mLock);
+        mNotEmpty.wait(guard, [this] { return mClosed || !mItems.empty(); });
+        return Take();
+    }
+
+    std::optional<T> TryPop() {
+        std::lock_guard<std::mutex> guard(mLock);
+        return Take();
+    }
+
+    void Close() {
+        std::lock_guard<std::mutex> guard(mLock);
+        mClosed = true;
+        mNotEmpty.notify_all();
+        mNotFull.notify_all();
+    }
+
+    size_t Capacity() const { return mCapacity; }
+
+private:
+    std::optional<T> Take() {
+        if (mItems.empty()) return std::nullopt;
+        std::optional<T> item(std::move(mItems.front()));
+        mItems.pop_front();
+        mNotFull.notify_one();
+        return item;
+    }
+
+    const size_t            mCapacity;
+    std::mutex              mLock;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::deque<T>           mItems;
+    bool                    mClosed;
+};
+
+#endif
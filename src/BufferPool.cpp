@@ -0,0 +1,99 @@
+#include "BufferPool.hpp"
+#include <new>
+#include <utility>
+
+// ---------- PooledBuffer ----------
+
+PooledBuffer::PooledBuffer(PooledBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept {
+    if (this != &other) {
+        Release();
+        mPool = std::exchange(other.mPool, nullptr);
+        mData = std::exchange(other.mData, nullptr);
+        mSize = std::exchange(other.mSize, 0);
+    }
+    return *this;
+}
+
+void PooledBuffer::Release() {
+    if (mPool) mPool->Return(mData);
+    mPool = nullptr;
+    mData = nullptr;
+    mSize = 0;
+}
+
+// ---------- BufferPool ----------
+
+// Each thread gets a fixed shard the first time it touches any pool
+static size_t ThreadShard() {
+    static std::atomic<size_t> next(0);
+    thread_local const size_t shard = next.fetch_add(1, std::memory_order_relaxed) % BUFFER_POOL_SHARDS;
+    return shard;
+}
+
+void BufferPool::ArenaFree::operator()(std::byte* p) const {
+    ::operator delete(p, std::align_val_t(BUFFER_POOL_ALIGNMENT));
+}
+
+BufferPool::BufferPool(size_t bufferSize, size_t capacity)
+    : mBufferSize((std::max<size_t>(bufferSize, 1) + BUFFER_POOL_ALIGNMENT - 1) / BUFFER_POOL_ALIGNMENT * BUFFER_POOL_ALIGNMENT),
+      mCapacity(std::max<size_t>(capacity, 1)),
+      mAvailable(mCapacity),
+      mWaiters(0) {
+    mArena.reset((std::byte*)::operator new(mBufferSize * mCapacity, std::align_val_t(BUFFER_POOL_ALIGNMENT)));
+    // Every list can hold every buffer, so returning one never allocates
+    for (Shard& shard : mShards) shard.free.reserve(mCapacity);
+    // Dealt round the shards, so the first acquire on each thread usually stays local
+    for (size_t i = 0; i < mCapacity; ++i) {
+        mShards[i % BUFFER_POOL_SHARDS].free.push_back(mArena.get() + i * mBufferSize);
+    }
+}
+
+BufferPool::~BufferPool() = default;
+
+std::byte* BufferPool::TakeFree() {
+    const size_t home = ThreadShard();
+    for (size_t k = 0; k < BUFFER_POOL_SHARDS; ++k) {
+        Shard& shard = mShards[(home + k) % BUFFER_POOL_SHARDS];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        if (shard.free.empty()) continue;
+        std::byte* data = shard.free.back();   // most recently returned, most likely still cached
+        shard.free.pop_back();
+        mAvailable.fetch_sub(1);
+        return data;
+    }
+    return nullptr;
+}
+
+PooledBuffer BufferPool::TryAcquire() {
+    std::byte* data = TakeFree();
+    return data ? PooledBuffer(this, data, mBufferSize) : PooledBuffer();
+}
+
+PooledBuffer BufferPool::Acquire() {
+    for (;;) {
+        if (std::byte* data = TakeFree()) return PooledBuffer(this, data, mBufferSize);
+        // Count ourselves as waiting before re-checking, and Return() counts the buffer before
+        // looking for waiters: whichever happens second sees the other, so no wake-up is lost
+        std::unique_lock<std::mutex> guard(mWaitLock);
+        mWaiters.fetch_add(1);
+        mReturned.wait(guard, [this] { return mAvailable.load() != 0; });
+        mWaiters.fetch_sub(1);
+    }
+}
+
+void BufferPool::Return(std::byte* data) {
+    {
+        Shard& shard = mShards[ThreadShard()];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        shard.free.push_back(data);
+    }
+    mAvailable.fetch_add(1);
+    if (mWaiters.load() != 0) {
+        std::lock_guard<std::mutex> guard(mWaitLock);
+        mReturned.notify_one();
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef BUFFERPOOL_HPP
+#define BUFFERPOOL_HPP
+
+#include "stdafx.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+#define BUFFER_POOL_ALIGNMENT 64u   // a cache line; buffer sizes are rounded up to a multiple
+#define BUFFER_POOL_SHARDS    16u   // free lists; threads map onto them by a per-thread index
+
+class BufferPool;
+
+// A buffer on loan from a BufferPool; returns itself when destroyed. Move-only.
+class PooledBuffer {
+public:
+    PooledBuffer() = default;
+    ~PooledBuffer() { Release(); }
+
+    PooledBuffer(PooledBuffer&& other) noexcept;
+    PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    explicit operator bool() const { return mData != nullptr; }
+    std::span<std::byte> Span() const { return { mData, mSize }; }
+    std::byte* Data() const { return mData; }
+    size_t Size() const { return mSize; }
+
+    void Release();   // hand back early
+
+private:
+    friend class BufferPool;
+    PooledBuffer(BufferPool* pool, std::byte* data, size_t size) : mPool(pool), mData(data), mSize(size) {}
+
+    BufferPool* mPool = nullptr;
+    std::byte*  mData = nullptr;
+    size_t      mSize = 0;
+};
+
+// Fixed set of equal-sized buffers carved out of one aligned arena, allocated once up front.
+// Acquire() blocks while every buffer is on loan, so a pipeline that takes its chunk buffers
+// from here has a hard memory ceiling - capacity x bufferSize - whatever the input size, and
+// makes no allocations once running. Buffers go back to the free list of the releasing
+// thread and are taken from the acquiring thread's own list first, stealing from the others
+// only when it is empty, so a buffer tends to stay in the cache of the thread that last
+// touched it and threads rarely meet on a lock.
+//
+// The pool must outlive every buffer it hands out.
+class BufferPool {
+public:
+    BufferPool(size_t bufferSize, size_t capacity);
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    PooledBuffer Acquire();      // blocks until a buffer is free
+    PooledBuffer TryAcquire();   // empty handle when none is free
+
+    size_t BufferSize() const { return mBufferSize; }
+    size_t Capacity() const { return mCapacity; }
+    size_t Available() const { return mAvailable.load(std::memory_order_relaxed); }
+
+    // The whole arena, e.g. to register with an I/O backend once instead of per buffer.
+    std::span<std::byte> Arena() const { return { mArena.get(), mBufferSize * mCapacity }; }
+
+private:
+    friend class PooledBuffer;
+
+    struct alignas(BUFFER_POOL_ALIGNMENT) Shard {
+        std::mutex              lock;
+        std::vector<std::byte*> free;
+    };
+    struct ArenaFree {
+        void operator()(std::byte* p) const;
+    };
+
+    std::byte* TakeFree();
+    void Return(std::byte* data);
+
+    size_t                                 mBufferSize;
+    size_t                                 mCapacity;
+    std::unique_ptr<std::byte, ArenaFree>  mArena;
+    Shard                                  mShards[BUFFER_POOL_SHARDS];
+    std::atomic<size_t>                    mAvailable;
+    std::mutex                             mWaitLock;
+    std::condition_variable                mReturned;
+    std::atomic<size_t>                    mWaiters;       // threads blocked in Acquire()
+};
+
+#endif
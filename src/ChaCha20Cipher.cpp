@@ -0,0 +1,25 @@
+#include "ChaCha20Cipher.h"
+#include "stdafx.h"
+
+ChaCha20Cipher::ChaCha20Cipher(const uint8_t key32[CHACHA_KEY_SIZE_BYTES], const uint8_t nonce12[CHACHA_NONCE_SIZE_BYTES],
+                               uint32_t counter)
+: mKeyed(mCounter.SeedKeyNonce(key32, nonce12, counter)) {
+}
+
+std::expected<void, ChaCha20Cipher::error_type>
+ChaCha20Cipher::encrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+    if (!mKeyed) return std::unexpected(ChaCha20CipherError::NotKeyed);
+    mCounter.XorKeystream(source, destination);
+    return {};
+}
+
+std::expected<void, ChaCha20Cipher::error_type>
+ChaCha20Cipher::decrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+    if (!mKeyed) return std::unexpected(ChaCha20CipherError::NotKeyed);
+    mCounter.XorKeystream(source, destination);
+    return {};
+}
+
+void ChaCha20Cipher::seek(uint64_t offset) noexcept {
+    if (mKeyed) mCounter.Seek(offset);
+}
@@ -0,0 +1,35 @@
+#ifndef CHACHA20CIPHER_H
+#define CHACHA20CIPHER_H
+
+#include "stdafx.h"
+#include "Cipher.h"
+#include "ChaCha20Counter.hpp"
+
+enum class ChaCha20CipherError { None, NotKeyed };
+
+// RFC 8439 ChaCha20 over ChaCha20Counter's bulk (SIMD) keystream. Successive encrypt/decrypt
+// calls continue the stream (both XOR the same keystream); seek() repositions it.
+struct ChaCha20Cipher {
+    using error_type = ChaCha20CipherError;
+
+    ChaCha20Cipher() = default;  // unkeyed: encrypt/decrypt fail with NotKeyed
+    ChaCha20Cipher(const uint8_t key32[CHACHA_KEY_SIZE_BYTES], const uint8_t nonce12[CHACHA_NONCE_SIZE_BYTES],
+                   uint32_t counter = 0);
+
+    std::expected<void, error_type>
+    encrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
+
+    std::expected<void, error_type>
+    decrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
+
+    void seek(uint64_t offset) noexcept;
+
+private:
+    ChaCha20Counter mCounter;
+    bool            mKeyed = false;
+};
+
+static_assert(Cipher<ChaCha20Cipher>);
+static_assert(SeekableCipher<ChaCha20Cipher>);
+
+#endif
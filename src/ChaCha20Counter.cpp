@@ -1,4 +1,6 @@
 #include "ChaCha20Counter.hpp"
+#include "ChaCha20CounterSIMD.hpp"
+#include "CpuFeatures.hpp"
 #include <cstring>
 
 // ======== Small helpers ========
@@ -38,7 +40,7 @@ static inline void chacha_quarter_round(uint32_t& a, uint32_t& b, uint32_t& c, u
 }
 
 ChaCha20Counter::ChaCha20Counter()
-: mBlockUsed(CHACHA_BLOCK_SIZE_BYTES), mSeeded(false) {
+: mBlockUsed(CHACHA_BLOCK_SIZE_BYTES), mCounterBase(0), mBlockIndex(0), mSeeded(false), mBackend(BestBackend()) {
     std::memset(mState, 0, sizeof(mState));
     std::memset(mBlock,  0, sizeof(mBlock));
 }
@@ -51,9 +53,41 @@ void ChaCha20Counter::Clear() {
     SecureZero(mState, sizeof(mState));
     SecureZero(mBlock, sizeof(mBlock));
     mBlockUsed = CHACHA_BLOCK_SIZE_BYTES;
+    mCounterBase = 0;
+    mBlockIndex = 0;
     mSeeded = false;
 }
 
+bool ChaCha20Counter::IsBackendSupported(ChaChaBackend backend) {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    switch (backend) {
+    case ChaChaBackend::Auto:
+    case ChaChaBackend::Scalar:
+        return true;
+    case ChaChaBackend::SSE2:
+        return cpu.sse2;
+    case ChaChaBackend::AVX2:
+        return cpu.avx2;
+    case ChaChaBackend::AVX512:
+        return cpu.avx512f;
+    }
+    return false;
+}
+
+ChaChaBackend ChaCha20Counter::BestBackend() {
+    if (IsBackendSupported(ChaChaBackend::AVX512)) return ChaChaBackend::AVX512;
+    if (IsBackendSupported(ChaChaBackend::AVX2))   return ChaChaBackend::AVX2;
+    if (IsBackendSupported(ChaChaBackend::SSE2))   return ChaChaBackend::SSE2;
+    return ChaChaBackend::Scalar;
+}
+
+bool ChaCha20Counter::SetBackend(ChaChaBackend backend) {
+    if (backend == ChaChaBackend::Auto) backend = BestBackend();
+    if (!IsBackendSupported(backend)) return false;
+    mBackend = backend;
+    return true;
+}
+
 // RFC8439 state layout: constants | key[8] | counter | nonce[3]
 bool ChaCha20Counter::SeedKeyNonce(const uint8_t* key32, const uint8_t* nonce12, uint32_t counter) {
     if (!key32 || !nonce12) return false;
@@ -67,6 +101,8 @@ bool ChaCha20Counter::SeedKeyNonce(const uint8_t* key32, const uint8_t* nonce12,
         mState[4 + i] = LoadLE32(key32 + 4 * i);
     }
     mState[12] = counter;
+    mCounterBase = counter;
+    mBlockIndex = 0;
     mState[13] = LoadLE32(nonce12 + 0);
     mState[14] = LoadLE32(nonce12 + 4);
     mState[15] = LoadLE32(nonce12 + 8);
@@ -101,18 +137,101 @@ void ChaCha20Counter::Refill() {
 
     // increment 32-bit block counter
     mState[12] += 1u;
+    mBlockIndex += 1u;
 
     mBlockUsed = 0;
 }
 
-uint32_t ChaCha20Counter::Get() {
+void ChaCha20Counter::Process(const uint8_t* in, uint8_t* out, size_t len) {
+    EnsureSeeded();
+
+    // 1) Drain whatever Get()/an earlier call left in mBlock
+    while (len != 0 && mBlockUsed < CHACHA_BLOCK_SIZE_BYTES) {
+        *out++ = (uint8_t)((in ? *in++ : 0) ^ mBlock[mBlockUsed++]);
+        --len;
+    }
+
+    // 2) Whole blocks on the selected backend, straight into the caller's buffer
+    size_t blocks = len / CHACHA_BLOCK_SIZE_BYTES;
+    size_t done = 0;
+    switch (mBackend) {
+    case ChaChaBackend::AVX512:
+        done = ChaCha20BlocksAVX512(mState, in, out, blocks);
+        break;
+    case ChaChaBackend::AVX2:
+        done = ChaCha20BlocksAVX2(mState, in, out, blocks);
+        break;
+    case ChaChaBackend::SSE2:
+        done = ChaCha20BlocksSSE2(mState, in, out, blocks);
+        break;
+    default:
+        break;
+    }
+    mBlockIndex += done;
+    if (in) in += done * CHACHA_BLOCK_SIZE_BYTES;
+    out += done * CHACHA_BLOCK_SIZE_BYTES;
+    len -= done * CHACHA_BLOCK_SIZE_BYTES;
+
+    // 3) Everything left (sub-width whole blocks, then the tail) goes through the scalar Refill
+    while (len != 0) {
+        Refill();
+        const size_t n = len < CHACHA_BLOCK_SIZE_BYTES ? len : CHACHA_BLOCK_SIZE_BYTES;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = (uint8_t)((in ? in[i] : 0) ^ mBlock[i]);
+        }
+        mBlockUsed = (uint32_t)n;
+        if (in) in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+void ChaCha20Counter::Seek(uint64_t byteOffset) {
+    EnsureSeeded();
+
+    const uint64_t block = byteOffset / CHACHA_BLOCK_SIZE_BYTES;
+    mState[12] = mCounterBase + (uint32_t)block;
+    mBlockIndex = block;
+    mBlockUsed = CHACHA_BLOCK_SIZE_BYTES;
+
+    // Mid-block: buffer the containing block and skip into it
+    const uint32_t within = (uint32_t)(byteOffset % CHACHA_BLOCK_SIZE_BYTES);
+    if (within != 0) {
+        Refill();
+        mBlockUsed = within;
+    }
+}
+
+uint64_t ChaCha20Counter::Tell() const {
+    return mBlockIndex * CHACHA_BLOCK_SIZE_BYTES - (CHACHA_BLOCK_SIZE_BYTES - mBlockUsed);
+}
+
+void ChaCha20Counter::Generate(std::span<std::byte> out) {
+    Process(nullptr, (uint8_t*)out.data(), out.size());
+}
+
+void ChaCha20Counter::XorKeystream(std::span<const std::byte> src, std::byte* dst) {
+    Process((const uint8_t*)src.data(), (uint8_t*)dst, src.size());
+}
+
+void ChaCha20Counter::EnsureSeeded() {
     if (!mSeeded) {
         // If you want enforced seeding instead, you can assert here.
         static const uint8_t zeroKey[CHACHA_KEY_SIZE_BYTES] = {0};
         static const uint8_t zeroNonce[CHACHA_NONCE_SIZE_BYTES] = {0};
         SeedKeyNonce(zeroKey, zeroNonce, 0); // deterministic but NOT secure!
     }
+}
+
+uint32_t ChaCha20Counter::Get() {
+    EnsureSeeded();
     if (mBlockUsed > CHACHA_BLOCK_SIZE_BYTES - 4) {
+        if (mBlockUsed != CHACHA_BLOCK_SIZE_BYTES) {
+            // A byte-granular Generate() left 1..3 bytes behind; stitch the word across the refill
+            uint8_t w[4];
+            Process(nullptr, w, 4);
+            return LoadLE32(w);
+        }
         Refill();
     }
     uint32_t v = LoadLE32(mBlock + mBlockUsed);
@@ -11,10 +11,28 @@
 #define CHACHA_BLOCK_SIZE_BYTES    64u
 #define CHACHA_ROUNDS              20u  // standard is 20 rounds
 
+// Block-function implementations for the bulk API. All are bit-identical;
+// Scalar is the single-block Refill() path and stays as the reference.
+enum class ChaChaBackend {
+    Auto,    // best backend the running CPU supports (resolved by SetBackend)
+    Scalar,  // one block at a time
+    SSE2,    // 4 blocks per call (256 bytes)
+    AVX2,    // 8 blocks per call (512 bytes)
+    AVX512   // 16 blocks per call (1 KiB)
+};
+
 class ChaCha20Counter {
 public:
     ChaCha20Counter();
 
+    // Select the bulk block function (default: Auto). Returns false, leaving the backend
+    // unchanged, if this CPU cannot run the requested one. Get() always uses the scalar Refill().
+    bool SetBackend(ChaChaBackend backend);
+    ChaChaBackend Backend() const { return mBackend; }
+
+    static bool IsBackendSupported(ChaChaBackend backend);
+    static ChaChaBackend BestBackend();   // AVX512 > AVX2 > SSE2 > Scalar, probed with CPUID
+
     // Seed with exact, authoritative inputs (preferred).
     // key32: 32 bytes, nonce12: 12 bytes, counter: 32-bit block counter (usually 0).
     bool SeedKeyNonce(const uint8_t* key32, const uint8_t* nonce12, uint32_t counter = 0);
@@ -27,6 +45,21 @@ public:
     // Core generation
     uint32_t Get();                    // 32 bits
 
+    // Bulk generation. Both continue the exact byte stream Get() walks through (Get() returns
+    // the next 4 keystream bytes little-endian), so the calls can be mixed. Whole blocks are
+    // produced by the selected backend straight into the caller's memory; only a sub-block tail
+    // goes through mBlock.
+    void Generate(std::span<std::byte> out);
+
+    // dst[i] = src[i] ^ keystream[i]. dst may alias src (in-place), but must not partially overlap it.
+    void XorKeystream(std::span<const std::byte> src, std::byte* dst);
+
+    // Random access: position the stream at keystream byte byteOffset (0 = first byte after seeding)
+    // by setting the block counter to counter + byteOffset / 64. The 32-bit RFC 8439 counter wraps
+    // past 256 GiB exactly as sequential Get() calls would.
+    void Seek(uint64_t byteOffset);
+    uint64_t Tell() const;             // keystream byte the next Get()/Generate() starts at
+
     // Wipe internal key/counters/buffers
     void Clear();
 
@@ -36,6 +69,10 @@ private:
     // Refill the 64-byte keystream buffer
     void Refill();
 
+    // Shared body of Generate/XorKeystream; in == nullptr means plain keystream.
+    void Process(const uint8_t* in, uint8_t* out, size_t len);
+    void EnsureSeeded();
+
     // ChaCha20Counter20 helpers
     static inline uint32_t ROL32(uint32_t v, int r);
     static inline uint32_t LoadLE32(const uint8_t* p);
@@ -53,7 +90,10 @@ private:
     uint32_t mState[16];                          // ChaCha20Counter state (constants|key|counter|nonce)
     uint8_t  mBlock[CHACHA_BLOCK_SIZE_BYTES];     // buffered keystream
     uint32_t mBlockUsed;                          // bytes consumed from mBlock
+    uint32_t mCounterBase;                        // block counter at stream offset 0
+    uint64_t mBlockIndex;                         // blocks produced since seeding (unwrapped)
     bool     mSeeded;                             // seeded flag
+    ChaChaBackend mBackend;                       // bulk block function
 };
 
 #endif 
@@ -0,0 +1,228 @@
+#include "ChaCha20CounterSIMD.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CHACHA_TARGET_SSE2
+#define CHACHA_TARGET_AVX2
+#define CHACHA_TARGET_AVX512
+#else
+#define CHACHA_TARGET_SSE2   __attribute__((target("sse2")))
+#define CHACHA_TARGET_AVX2   __attribute__((target("avx2")))
+#define CHACHA_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// All kernels keep the state "vertical": vector i holds word i of every block in the group,
+// so one quarter round advances all blocks at once. The output is transposed back per block.
+
+// ==================== SSE2: 4 blocks ====================
+CHACHA_TARGET_SSE2 static inline __m128i Rol128(__m128i v, int r) {
+    return _mm_or_si128(_mm_slli_epi32(v, r), _mm_srli_epi32(v, 32 - r));
+}
+
+#define CHACHA_QR_SSE2(a, b, c, d)                                            \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = Rol128(d, 16);     \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = Rol128(b, 12);     \
+    a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = Rol128(d, 8);      \
+    c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = Rol128(b, 7);
+
+CHACHA_TARGET_SSE2 size_t ChaCha20BlocksSSE2(uint32_t state[16], const uint8_t* in, uint8_t* out, size_t blocks) {
+    const size_t groups = blocks / 4;
+    const __m128i laneCounter = _mm_set_epi32(3, 2, 1, 0);
+
+    for (size_t g = 0; g < groups; ++g) {
+        __m128i s[16], x[16];
+        for (int i = 0; i < 16; ++i) s[i] = _mm_set1_epi32((int)state[i]);
+        s[12] = _mm_add_epi32(s[12], laneCounter);
+        for (int i = 0; i < 16; ++i) x[i] = s[i];
+
+        for (int r = 0; r < 20; r += 2) {
+            CHACHA_QR_SSE2(x[0], x[4], x[8],  x[12])
+            CHACHA_QR_SSE2(x[1], x[5], x[9],  x[13])
+            CHACHA_QR_SSE2(x[2], x[6], x[10], x[14])
+            CHACHA_QR_SSE2(x[3], x[7], x[11], x[15])
+            CHACHA_QR_SSE2(x[0], x[5], x[10], x[15])
+            CHACHA_QR_SSE2(x[1], x[6], x[11], x[12])
+            CHACHA_QR_SSE2(x[2], x[7], x[8],  x[13])
+            CHACHA_QR_SSE2(x[3], x[4], x[9],  x[14])
+        }
+        for (int i = 0; i < 16; ++i) x[i] = _mm_add_epi32(x[i], s[i]);
+
+        // 4x4 transpose per group of four words: w[q][k] = words 4q..4q+3 of block k
+        for (int q = 0; q < 4; ++q) {
+            const __m128i t0 = _mm_unpacklo_epi32(x[4*q + 0], x[4*q + 1]);
+            const __m128i t1 = _mm_unpacklo_epi32(x[4*q + 2], x[4*q + 3]);
+            const __m128i t2 = _mm_unpackhi_epi32(x[4*q + 0], x[4*q + 1]);
+            const __m128i t3 = _mm_unpackhi_epi32(x[4*q + 2], x[4*q + 3]);
+            const __m128i w[4] = {
+                _mm_unpacklo_epi64(t0, t1), _mm_unpackhi_epi64(t0, t1),
+                _mm_unpacklo_epi64(t2, t3), _mm_unpackhi_epi64(t2, t3)
+            };
+            for (int k = 0; k < 4; ++k) {
+                __m128i v = w[k];
+                if (in) v = _mm_xor_si128(v, _mm_loadu_si128((const __m128i*)(in + 64 * k + 16 * q)));
+                _mm_storeu_si128((__m128i*)(out + 64 * k + 16 * q), v);
+            }
+        }
+
+        state[12] += 4u;
+        if (in) in += 256;
+        out += 256;
+    }
+    return groups * 4;
+}
+
+#undef CHACHA_QR_SSE2
+
+// ==================== AVX2: 8 blocks ====================
+CHACHA_TARGET_AVX2 static inline __m256i Rol256(__m256i v, int r) {
+    return _mm256_or_si256(_mm256_slli_epi32(v, r), _mm256_srli_epi32(v, 32 - r));
+}
+
+#define CHACHA_QR_AVX2(a, b, c, d)                                                          \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot16); \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = Rol256(b, 12);             \
+    a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = _mm256_shuffle_epi8(d, rot8);  \
+    c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = Rol256(b, 7);
+
+CHACHA_TARGET_AVX2 size_t ChaCha20BlocksAVX2(uint32_t state[16], const uint8_t* in, uint8_t* out, size_t blocks) {
+    const size_t groups = blocks / 8;
+    const __m256i laneCounter = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    // Byte rotations of each 32-bit lane by 16 and 8 bits
+    const __m256i rot16 = _mm256_set_epi8(13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2,
+                                          13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2);
+    const __m256i rot8  = _mm256_set_epi8(14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3,
+                                          14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3);
+
+    for (size_t g = 0; g < groups; ++g) {
+        __m256i s[16], x[16];
+        for (int i = 0; i < 16; ++i) s[i] = _mm256_set1_epi32((int)state[i]);
+        s[12] = _mm256_add_epi32(s[12], laneCounter);
+        for (int i = 0; i < 16; ++i) x[i] = s[i];
+
+        for (int r = 0; r < 20; r += 2) {
+            CHACHA_QR_AVX2(x[0], x[4], x[8],  x[12])
+            CHACHA_QR_AVX2(x[1], x[5], x[9],  x[13])
+            CHACHA_QR_AVX2(x[2], x[6], x[10], x[14])
+            CHACHA_QR_AVX2(x[3], x[7], x[11], x[15])
+            CHACHA_QR_AVX2(x[0], x[5], x[10], x[15])
+            CHACHA_QR_AVX2(x[1], x[6], x[11], x[12])
+            CHACHA_QR_AVX2(x[2], x[7], x[8],  x[13])
+            CHACHA_QR_AVX2(x[3], x[4], x[9],  x[14])
+        }
+        for (int i = 0; i < 16; ++i) x[i] = _mm256_add_epi32(x[i], s[i]);
+
+        // In-lane 4x4 transposes: w[q][k] = words 4q..4q+3 of block k (low lane) and block k+4 (high lane)
+        __m256i w[4][4];
+        for (int q = 0; q < 4; ++q) {
+            const __m256i t0 = _mm256_unpacklo_epi32(x[4*q + 0], x[4*q + 1]);
+            const __m256i t1 = _mm256_unpacklo_epi32(x[4*q + 2], x[4*q + 3]);
+            const __m256i t2 = _mm256_unpackhi_epi32(x[4*q + 0], x[4*q + 1]);
+            const __m256i t3 = _mm256_unpackhi_epi32(x[4*q + 2], x[4*q + 3]);
+            w[q][0] = _mm256_unpacklo_epi64(t0, t1);
+            w[q][1] = _mm256_unpackhi_epi64(t0, t1);
+            w[q][2] = _mm256_unpacklo_epi64(t2, t3);
+            w[q][3] = _mm256_unpackhi_epi64(t2, t3);
+        }
+        for (int k = 0; k < 4; ++k) {
+            __m256i v[4] = {
+                _mm256_permute2x128_si256(w[0][k], w[1][k], 0x20),  // block k,   words 0..7
+                _mm256_permute2x128_si256(w[2][k], w[3][k], 0x20),  // block k,   words 8..15
+                _mm256_permute2x128_si256(w[0][k], w[1][k], 0x31),  // block k+4, words 0..7
+                _mm256_permute2x128_si256(w[2][k], w[3][k], 0x31)   // block k+4, words 8..15
+            };
+            uint8_t* dst[4] = { out + 64 * k, out + 64 * k + 32, out + 64 * (k + 4), out + 64 * (k + 4) + 32 };
+            for (int j = 0; j < 4; ++j) {
+                if (in) v[j] = _mm256_xor_si256(v[j], _mm256_loadu_si256((const __m256i*)(in + (dst[j] - out))));
+                _mm256_storeu_si256((__m256i*)dst[j], v[j]);
+            }
+        }
+
+        state[12] += 8u;
+        if (in) in += 512;
+        out += 512;
+    }
+    _mm256_zeroupper();
+    return groups * 8;
+}
+
+#undef CHACHA_QR_AVX2
+
+// ==================== AVX-512: 16 blocks ====================
+#define CHACHA_QR_AVX512(a, b, c, d)                                                        \
+    a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d, 16);   \
+    c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b, 12);   \
+    a = _mm512_add_epi32(a, b); d = _mm512_xor_si512(d, a); d = _mm512_rol_epi32(d, 8);    \
+    c = _mm512_add_epi32(c, d); b = _mm512_xor_si512(b, c); b = _mm512_rol_epi32(b, 7);
+
+CHACHA_TARGET_AVX512 size_t ChaCha20BlocksAVX512(uint32_t state[16], const uint8_t* in, uint8_t* out, size_t blocks) {
+    const size_t groups = blocks / 16;
+    const __m512i laneCounter = _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+    for (size_t g = 0; g < groups; ++g) {
+        __m512i s[16], x[16];
+        for (int i = 0; i < 16; ++i) s[i] = _mm512_set1_epi32((int)state[i]);
+        s[12] = _mm512_add_epi32(s[12], laneCounter);
+        for (int i = 0; i < 16; ++i) x[i] = s[i];
+
+        for (int r = 0; r < 20; r += 2) {
+            CHACHA_QR_AVX512(x[0], x[4], x[8],  x[12])
+            CHACHA_QR_AVX512(x[1], x[5], x[9],  x[13])
+            CHACHA_QR_AVX512(x[2], x[6], x[10], x[14])
+            CHACHA_QR_AVX512(x[3], x[7], x[11], x[15])
+            CHACHA_QR_AVX512(x[0], x[5], x[10], x[15])
+            CHACHA_QR_AVX512(x[1], x[6], x[11], x[12])
+            CHACHA_QR_AVX512(x[2], x[7], x[8],  x[13])
+            CHACHA_QR_AVX512(x[3], x[4], x[9],  x[14])
+        }
+        for (int i = 0; i < 16; ++i) x[i] = _mm512_add_epi32(x[i], s[i]);
+
+        // In-lane 4x4 transposes: w[q][k] lane m = words 4q..4q+3 of block k + 4m
+        __m512i w[4][4];
+        for (int q = 0; q < 4; ++q) {
+            const __m512i t0 = _mm512_unpacklo_epi32(x[4*q + 0], x[4*q + 1]);
+            const __m512i t1 = _mm512_unpacklo_epi32(x[4*q + 2], x[4*q + 3]);
+            const __m512i t2 = _mm512_unpackhi_epi32(x[4*q + 0], x[4*q + 1]);
+            const __m512i t3 = _mm512_unpackhi_epi32(x[4*q + 2], x[4*q + 3]);
+            w[q][0] = _mm512_unpacklo_epi64(t0, t1);
+            w[q][1] = _mm512_unpackhi_epi64(t0, t1);
+            w[q][2] = _mm512_unpacklo_epi64(t2, t3);
+            w[q][3] = _mm512_unpackhi_epi64(t2, t3);
+        }
+        // 4x4 transpose of 128-bit lanes across the four word groups
+        for (int k = 0; k < 4; ++k) {
+            const __m512i u0 = _mm512_shuffle_i32x4(w[0][k], w[1][k], 0x44);
+            const __m512i u1 = _mm512_shuffle_i32x4(w[0][k], w[1][k], 0xEE);
+            const __m512i u2 = _mm512_shuffle_i32x4(w[2][k], w[3][k], 0x44);
+            const __m512i u3 = _mm512_shuffle_i32x4(w[2][k], w[3][k], 0xEE);
+            __m512i v[4] = {
+                _mm512_shuffle_i32x4(u0, u2, 0x88),   // block k
+                _mm512_shuffle_i32x4(u0, u2, 0xDD),   // block k + 4
+                _mm512_shuffle_i32x4(u1, u3, 0x88),   // block k + 8
+                _mm512_shuffle_i32x4(u1, u3, 0xDD)    // block k + 12
+            };
+            for (int m = 0; m < 4; ++m) {
+                const size_t off = 64 * (size_t)(k + 4 * m);
+                if (in) v[m] = _mm512_xor_si512(v[m], _mm512_loadu_si512(in + off));
+                _mm512_storeu_si512(out + off, v[m]);
+            }
+        }
+
+        state[12] += 16u;
+        if (in) in += 1024;
+        out += 1024;
+    }
+    _mm256_zeroupper();
+    return groups * 16;
+}
+
+#undef CHACHA_QR_AVX512
+
+#else
+
+size_t ChaCha20BlocksSSE2(uint32_t*, const uint8_t*, uint8_t*, size_t) { return 0; }
+size_t ChaCha20BlocksAVX2(uint32_t*, const uint8_t*, uint8_t*, size_t) { return 0; }
+size_t ChaCha20BlocksAVX512(uint32_t*, const uint8_t*, uint8_t*, size_t) { return 0; }
+
+#endif
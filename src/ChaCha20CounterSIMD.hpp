@@ -0,0 +1,17 @@
+#ifndef CHACHA20COUNTERSIMD_HPP
+#define CHACHA20COUNTERSIMD_HPP
+
+#include "stdafx.h"
+
+// Multi-block ChaCha20 kernels behind ChaCha20Counter's SIMD backends.
+// Each call runs as many whole groups of its width (4 / 8 / 16 blocks) as fit in `blocks`,
+// starting at state[12] and giving block i the counter state[12] + i (mod 2^32, as the scalar
+// Refill does). It advances state[12] past the blocks it wrote and returns how many that was;
+// the caller finishes the remainder on the scalar path.
+// out = in ^ keystream, or plain keystream when in == nullptr. Callers check GetCpuFeatures() first.
+
+size_t ChaCha20BlocksSSE2(uint32_t state[16], const uint8_t* in, uint8_t* out, size_t blocks);
+size_t ChaCha20BlocksAVX2(uint32_t state[16], const uint8_t* in, uint8_t* out, size_t blocks);
+size_t ChaCha20BlocksAVX512(uint32_t state[16], const uint8_t* in, uint8_t* out, size_t blocks);
+
+#endif
@@ -0,0 +1,90 @@
+#include "ChaCha20Poly1305Cipher.h"
+#include <cstring>
+
+#define CHACHA20_POLY1305_PASS     4096u                               // bytes ciphered, then authenticated, while in L1
+#define CHACHA20_POLY1305_MAX_TEXT ((uint64_t)UINT32_MAX * CHACHA_BLOCK_SIZE_BYTES)   // RFC 8439: 2^38 - 64 bytes
+
+ChaCha20Poly1305Cipher::ChaCha20Poly1305Cipher(const uint8_t key32[CHACHA_KEY_SIZE_BYTES],
+                                               const uint8_t nonce12[CHACHA_NONCE_SIZE_BYTES])
+: mKeyed(key32 && nonce12) {
+    if (!mKeyed) return;
+    std::memcpy(mKey, key32, CHACHA_KEY_SIZE_BYTES);
+    std::memcpy(mNonce, nonce12, CHACHA_NONCE_SIZE_BYTES);
+    restart(0);
+}
+
+ChaCha20Poly1305Cipher::~ChaCha20Poly1305Cipher() {
+    volatile uint8_t* p = mKey;
+    for (size_t n = sizeof(mKey); n; --n) *p++ = 0;
+}
+
+void ChaCha20Poly1305Cipher::restart(uint64_t sequence) noexcept {
+    if (!mKeyed) return;
+    uint8_t nonce[CHACHA_NONCE_SIZE_BYTES];
+    std::memcpy(nonce, mNonce, CHACHA_NONCE_SIZE_BYTES);
+    for (int i = 0; i < 8; ++i) nonce[4 + i] ^= (uint8_t)(sequence >> (8 * i));
+
+    // Block 0 keys Poly1305; the text starts at block 1
+    std::byte block0[CHACHA_BLOCK_SIZE_BYTES];
+    mCounter.SeedKeyNonce(mKey, nonce, 0);
+    mCounter.Generate(block0);
+    mMac.Reset((const uint8_t*)block0);
+    std::memset(block0, 0, sizeof(block0));
+    mAadLength = 0;
+    mTextLength = 0;
+}
+
+std::expected<void, ChaCha20Poly1305Cipher::error_type>
+ChaCha20Poly1305Cipher::aad(std::span<const std::byte> data) noexcept {
+    if (!mKeyed) return std::unexpected(ChaCha20Poly1305Error::NotKeyed);
+    if (mTextLength) return std::unexpected(ChaCha20Poly1305Error::AadAfterText);
+    mMac.Update(data);
+    mAadLength += data.size();
+    return {};
+}
+
+// The MAC always covers the ciphertext: what was just written when sealing, what is about to
+// be overwritten (source and destination may be the same) when opening.
+std::expected<void, ChaCha20Poly1305Cipher::error_type>
+ChaCha20Poly1305Cipher::Process(std::span<const std::byte> source, std::byte* destination, bool seal) noexcept {
+    if (!mKeyed) return std::unexpected(ChaCha20Poly1305Error::NotKeyed);
+    if (source.size() > CHACHA20_POLY1305_MAX_TEXT - mTextLength) {
+        return std::unexpected(ChaCha20Poly1305Error::MessageTooLong);
+    }
+    if (source.empty()) return {};
+    if (mTextLength == 0) mMac.Pad();   // closes the AAD
+    for (size_t at = 0; at < source.size(); at += CHACHA20_POLY1305_PASS) {
+        const std::span<const std::byte> pass = source.subspan(at, std::min<size_t>(CHACHA20_POLY1305_PASS, source.size() - at));
+        if (!seal) mMac.Update(pass);
+        mCounter.XorKeystream(pass, destination + at);
+        if (seal) mMac.Update(std::span<const std::byte>(destination + at, pass.size()));
+    }
+    mTextLength += source.size();
+    return {};
+}
+
+std::expected<void, ChaCha20Poly1305Cipher::error_type>
+ChaCha20Poly1305Cipher::encrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+    return Process(source, destination, true);
+}
+
+std::expected<void, ChaCha20Poly1305Cipher::error_type>
+ChaCha20Poly1305Cipher::decrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+    return Process(source, destination, false);
+}
+
+Poly1305Tag ChaCha20Poly1305Cipher::tag() const noexcept {
+    Poly1305 mac = mMac;
+    mac.Pad();
+    uint8_t lengths[16];
+    for (int i = 0; i < 8; ++i) {
+        lengths[i] = (uint8_t)(mAadLength >> (8 * i));
+        lengths[8 + i] = (uint8_t)(mTextLength >> (8 * i));
+    }
+    mac.Update(std::as_bytes(std::span<const uint8_t>(lengths)));
+    return mac.Final();
+}
+
+bool ChaCha20Poly1305Cipher::verify(const Poly1305Tag& expected) const noexcept {
+    return mKeyed && Poly1305::Equal(tag(), expected);
+}
@@ -0,0 +1,58 @@
+#ifndef CHACHA20POLY1305CIPHER_H
+#define CHACHA20POLY1305CIPHER_H
+
+#include "stdafx.h"
+#include "Cipher.h"
+#include "ChaCha20Counter.hpp"
+#include "Poly1305.hpp"
+
+enum class ChaCha20Poly1305Error { None, NotKeyed, AadAfterText, MessageTooLong };
+
+// RFC 8439 AEAD_CHACHA20_POLY1305, streamed: aad() first, then any number of encrypt (or
+// decrypt) calls, then tag() - or verify() - over everything so far. The Poly1305 key is
+// keystream block 0 and the text is ciphered from block 1 on. Each call ciphers and
+// authenticates in passes of a few KiB, so the MAC reads the ciphertext while it is still in
+// L1 rather than in a second trip over the whole buffer.
+//
+// Not seekable: restart(sequence) begins a new message instead, under the base nonce with
+// the sequence number XORed into its last 8 bytes (as TLS 1.3 does per record; sequence 0 is
+// the base nonce itself), so independent messages under one key can be sealed and opened
+// concurrently on copies of one keyed cipher.
+struct ChaCha20Poly1305Cipher {
+    using error_type = ChaCha20Poly1305Error;
+
+    ChaCha20Poly1305Cipher() = default;  // unkeyed: every call fails with NotKeyed
+    ChaCha20Poly1305Cipher(const uint8_t key32[CHACHA_KEY_SIZE_BYTES], const uint8_t nonce12[CHACHA_NONCE_SIZE_BYTES]);
+    ~ChaCha20Poly1305Cipher();
+
+    ChaCha20Poly1305Cipher(const ChaCha20Poly1305Cipher&) = default;
+    ChaCha20Poly1305Cipher& operator=(const ChaCha20Poly1305Cipher&) = default;
+
+    void restart(uint64_t sequence) noexcept;
+
+    std::expected<void, error_type> aad(std::span<const std::byte> data) noexcept;
+
+    std::expected<void, error_type>
+    encrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
+
+    std::expected<void, error_type>
+    decrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
+
+    Poly1305Tag tag() const noexcept;                  // of the message so far; the message may go on
+    bool verify(const Poly1305Tag& expected) const noexcept;   // constant-time compare against tag()
+
+private:
+    std::expected<void, error_type> Process(std::span<const std::byte> source, std::byte* destination, bool seal) noexcept;
+
+    ChaCha20Counter mCounter;
+    Poly1305        mMac;
+    uint8_t         mKey[CHACHA_KEY_SIZE_BYTES] = {};
+    uint8_t         mNonce[CHACHA_NONCE_SIZE_BYTES] = {};
+    uint64_t        mAadLength = 0;
+    uint64_t        mTextLength = 0;
+    bool            mKeyed = false;
+};
+
+static_assert(Cipher<ChaCha20Poly1305Cipher>);
+
+#endif
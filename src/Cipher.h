@@ -18,4 +18,14 @@ concept Cipher = requires(
         -> std::same_as<std::expected<void, typename CipherType::error_type>>;
 };
 
+// A Cipher whose output at stream byte N depends only on (key, N): copies can be positioned
+// independently with seek(), so disjoint chunks of one stream can be processed concurrently.
+template<class CipherType>
+concept SeekableCipher = Cipher<CipherType> && std::copy_constructible<CipherType> && requires(
+    CipherType cipher,
+    uint64_t offset
+) {
+    cipher.seek(offset);
+};
+
 #endif
@@ -1,20 +1,98 @@
 #include "CopyCipher.h"
+#include "CpuFeatures.hpp"
 #include "stdafx.h"
+#include <cstring>
 
-std::expected<void, CopyCipher::error_type>
-CopyCipher::encrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define COPY_CIPHER_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define COPY_TARGET_AVX2
+#else
+#define COPY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+#if defined(COPY_CIPHER_X86)
+// dst is 32-byte aligned, n a multiple of 128
+COPY_TARGET_AVX2 static void StreamCopyAVX2(const std::byte* src, std::byte* dst, size_t n) {
+    for (size_t i = 0; i < n; i += 128) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 32));
+        const __m256i c = _mm256_loadu_si256((const __m256i*)(src + i + 64));
+        const __m256i d = _mm256_loadu_si256((const __m256i*)(src + i + 96));
+        _mm256_stream_si256((__m256i*)(dst + i),      a);
+        _mm256_stream_si256((__m256i*)(dst + i + 32), b);
+        _mm256_stream_si256((__m256i*)(dst + i + 64), c);
+        _mm256_stream_si256((__m256i*)(dst + i + 96), d);
+    }
+    _mm256_zeroupper();
+}
+
+// dst is 32-byte aligned, n a multiple of 128
+static void StreamCopySSE2(const std::byte* src, std::byte* dst, size_t n) {
+    for (size_t i = 0; i < n; i += 64) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 16));
+        const __m128i c = _mm_loadu_si128((const __m128i*)(src + i + 32));
+        const __m128i d = _mm_loadu_si128((const __m128i*)(src + i + 48));
+        _mm_stream_si128((__m128i*)(dst + i),      a);
+        _mm_stream_si128((__m128i*)(dst + i + 16), b);
+        _mm_stream_si128((__m128i*)(dst + i + 32), c);
+        _mm_stream_si128((__m128i*)(dst + i + 48), d);
+    }
+}
+#endif
+
+static void Copy(CopyCipherMode mode, std::span<const std::byte> source, std::byte* destination) noexcept {
     const std::size_t n = source.size();
-    for (std::size_t i = 0; i < n; ++i) {
-        destination[i] = source[i];
+    const std::byte* src = source.data();
+    if (n == 0 || src == destination) return;  // in place: nothing to move
+
+    const bool overlap = (destination < src + n) && (src < destination + n);
+
+    switch (mode) {
+    case CopyCipherMode::ByteByByte:
+        if (overlap && destination > src) {
+            for (std::size_t i = n; i-- > 0;) destination[i] = src[i];
+        } else {
+            for (std::size_t i = 0; i < n; ++i) destination[i] = src[i];
+        }
+        return;
+
+    case CopyCipherMode::Streaming:
+#if defined(COPY_CIPHER_X86)
+        if (!overlap && n >= COPY_CIPHER_STREAMING_MIN) {
+            // Head up to 32-byte destination alignment, streamed body, cached tail
+            const std::size_t head = (32 - ((uintptr_t)destination & 31)) & 31;
+            std::memcpy(destination, src, head);
+            const std::size_t body = (n - head) & ~(std::size_t)127;
+            if (GetCpuFeatures().avx2) {
+                StreamCopyAVX2(src + head, destination + head, body);
+            } else {
+                StreamCopySSE2(src + head, destination + head, body);
+            }
+            _mm_sfence();  // order the weakly-ordered stores before anyone reads the result
+            std::memcpy(destination + head + body, src + head + body, n - head - body);
+            return;
+        }
+#endif
+        [[fallthrough]];
+
+    case CopyCipherMode::Wide:
+        std::memmove(destination, src, n);
+        return;
     }
+}
+
+std::expected<void, CopyCipher::error_type>
+CopyCipher::encrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
+    Copy(mode, source, destination);
     return {};
 }
 
 std::expected<void, CopyCipher::error_type>
 CopyCipher::decrypt(std::span<const std::byte> source, std::byte* destination) noexcept {
-    const std::size_t n = source.size();
-    for (std::size_t i = 0; i < n; ++i) {
-        destination[i] = source[i];
-    }
+    Copy(mode, source, destination);
     return {};
 }
@@ -6,17 +6,33 @@
 
 enum class CopyCipherError { None };
 
+// How CopyCipher moves bytes. All modes produce identical output.
+enum class CopyCipherMode {
+    ByteByByte,   // reference: byte-by-byte copy, no “fast copy” primitives
+    Wide,         // memmove: the C library's widest loads/stores
+    Streaming     // non-temporal stores for buffers >= COPY_CIPHER_STREAMING_MIN, so a large copy
+                  // does not evict the working set; smaller buffers fall back to Wide
+};
+
+#define COPY_CIPHER_STREAMING_MIN (1u << 20)   // below this the destination is likely re-read soon
+
 struct CopyCipher {
     using error_type = CopyCipherError;
 
-    // Byte-by-byte copy, no “fast copy” primitives.
+    // Every mode is in-place capable: source.data() == destination is a no-op.
+    CopyCipherMode mode = CopyCipherMode::ByteByByte;
+
     std::expected<void, error_type>
     encrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
 
     std::expected<void, error_type>
     decrypt(std::span<const std::byte> source, std::byte* destination) noexcept;
+
+    // Stateless, so every stream position looks the same.
+    void seek(uint64_t) noexcept {}
 };
 
 static_assert(Cipher<CopyCipher>);
+static_assert(SeekableCipher<CopyCipher>);
 
 #endif
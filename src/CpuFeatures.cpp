@@ -0,0 +1,118 @@
+#include "CpuFeatures.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CPU_FEATURES_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+#if defined(CPU_FEATURES_X86)
+static void cpuid(uint32_t leaf, uint32_t subleaf, uint32_t r[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int v[4];
+    __cpuidex(v, (int)leaf, (int)subleaf);
+    for (int i = 0; i < 4; ++i) r[i] = (uint32_t)v[i];
+#else
+    __cpuid_count(leaf, subleaf, r[0], r[1], r[2], r[3]);
+#endif
+}
+
+static uint64_t xgetbv0() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(0);
+#else
+    uint32_t lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+#endif
+}
+
+// Walks a deterministic cache parameters leaf - 4 on Intel, 0x8000001D on AMD, same layout -
+// one subleaf per cache until the null type
+static void DetectCaches(uint32_t leaf, CpuFeatures& f) {
+    uint32_t r[4];
+    for (uint32_t sub = 0; sub < 16; ++sub) {
+        cpuid(leaf, sub, r);
+        const uint32_t type = r[0] & 0x1F;   // 1 data, 2 instruction, 3 unified
+        if (type == 0) break;
+        if (type == 2) continue;
+        const uint32_t level = (r[0] >> 5) & 0x7;
+        const uint32_t sharing = ((r[0] >> 14) & 0xFFF) + 1;
+        const uint64_t bytes = (uint64_t)((r[1] >> 22) + 1) * (((r[1] >> 12) & 0x3FF) + 1) *
+                               ((r[1] & 0xFFF) + 1) * ((uint64_t)r[2] + 1);
+        const uint32_t share = (uint32_t)std::min<uint64_t>(bytes / sharing, UINT32_MAX);
+        if (level == 1) f.l1dBytes = share;
+        if (level == 2) f.l2Bytes = share;
+    }
+}
+#endif
+
+static CpuFeatures DetectCpuFeatures() {
+    CpuFeatures f;
+#if defined(CPU_FEATURES_X86)
+    uint32_t r[4];
+    cpuid(0, 0, r);
+    const uint32_t maxLeaf = r[0];
+
+    cpuid(1, 0, r);
+    const uint32_t ecx1 = r[2], edx1 = r[3];
+    f.sse2   = (edx1 >> 26) & 1;
+    f.ssse3  = (ecx1 >> 9)  & 1;
+    f.sse41  = (ecx1 >> 19) & 1;
+    f.sse42  = (ecx1 >> 20) & 1;
+    f.pclmul = (ecx1 >> 1)  & 1;
+    f.aesni  = (ecx1 >> 25) & 1;
+
+    // AVX state must be enabled by the OS (OSXSAVE + XCR0 bits), not just present
+    const bool osxsave = (ecx1 >> 27) & 1;
+    const uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+    const bool ymmState = (xcr0 & 0x06) == 0x06;
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+    if (maxLeaf >= 7) {
+        cpuid(7, 0, r);
+        const uint32_t ebx7 = r[1], ecx7 = r[2];
+        f.avx2     = ymmState && ((ebx7 >> 5) & 1);
+        f.avx512f  = zmmState && ((ebx7 >> 16) & 1);
+        f.avx512bw = f.avx512f && ((ebx7 >> 30) & 1);
+        f.avx512vl = f.avx512f && ((ebx7 >> 31) & 1);
+        f.vaes     = ymmState && f.aesni && ((ecx7 >> 9) & 1);
+        f.vpclmul  = ymmState && f.pclmul && ((ecx7 >> 10) & 1);
+        f.sha      = (ebx7 >> 29) & 1;
+    }
+
+    cpuid(0x80000000u, 0, r);
+    const uint32_t maxExtLeaf = r[0];
+    bool topologyExt = false;
+    if (maxExtLeaf >= 0x80000001u) {
+        cpuid(0x80000001u, 0, r);
+        topologyExt = (r[2] >> 22) & 1;   // AMD: leaf 0x8000001D is there
+    }
+    if (topologyExt && maxExtLeaf >= 0x8000001Du) DetectCaches(0x8000001Du, f);
+    else if (maxLeaf >= 4) DetectCaches(4, f);
+#elif defined(__APPLE__)
+    uint64_t bytes = 0;
+    size_t size = sizeof(bytes);
+    if (sysctlbyname("hw.l1dcachesize", &bytes, &size, nullptr, 0) == 0) f.l1dBytes = (uint32_t)bytes;
+    size = sizeof(bytes);
+    if (sysctlbyname("hw.l2cachesize", &bytes, &size, nullptr, 0) == 0) f.l2Bytes = (uint32_t)bytes;
+#elif defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    f.l1dBytes = (uint32_t)std::max(0L, sysconf(_SC_LEVEL1_DCACHE_SIZE));
+    f.l2Bytes  = (uint32_t)std::max(0L, sysconf(_SC_LEVEL2_CACHE_SIZE));
+#endif
+    return f;
+}
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = DetectCpuFeatures();
+    return features;
+}
@@ -0,0 +1,33 @@
+#ifndef CPUFEATURES_HPP
+#define CPUFEATURES_HPP
+
+#include "stdafx.h"
+
+// Runtime CPU capabilities, probed once with CPUID (and XGETBV for the OS-enabled
+// register state). Lets a single binary pick SIMD / crypto-extension kernels at run time,
+// and block sizes that fit the caches. The feature flags read false on non-x86 targets;
+// the cache sizes come from the OS there, where it says.
+struct CpuFeatures {
+    bool sse2     = false;
+    bool ssse3    = false;
+    bool sse41    = false;
+    bool sse42    = false;   // crc32 instruction
+    bool pclmul   = false;
+    bool aesni    = false;
+    bool avx2     = false;
+    bool avx512f  = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+    bool vaes     = false;   // 256/512-bit aesenc (only reported when the matching register state is usable)
+    bool vpclmul  = false;
+    bool sha      = false;   // SHA-256 extensions (sha256rnds2 / msg1 / msg2)
+
+    // Data cache per logical processor: a cache shared by several (hyperthreads, a cluster)
+    // counts for each its share. 0 when unknown.
+    uint32_t l1dBytes = 0;
+    uint32_t l2Bytes  = 0;
+};
+
+const CpuFeatures& GetCpuFeatures();
+
+#endif
@@ -0,0 +1,137 @@
+#include "Crc32c.hpp"
+#include "CpuFeatures.hpp"
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CRC32C_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CRC32C_TARGET
+#else
+#define CRC32C_TARGET __attribute__((target("sse4.2,pclmul")))
+#endif
+#endif
+
+#define CRC32C_POLY  0x82F63B78u
+#define CRC32C_LONG  8192u   // bytes per stream when a long buffer is checksummed as three
+#define CRC32C_SHORT 256u    // the same for what is left after the long strides
+
+// Slicing-by-8: table[k][b] is the CRC of byte b followed by k zero bytes
+static constexpr std::array<std::array<uint32_t, 256>, 8> MakeTables() {
+    std::array<std::array<uint32_t, 256>, 8> t{};
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t c = b;
+        for (int k = 0; k < 8; ++k) c = (c >> 1) ^ ((0u - (c & 1u)) & CRC32C_POLY);
+        t[0][b] = c;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+        for (int k = 1; k < 8; ++k) t[k][b] = (t[k - 1][b] >> 8) ^ t[0][t[k - 1][b] & 0xFF];
+    }
+    return t;
+}
+
+static constexpr auto kTables = MakeTables();
+
+// Takes and returns the running (inverted) register
+static uint32_t Crc32cPortable(const uint8_t* p, size_t n, uint32_t crc) {
+    while (n >= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        if constexpr (std::endian::native == std::endian::big) word = std::byteswap(word);
+        word ^= crc;
+        crc = kTables[7][word & 0xFF]         ^ kTables[6][(word >> 8) & 0xFF]  ^
+              kTables[5][(word >> 16) & 0xFF] ^ kTables[4][(word >> 24) & 0xFF] ^
+              kTables[3][(word >> 32) & 0xFF] ^ kTables[2][(word >> 40) & 0xFF] ^
+              kTables[1][(word >> 48) & 0xFF] ^ kTables[0][word >> 56];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) crc = (crc >> 8) ^ kTables[0][(crc ^ *p++) & 0xFF];
+    return crc;
+}
+
+// a * b modulo the polynomial, bit-reflected like the CRC itself: bit 31 is x^0
+static constexpr uint32_t MultModP(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = 1u << 31; m; m >>= 1) {
+        if (a & m) product ^= b;
+        b = (b >> 1) ^ ((0u - (b & 1u)) & CRC32C_POLY);
+    }
+    return product;
+}
+
+// x^n modulo the polynomial
+static constexpr uint32_t XPowModP(uint64_t n) {
+    uint32_t result = 1u << 31, square = 1u << 30;   // x^0, x^1
+    for (; n; n >>= 1) {
+        if (n & 1) result = MultModP(result, square);
+        square = MultModP(square, square);
+    }
+    return result;
+}
+
+#if defined(CRC32C_X86)
+// Moving a register n bytes further along the message multiplies it by x^(8n). A carry-less
+// multiply by x^(8n - 33) and one crc32 over the 64-bit product do that: the crc32 reduces
+// and supplies the x^64 (less one for the reflected product's shift, less 32 for the crc32
+// register's own width).
+static constexpr uint32_t kLongShift1  = XPowModP(8ull * CRC32C_LONG - 33);
+static constexpr uint32_t kLongShift2  = XPowModP(16ull * CRC32C_LONG - 33);
+static constexpr uint32_t kShortShift1 = XPowModP(8ull * CRC32C_SHORT - 33);
+static constexpr uint32_t kShortShift2 = XPowModP(16ull * CRC32C_SHORT - 33);
+
+// crc32 has a latency of three cycles and a throughput of one, so three independent streams
+// over neighbouring thirds of a stride keep it busy; their registers are then folded into one
+// with PCLMULQDQ.
+CRC32C_TARGET static uint64_t Crc32cStrides(const uint8_t*& p, size_t& n, uint64_t c0, size_t lane,
+                                            uint32_t shift1, uint32_t shift2) {
+    while (n >= 3 * lane) {
+        uint64_t c1 = 0, c2 = 0;
+        for (const uint8_t* end = p + lane; p < end; p += 8) {
+            uint64_t w0, w1, w2;
+            std::memcpy(&w0, p, 8);
+            std::memcpy(&w1, p + lane, 8);
+            std::memcpy(&w2, p + 2 * lane, 8);
+            c0 = _mm_crc32_u64(c0, w0);
+            c1 = _mm_crc32_u64(c1, w1);
+            c2 = _mm_crc32_u64(c2, w2);
+        }
+        const __m128i a = _mm_clmulepi64_si128(_mm_cvtsi32_si128((int)c0), _mm_cvtsi32_si128((int)shift2), 0);
+        const __m128i b = _mm_clmulepi64_si128(_mm_cvtsi32_si128((int)c1), _mm_cvtsi32_si128((int)shift1), 0);
+        c0 = _mm_crc32_u64(0, (uint64_t)_mm_cvtsi128_si64(_mm_xor_si128(a, b))) ^ c2;
+        p += 2 * lane;
+        n -= 3 * lane;
+    }
+    return c0;
+}
+
+CRC32C_TARGET static uint32_t Crc32cHardware(const uint8_t* p, size_t n, uint32_t crc) {
+    uint64_t c0 = crc;
+    for (; n && ((uintptr_t)p & 7); --n) c0 = _mm_crc32_u8((uint32_t)c0, *p++);
+    c0 = Crc32cStrides(p, n, c0, CRC32C_LONG, kLongShift1, kLongShift2);
+    c0 = Crc32cStrides(p, n, c0, CRC32C_SHORT, kShortShift1, kShortShift2);
+    for (; n >= 8; n -= 8, p += 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        c0 = _mm_crc32_u64(c0, word);
+    }
+    while (n--) c0 = _mm_crc32_u8((uint32_t)c0, *p++);
+    return (uint32_t)c0;
+}
+#endif
+
+using Crc32cFn = uint32_t (*)(const uint8_t*, size_t, uint32_t);
+
+static Crc32cFn PickCrc32c() {
+#if defined(CRC32C_X86)
+    if (GetCpuFeatures().sse42 && GetCpuFeatures().pclmul) return Crc32cHardware;
+#endif
+    return Crc32cPortable;
+}
+
+uint32_t Crc32c(std::span<const std::byte> data, uint32_t crc) {
+    static const Crc32cFn crc32c = PickCrc32c();   // on first use, like Sha256's kernel
+    return ~crc32c((const uint8_t*)data.data(), data.size(), ~crc);
+}
@@ -0,0 +1,12 @@
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include "stdafx.h"
+
+// CRC-32C (Castagnoli, reflected polynomial 0x82F63B78), as used by iSCSI, ext4 and SSE4.2.
+// Crc32c(data) is the finished checksum; pass a previous result as `crc` to continue it.
+// Runs on the SSE4.2 crc32 instruction, three streams at a time folded with PCLMULQDQ, when
+// the CPU has both; slicing-by-8 tables otherwise.
+uint32_t Crc32c(std::span<const std::byte> data, uint32_t crc = 0);
+
+#endif
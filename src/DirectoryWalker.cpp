@@ -0,0 +1,59 @@
+#include "DirectoryWalker.hpp"
+#include <mutex>
+
+namespace fs = std::filesystem;
+
+std::expected<std::vector<WalkedFile>, std::error_code>
+DirectoryWalker::Walk(const fs::path& root, const std::atomic<bool>* cancel) {
+    std::vector<WalkedFile> files;
+    std::vector<std::string> level{ std::string() };   // relative paths of the directories to list next
+
+    std::mutex failureLock;
+    std::error_code failure;
+    while (!level.empty()) {
+        if (cancel && cancel->load(std::memory_order_relaxed)) {
+            return std::unexpected(std::make_error_code(std::errc::operation_canceled));
+        }
+
+        std::vector<std::vector<WalkedFile>> found(level.size());
+        std::vector<std::vector<std::string>> below(level.size());
+        mPool.ParallelFor(level.size(), [&](size_t i) {
+            std::error_code ec;
+            const fs::path directory = level[i].empty() ? root : root / fs::path(level[i]);
+            for (fs::directory_iterator it(directory, ec), end; !ec && it != end; it.increment(ec)) {
+                const std::string name = it->path().filename().generic_string();
+                std::string relative = level[i].empty() ? name : level[i] + "/" + name;
+                if (it->is_symlink(ec)) {
+                    // A dangling link is skipped, not an error
+                    std::error_code target;
+                    if (it->is_regular_file(target)) {
+                        const uint64_t size = it->file_size(target);
+                        if (!target) found[i].push_back({ it->path(), std::move(relative), size });
+                    }
+                } else if (it->is_directory(ec)) {
+                    below[i].push_back(std::move(relative));
+                } else if (!ec && it->is_regular_file(ec)) {
+                    const uint64_t size = it->file_size(ec);
+                    found[i].push_back({ it->path(), std::move(relative), size });
+                }
+                if (ec) break;
+            }
+            if (ec) {
+                std::lock_guard<std::mutex> guard(failureLock);
+                if (!failure) failure = ec;
+            }
+        });
+        if (failure) return std::unexpected(failure);
+
+        std::vector<std::string> next;
+        for (size_t i = 0; i < level.size(); ++i) {
+            for (WalkedFile& f : found[i]) files.push_back(std::move(f));
+            for (std::string& d : below[i]) next.push_back(std::move(d));
+        }
+        level = std::move(next);
+    }
+
+    std::sort(files.begin(), files.end(),
+              [](const WalkedFile& a, const WalkedFile& b) { return a.relativePath < b.relativePath; });
+    return files;
+}
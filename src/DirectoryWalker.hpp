@@ -0,0 +1,34 @@
+#ifndef DIRECTORYWALKER_HPP
+#define DIRECTORYWALKER_HPP
+
+#include "stdafx.h"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <system_error>
+
+struct WalkedFile {
+    std::filesystem::path path;
+    std::string           relativePath;   // '/'-separated, below the walk root
+    uint64_t              size = 0;
+};
+
+// Lists every regular file below a directory, reading one level of the tree at a time across
+// the pool: the directories of a level are listed in parallel and their subdirectories make up
+// the next level. The result is sorted by relativePath, so it depends neither on thread timing
+// nor on the order the filesystem hands entries back. Symlinks to files are listed; symlinks
+// to directories are not followed.
+class DirectoryWalker {
+public:
+    explicit DirectoryWalker(ThreadPool& pool = ThreadPool::Shared()) : mPool(pool) {}
+
+    // Fails with the first filesystem error, or operation_canceled once *cancel is set.
+    std::expected<std::vector<WalkedFile>, std::error_code>
+    Walk(const std::filesystem::path& root, const std::atomic<bool>* cancel = nullptr);
+
+private:
+    ThreadPool& mPool;
+};
+
+#endif
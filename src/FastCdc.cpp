@@ -0,0 +1,55 @@
+#include "FastCdc.hpp"
+#include <array>
+#include <bit>
+
+// 256 random 64-bit words (splitmix64), fixed so chunk boundaries never change between builds
+static constexpr std::array<uint64_t, 256> MakeGearTable() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x48514741434b4344ull;   // "HQGACKCD"
+    for (uint64_t& g : table) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        g = z ^ (z >> 31);
+    }
+    return table;
+}
+
+static constexpr std::array<uint64_t, 256> kGear = MakeGearTable();
+
+// The top `bits` bits; the gear hash shifts left, so those are the ones every byte of the
+// 64-byte window has reached.
+static constexpr uint64_t TopBits(int bits) {
+    return bits <= 0 ? 0 : ~0ull << (64 - bits);
+}
+
+FastCdc::FastCdc(uint32_t maxSize) {
+    mMax = std::max<uint32_t>(maxSize, 64);
+    mAverage = std::bit_floor(mMax / 4);
+    mMin = mAverage / 4;
+    const int bits = std::countr_zero(mAverage);
+    mMaskSmall = TopBits(bits + 2);
+    mMaskLarge = TopBits(bits - 2);
+}
+
+size_t FastCdc::Cut(std::span<const std::byte> data) const {
+    const uint8_t* const p = (const uint8_t*)data.data();
+    const size_t n = std::min<size_t>(data.size(), mMax);
+    if (n <= mMin) return n;
+
+    // Bytes before the minimum can never end a chunk, so hashing starts 64 bytes short of
+    // it: just enough for the window to be full there
+    size_t i = mMin - std::min<size_t>(mMin, 64);
+    uint64_t hash = 0;
+    for (; i < mMin; ++i) hash = (hash << 1) + kGear[p[i]];
+    const size_t normal = std::min<size_t>(n, mAverage);
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + kGear[p[i]];
+        if ((hash & mMaskSmall) == 0) return i + 1;
+    }
+    for (; i < n; ++i) {
+        hash = (hash << 1) + kGear[p[i]];
+        if ((hash & mMaskLarge) == 0) return i + 1;
+    }
+    return n;
+}
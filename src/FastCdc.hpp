@@ -0,0 +1,34 @@
+#ifndef FASTCDC_HPP
+#define FASTCDC_HPP
+
+#include "stdafx.h"
+
+// Content-defined chunking (FastCDC, Xia et al. 2016). A gear hash rolls over the last 64
+// bytes and a cut is made where its top bits are all zero, so boundaries follow the content:
+// inserting or deleting bytes moves the cuts next to the edit only, and the chunks after it
+// come out the same as before - which is what lets a later copy of mostly unchanged data be
+// found chunk by chunk. Chunk sizes are normalised towards the average by demanding more
+// zero bits before it and fewer after.
+class FastCdc {
+public:
+    // Chunks of at most `maxSize` bytes, averaging a quarter of that (rounded down to a power
+    // of two), and at least a quarter of the average.
+    explicit FastCdc(uint32_t maxSize);
+
+    // Length of the chunk at the start of `data`: all of it when it is no longer than the
+    // minimum, never more than the maximum.
+    size_t Cut(std::span<const std::byte> data) const;
+
+    uint32_t MinSize() const { return mMin; }
+    uint32_t AverageSize() const { return mAverage; }
+    uint32_t MaxSize() const { return mMax; }
+
+private:
+    uint32_t mMin;
+    uint32_t mAverage;
+    uint32_t mMax;
+    uint64_t mMaskSmall;   // before the average: harder to match
+    uint64_t mMaskLarge;   // after it: easier
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include "IoBackend.hpp"
+#include <atomic>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <filesystem>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char* IoBackendKindName(IoBackendKind kind) {
+    switch (kind) {
+    case IoBackendKind::Auto:    return "auto";
+    case IoBackendKind::Uring:   return "io_uring";
+    case IoBackendKind::Threads: return "threads";
+    }
+    return "unknown";
+}
+
+// ---------- IoFile ----------
+
+IoFile::~IoFile() {
+    Close();
+}
+
+IoFile::IoFile(IoFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+#if defined(_WIN32)
+
+static std::wstring WidePath(const std::string& utf8) {
+    return std::filesystem::path(std::u8string((const char8_t*)utf8.data(), utf8.size())).wstring();
+}
+
+IoFile& IoFile::operator=(IoFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        mHandle = std::exchange(other.mHandle, nullptr);
+    }
+    return *this;
+}
+
+std::expected<void, IoError> IoFile::OpenRead(const std::string& path) {
+    Close();
+    HANDLE file = CreateFileW(WidePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::unexpected(IoError::OpenFailed);
+    mHandle = file;
+    return {};
+}
+
+std::expected<void, IoError> IoFile::Create(const std::string& path, uint64_t size) {
+    Close();
+    HANDLE file = CreateFileW(WidePath(path).c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::unexpected(IoError::OpenFailed);
+    mHandle = file;
+    FILE_END_OF_FILE_INFO end;
+    end.EndOfFile.QuadPart = (LONGLONG)size;
+    if (!SetFileInformationByHandle(file, FileEndOfFileInfo, &end, sizeof(end))) {
+        Close();
+        return std::unexpected(IoError::ResizeFailed);
+    }
+    return {};
+}
+
+std::expected<void, IoError> IoFile::OpenWrite(const std::string& path) {
+    Close();
+    HANDLE file = CreateFileW(WidePath(path).c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::unexpected(IoError::OpenFailed);
+    mHandle = file;
+    return {};
+}
+
+void IoFile::Close() {
+    if (mHandle) CloseHandle((HANDLE)mHandle);
+    mHandle = nullptr;
+}
+
+bool IoFile::IsOpen() const {
+    return mHandle != nullptr;
+}
+
+// A synchronous handle still takes its position from the OVERLAPPED, so concurrent
+// transfers on one handle do not race on a shared file pointer.
+std::expected<size_t, IoError> IoFile::ReadAt(uint64_t offset, std::span<std::byte> data) const {
+    OVERLAPPED at = {};
+    at.Offset = (DWORD)offset;
+    at.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD got = 0;
+    const DWORD want = (DWORD)std::min<size_t>(data.size(), 1u << 30);
+    if (!ReadFile((HANDLE)mHandle, data.data(), want, &got, &at)) {
+        if (GetLastError() == ERROR_HANDLE_EOF) return 0;
+        return std::unexpected(IoError::ReadFailed);
+    }
+    return (size_t)got;
+}
+
+std::expected<size_t, IoError> IoFile::WriteAt(uint64_t offset, std::span<const std::byte> data) const {
+    OVERLAPPED at = {};
+    at.Offset = (DWORD)offset;
+    at.OffsetHigh = (DWORD)(offset >> 32);
+    DWORD put = 0;
+    const DWORD want = (DWORD)std::min<size_t>(data.size(), 1u << 30);
+    if (!WriteFile((HANDLE)mHandle, data.data(), want, &put, &at)) return std::unexpected(IoError::WriteFailed);
+    return (size_t)put;
+}
+
+#else
+
+IoFile& IoFile::operator=(IoFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        mFd = std::exchange(other.mFd, -1);
+    }
+    return *this;
+}
+
+std::expected<void, IoError> IoFile::OpenRead(const std::string& path) {
+    Close();
+    mFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (mFd < 0) return std::unexpected(IoError::OpenFailed);
+    return {};
+}
+
+std::expected<void, IoError> IoFile::Create(const std::string& path, uint64_t size) {
+    Close();
+    mFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (mFd < 0) return std::unexpected(IoError::OpenFailed);
+    if (::ftruncate(mFd, (off_t)size) != 0) {
+        Close();
+        return std::unexpected(IoError::ResizeFailed);
+    }
+    return {};
+}
+
+std::expected<void, IoError> IoFile::OpenWrite(const std::string& path) {
+    Close();
+    mFd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (mFd < 0) return std::unexpected(IoError::OpenFailed);
+    return {};
+}
+
+void IoFile::Close() {
+    if (mFd >= 0) ::close(mFd);
+    mFd = -1;
+}
+
+bool IoFile::IsOpen() const {
+    return mFd >= 0;
+}
+
+std::expected<size_t, IoError> IoFile::ReadAt(uint64_t offset, std::span<std::byte> data) const {
+    for (;;) {
+        const ssize_t got = ::pread(mFd, data.data(), data.size(), (off_t)offset);
+        if (got >= 0) return (size_t)got;
+        if (errno != EINTR) return std::unexpected(IoError::ReadFailed);
+    }
+}
+
+std::expected<size_t, IoError> IoFile::WriteAt(uint64_t offset, std::span<const std::byte> data) const {
+    for (;;) {
+        const ssize_t put = ::pwrite(mFd, data.data(), data.size(), (off_t)offset);
+        if (put >= 0) return (size_t)put;
+        if (errno != EINTR) return std::unexpected(IoError::WriteFailed);
+    }
+}
+
+#endif
+
+// ---------- IoBackend ----------
+
+IoBackend::~IoBackend() = default;
+
+// Blocking positional I/O spread over a pool: each request is one task, so up to a pool's
+// worth of transfers wait on the disk at once. Fine for any OS and any filesystem. Called
+// from one of the pool's own workers it runs the batch in place: that caller is already one
+// of many in parallel, and helping out from inside could pick up an unrelated long-running
+// task and stall this batch behind it.
+class ThreadIoBackend : public IoBackend {
+public:
+    explicit ThreadIoBackend(ThreadPool& pool) : mPool(pool) {}
+
+    IoBackendKind Kind() const override { return IoBackendKind::Threads; }
+    std::expected<void, IoError> Read(std::span<const IoRequest> requests) override { return Run(requests, false); }
+    std::expected<void, IoError> Write(std::span<const IoRequest> requests) override { return Run(requests, true); }
+
+private:
+    static std::expected<void, IoError> Transfer(const IoRequest& request, bool write) {
+        size_t done = 0;
+        while (done < request.length) {
+            const auto moved = write
+                ? request.file->WriteAt(request.offset + done, { request.data + done, request.length - done })
+                : request.file->ReadAt(request.offset + done, { request.data + done, request.length - done });
+            if (!moved) return std::unexpected(moved.error());
+            if (*moved == 0) return std::unexpected(write ? IoError::WriteFailed : IoError::ShortRead);
+            done += *moved;
+        }
+        return {};
+    }
+
+    std::expected<void, IoError> Run(std::span<const IoRequest> requests, bool write) {
+        if (requests.size() == 1 || mPool.IsWorkerThread()) {
+            for (const IoRequest& request : requests) {
+                auto moved = Transfer(request, write);
+                if (!moved) return moved;
+            }
+            return {};
+        }
+        std::atomic<int> failure((int)IoError::None);
+        mPool.ParallelFor(requests.size(), [&](size_t i) {
+            if (failure.load(std::memory_order_relaxed) != (int)IoError::None) return;
+            const auto result = Transfer(requests[i], write);
+            if (!result) {
+                int expected = (int)IoError::None;
+                failure.compare_exchange_strong(expected, (int)result.error());
+            }
+        });
+        if (failure.load() != (int)IoError::None) return std::unexpected((IoError)failure.load());
+        return {};
+    }
+
+    ThreadPool& mPool;
+};
+
+std::unique_ptr<IoBackend>
+IoBackend::Create(IoBackendKind kind, ThreadPool& pool, std::span<const std::span<std::byte>> registered) {
+    if (kind != IoBackendKind::Threads) {
+        std::unique_ptr<IoBackend> uring = CreateUringBackend(registered);
+        if (uring) return uring;
+    }
+    return std::make_unique<ThreadIoBackend>(pool);
+}
@@ -0,0 +1,94 @@
+#ifndef IOBACKEND_HPP
+#define IOBACKEND_HPP
+
+#include "stdafx.h"
+#include "ThreadPool.hpp"
+#include <memory>
+#include <string>
+
+#define IO_BACKEND_DEPTH 64u   // requests an io_uring keeps in flight
+
+enum class IoBackendKind { Auto, Uring, Threads };   // Auto = io_uring when the kernel allows it
+enum class IoError { None, OpenFailed, ResizeFailed, ReadFailed, WriteFailed, ShortRead };
+
+const char* IoBackendKindName(IoBackendKind kind);
+
+// A file opened for positional reads or writes; move-only.
+class IoFile {
+public:
+    IoFile() = default;
+    ~IoFile();
+
+    IoFile(IoFile&& other) noexcept;
+    IoFile& operator=(IoFile&& other) noexcept;
+    IoFile(const IoFile&) = delete;
+    IoFile& operator=(const IoFile&) = delete;
+
+    std::expected<void, IoError> OpenRead(const std::string& path);
+
+    // Creates (or truncates) a file of exactly `size` bytes for positional writes.
+    std::expected<void, IoError> Create(const std::string& path, uint64_t size);
+
+    // Opens an existing file for positional writes, leaving its size and contents alone.
+    std::expected<void, IoError> OpenWrite(const std::string& path);
+
+    void Close();
+    bool IsOpen() const;
+
+    // One blocking transfer at `offset`; returns the bytes moved, which may be short.
+    std::expected<size_t, IoError> ReadAt(uint64_t offset, std::span<std::byte> data) const;
+    std::expected<size_t, IoError> WriteAt(uint64_t offset, std::span<const std::byte> data) const;
+
+#if defined(_WIN32)
+    void* Native() const { return mHandle; }   // HANDLE
+#else
+    int   Native() const { return mFd; }
+#endif
+
+private:
+#if defined(_WIN32)
+    void* mHandle = nullptr;
+#else
+    int   mFd = -1;
+#endif
+};
+
+// One positional transfer. `buffer` names the registered region that holds data, or is -1
+// for any other memory.
+struct IoRequest {
+    const IoFile* file = nullptr;
+    uint64_t      offset = 0;
+    std::byte*    data = nullptr;
+    uint32_t      length = 0;
+    int           buffer = -1;
+};
+
+// Batched positional I/O. A batch is handed over whole so the backend can keep many
+// transfers in flight - io_uring submits them together and reaps completions as they land,
+// the thread backend spreads blocking pread / pwrite calls over a pool - and returns once
+// every request has completed. Short transfers are resumed; a read that hits end of file
+// fails with ShortRead. On failure nothing is still in flight when the call returns.
+//
+// A backend belongs to one thread at a time. Memory regions that will carry most transfers
+// (a BufferPool arena, say) are registered at creation; io_uring pins them in the kernel so
+// transfers into them skip the per-call page lookup, the other backends ignore them. The
+// regions must outlive the backend.
+class IoBackend {
+public:
+    virtual ~IoBackend();
+
+    virtual IoBackendKind Kind() const = 0;
+    virtual std::expected<void, IoError> Read(std::span<const IoRequest> requests) = 0;
+    virtual std::expected<void, IoError> Write(std::span<const IoRequest> requests) = 0;
+
+    // Falls back to Threads when io_uring is requested but not available (non-Linux, old
+    // kernel, or blocked by a sandbox).
+    static std::unique_ptr<IoBackend> Create(IoBackendKind kind = IoBackendKind::Auto,
+                                             ThreadPool& pool = ThreadPool::Shared(),
+                                             std::span<const std::span<std::byte>> registered = {});
+};
+
+// IoUring.cpp; nullptr when io_uring cannot be set up here.
+std::unique_ptr<IoBackend> CreateUringBackend(std::span<const std::span<std::byte>> registered);
+
+#endif
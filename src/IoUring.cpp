@@ -0,0 +1,208 @@
+#include "IoBackend.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Straight syscalls rather than liburing, so the build needs nothing beyond the kernel headers.
+static int UringSetup(unsigned entries, io_uring_params* params) {
+    return (int)::syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int UringEnter(int ring, unsigned submit, unsigned waitFor, unsigned flags) {
+    return (int)::syscall(__NR_io_uring_enter, ring, submit, waitFor, flags, nullptr, 0);
+}
+
+static int UringRegister(int ring, unsigned opcode, const void* arg, unsigned count) {
+    return (int)::syscall(__NR_io_uring_register, ring, opcode, arg, count);
+}
+
+// One submission / completion ring pair, owned by one thread. The kernel advances the cq tail,
+// read with acquire; the indices we publish (sq tail, cq head) are stored with release. At
+// most sq_entries requests are ever queued or in flight, so neither ring can overflow.
+class UringIoBackend : public IoBackend {
+public:
+    ~UringIoBackend() override {
+        if (mSqes) ::munmap(mSqes, mSqesSize);
+        if (mCqRing && mCqRing != mSqRing) ::munmap(mCqRing, mCqRingSize);
+        if (mSqRing) ::munmap(mSqRing, mSqRingSize);
+        if (mRing >= 0) ::close(mRing);
+    }
+
+    bool Init(std::span<const std::span<std::byte>> registered) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        mRing = UringSetup(IO_BACKEND_DEPTH, &params);
+        if (mRing < 0) return false;
+
+        mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+
+        void* sq = ::mmap(nullptr, mSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          mRing, IORING_OFF_SQ_RING);
+        if (sq == MAP_FAILED) return false;
+        mSqRing = (char*)sq;
+        if (single) {
+            mCqRing = mSqRing;
+        } else {
+            void* cq = ::mmap(nullptr, mCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              mRing, IORING_OFF_CQ_RING);
+            if (cq == MAP_FAILED) return false;
+            mCqRing = (char*)cq;
+        }
+        mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            mRing, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) return false;
+        mSqes = (io_uring_sqe*)sqes;
+
+        mSqTail = (unsigned*)(mSqRing + params.sq_off.tail);
+        mSqMask = *(unsigned*)(mSqRing + params.sq_off.ring_mask);
+        mSqArray = (unsigned*)(mSqRing + params.sq_off.array);
+        mSqEntries = params.sq_entries;
+        mCqHead = (unsigned*)(mCqRing + params.cq_off.head);
+        mCqTail = (unsigned*)(mCqRing + params.cq_off.tail);
+        mCqMask = *(unsigned*)(mCqRing + params.cq_off.ring_mask);
+        mCqes = (io_uring_cqe*)(mCqRing + params.cq_off.cqes);
+
+        if (!Supports(IORING_OP_READ) || !Supports(IORING_OP_WRITE)) return false;
+
+        // Registration pins the pages; it can fail against RLIMIT_MEMLOCK, in which case the
+        // regions still work, just through the unregistered opcodes
+        if (!registered.empty()) {
+            std::vector<iovec> vectors;
+            for (std::span<std::byte> region : registered) vectors.push_back({ region.data(), region.size() });
+            mRegistered = UringRegister(mRing, IORING_REGISTER_BUFFERS, vectors.data(), (unsigned)vectors.size()) == 0;
+        }
+        return true;
+    }
+
+    IoBackendKind Kind() const override { return IoBackendKind::Uring; }
+    std::expected<void, IoError> Read(std::span<const IoRequest> requests) override { return Run(requests, false); }
+    std::expected<void, IoError> Write(std::span<const IoRequest> requests) override { return Run(requests, true); }
+
+private:
+    bool Supports(unsigned opcode) {
+        std::vector<unsigned char> storage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* probe = (io_uring_probe*)storage.data();
+        if (UringRegister(mRing, IORING_REGISTER_PROBE, probe, 256) != 0) return false;
+        return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    void Prepare(const IoRequest& request, uint64_t done, size_t index, bool write) {
+        const unsigned tail = *mSqTail;
+        const unsigned slot = tail & mSqMask;
+        io_uring_sqe* sqe = &mSqes[slot];
+        std::memset(sqe, 0, sizeof(*sqe));
+        const bool fixed = mRegistered && request.buffer >= 0;
+        sqe->opcode = fixed ? (write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED)
+                            : (write ? IORING_OP_WRITE : IORING_OP_READ);
+        sqe->fd = request.file->Native();
+        sqe->off = request.offset + done;
+        sqe->addr = (uint64_t)(uintptr_t)(request.data + done);
+        sqe->len = (uint32_t)(request.length - done);
+        if (fixed) sqe->buf_index = (uint16_t)request.buffer;
+        sqe->user_data = index;
+        mSqArray[slot] = slot;
+        __atomic_store_n(mSqTail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    // Keeps up to the ring's capacity in flight: submit what is ready, wait for at least one
+    // completion, resubmit short transfers. After a failure nothing new is queued, but the
+    // call still waits for everything the kernel holds, since it may be writing our buffers.
+    std::expected<void, IoError> Run(std::span<const IoRequest> requests, bool write) {
+        if (mRing < 0) return std::unexpected(write ? IoError::WriteFailed : IoError::ReadFailed);
+        std::vector<uint64_t> done(requests.size(), 0);
+        std::deque<size_t> ready;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (requests[i].length) ready.push_back(i);
+        }
+
+        IoError failure = IoError::None;
+        unsigned queued = 0;     // published to the ring, not yet taken by the kernel
+        unsigned inFlight = 0;   // taken by the kernel, not yet completed
+        while (queued != 0 || inFlight != 0 || (!ready.empty() && failure == IoError::None)) {
+            while (failure == IoError::None && !ready.empty() && queued + inFlight < mSqEntries) {
+                const size_t i = ready.front();
+                ready.pop_front();
+                Prepare(requests[i], done[i], i, write);
+                ++queued;
+            }
+
+            int entered = UringEnter(mRing, queued, 1, IORING_ENTER_GETEVENTS);
+            if (entered < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EBUSY) {
+                    // The ring itself is unusable; closing it cancels whatever it still holds
+                    ::close(mRing);
+                    mRing = -1;
+                    return std::unexpected(write ? IoError::WriteFailed : IoError::ReadFailed);
+                }
+                entered = 0;   // out of kernel resources: reap, then try again
+            }
+            queued -= (unsigned)entered;
+            inFlight += (unsigned)entered;
+
+            unsigned head = *mCqHead;
+            const unsigned tail = __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = mCqes[head & mCqMask];
+                const size_t i = (size_t)cqe.user_data;
+                --inFlight;
+                if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                    ready.push_front(i);
+                } else if (cqe.res < 0) {
+                    if (failure == IoError::None) failure = write ? IoError::WriteFailed : IoError::ReadFailed;
+                } else if (cqe.res == 0) {
+                    if (failure == IoError::None) failure = write ? IoError::WriteFailed : IoError::ShortRead;
+                } else {
+                    done[i] += (uint64_t)cqe.res;
+                    if (done[i] < requests[i].length) ready.push_front(i);
+                }
+            }
+            __atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+        }
+        if (failure != IoError::None) return std::unexpected(failure);
+        return {};
+    }
+
+    int           mRing = -1;
+    char*         mSqRing = nullptr;
+    char*         mCqRing = nullptr;
+    size_t        mSqRingSize = 0;
+    size_t        mCqRingSize = 0;
+    io_uring_sqe* mSqes = nullptr;
+    size_t        mSqesSize = 0;
+    unsigned*     mSqTail = nullptr;
+    unsigned*     mSqArray = nullptr;
+    unsigned      mSqMask = 0;
+    unsigned      mSqEntries = 0;
+    unsigned*     mCqHead = nullptr;
+    unsigned*     mCqTail = nullptr;
+    unsigned      mCqMask = 0;
+    io_uring_cqe* mCqes = nullptr;
+    bool          mRegistered = false;
+};
+
+std::unique_ptr<IoBackend> CreateUringBackend(std::span<const std::span<std::byte>> registered) {
+    auto backend = std::make_unique<UringIoBackend>();
+    if (!backend->Init(registered)) return nullptr;
+    return backend;
+}
+
+#else
+
+std::unique_ptr<IoBackend> CreateUringBackend(std::span<const std::span<std::byte>>) {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,222 @@
+#include "Lz77.hpp"
+#include <bit>
+#include <cstring>
+
+static inline uint32_t Load32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint32_t Hash4(uint32_t v, int bits) {
+    return (v * 2654435761u) >> (32 - bits);
+}
+
+// Length of the common run at a and b, stopping at limit (a's bound; b trails a).
+static inline size_t MatchLength(const uint8_t* a, const uint8_t* b, const uint8_t* limit) {
+    const uint8_t* start = a;
+    while (a + 8 <= limit) {
+        uint64_t x, y;
+        std::memcpy(&x, a, 8);
+        std::memcpy(&y, b, 8);
+        if (x != y) {
+            const int bit = std::endian::native == std::endian::little ? std::countr_zero(x ^ y) : std::countl_zero(x ^ y);
+            return (size_t)(a - start) + (size_t)(bit >> 3);
+        }
+        a += 8;
+        b += 8;
+    }
+    while (a < limit && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return (size_t)(a - start);
+}
+
+static inline uint8_t* PutLength(uint8_t* op, size_t length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Worst case for one sequence: token, both length continuations, literals, offset.
+static inline size_t SequenceBound(size_t literals, size_t match) {
+    return 1 + literals / 255 + 1 + literals + 2 + match / 255 + 1;
+}
+
+Lz77Compressor::Lz77Compressor()
+    : mHead((size_t)1 << LZ77_HASH_BITS, 0),
+      mChain((size_t)LZ77_WINDOW + 1, 0) {}
+
+size_t Lz77Compressor::Compress(std::span<const std::byte> in, std::span<std::byte> out, int level) {
+    return Compress(in, out, level, SIZE_MAX, {});
+}
+
+size_t Lz77Compressor::Compress(std::span<const std::byte> in, std::span<std::byte> out, int level, size_t stride,
+                                const Flush& flush) {
+    const uint8_t* const src = (const uint8_t*)in.data();
+    const size_t n = in.size();
+    uint8_t* op = (uint8_t*)out.data();
+    uint8_t* const opEnd = op + out.size();
+    uint8_t* flushed = op;   // output before this has gone to `flush`
+    if (n == 0 || n > UINT32_MAX) return 0;
+
+    level = std::clamp(level, 1, LZ77_MAX_LEVEL);
+    const unsigned depth = 1u << (level - 1);
+    // Small blocks hash into a smaller table, so clearing it does not cost more than the block
+    const int bits = std::clamp((int)std::bit_width(n), 10, LZ77_HASH_BITS);
+    std::fill_n(mHead.begin(), (size_t)1 << bits, 0u);
+    // mChain needs no reset: a slot is only read for a position inserted during this call
+
+    const auto insert = [&](size_t pos) {
+        const uint32_t h = Hash4(Load32(src + pos), bits);
+        mChain[pos & LZ77_WINDOW] = mHead[h];
+        mHead[h] = (uint32_t)pos + 1;
+    };
+
+    size_t ip = 0;
+    size_t anchor = 0;
+    if (n > LZ77_MATCH_START) {
+        const size_t matchStartLimit = n - LZ77_MATCH_START;
+        const uint8_t* const matchLimit = src + n - LZ77_LAST_LITERALS;
+        unsigned misses = 0;
+        while (ip < matchStartLimit) {
+            const uint32_t here = Load32(src + ip);
+            size_t bestLength = 0;
+            size_t bestAt = 0;
+            uint32_t candidate = mHead[Hash4(here, bits)];
+            for (unsigned probe = 0; probe < depth && candidate != 0; ++probe) {
+                const size_t at = candidate - 1;
+                if (ip - at > LZ77_WINDOW) break;
+                if (Load32(src + at) == here) {
+                    const size_t length = LZ77_MIN_MATCH + MatchLength(src + ip + LZ77_MIN_MATCH,
+                                                                       src + at + LZ77_MIN_MATCH, matchLimit);
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestAt = at;
+                    }
+                }
+                const uint32_t next = mChain[at & LZ77_WINDOW];
+                if (next >= candidate) break;   // chains only run backwards
+                candidate = next;
+            }
+            insert(ip);
+
+            if (bestLength == 0) {
+                // Level 1 speeds up through stretches that keep missing, as LZ4 does
+                ip += 1 + (level == 1 ? (misses++ >> 6) : 0);
+                continue;
+            }
+            misses = 0;
+            while (ip > anchor && bestAt > 0 && src[ip - 1] == src[bestAt - 1]) {
+                --ip;
+                --bestAt;
+                ++bestLength;
+            }
+
+            const size_t literals = ip - anchor;
+            const size_t matchCode = bestLength - LZ77_MIN_MATCH;
+            if ((size_t)(opEnd - op) < SequenceBound(literals, matchCode)) return 0;
+            uint8_t* token = op++;
+            *token = (uint8_t)((std::min<size_t>(literals, 15) << 4) | std::min<size_t>(matchCode, 15));
+            if (literals >= 15) op = PutLength(op, literals - 15);
+            std::memcpy(op, src + anchor, literals);
+            op += literals;
+            const size_t offset = ip - bestAt;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            if (matchCode >= 15) op = PutLength(op, matchCode - 15);
+
+            // Index the positions the match covered; the fast level only takes its tail
+            const size_t end = ip + bestLength;
+            const size_t stop = std::min(end, matchStartLimit);
+            const size_t first = level == 1 ? std::max(ip + 1, end - 2) : ip + 1;
+            for (size_t pos = first; pos < stop; ++pos) insert(pos);
+            ip = end;
+            anchor = ip;
+
+            if (flush && (size_t)(op - flushed) >= stride) {
+                if (!flush(std::span<std::byte>((std::byte*)flushed, (size_t)(op - flushed)))) return 0;
+                flushed = op;
+            }
+        }
+    }
+
+    const size_t literals = n - anchor;
+    if ((size_t)(opEnd - op) < 1 + literals / 255 + 1 + literals) return 0;
+    *op++ = (uint8_t)(std::min<size_t>(literals, 15) << 4);
+    if (literals >= 15) op = PutLength(op, literals - 15);
+    std::memcpy(op, src + anchor, literals);
+    op += literals;
+    if (flush && !flush(std::span<std::byte>((std::byte*)flushed, (size_t)(op - flushed)))) return 0;
+    return (size_t)(op - (uint8_t*)out.data());
+}
+
+// Reads a length continuation; fails on truncation or a total past `cap`.
+static inline bool GetLength(const uint8_t*& ip, const uint8_t* ipEnd, size_t& length, size_t cap) {
+    uint8_t b;
+    do {
+        if (ip == ipEnd) return false;
+        b = *ip++;
+        length += b;
+        if (length > cap) return false;
+    } while (b == 255);
+    return true;
+}
+
+std::expected<void, Lz77Error> Lz77Decompress(std::span<const std::byte> in, std::span<std::byte> out) {
+    const uint8_t* ip = (const uint8_t*)in.data();
+    const uint8_t* const ipEnd = ip + in.size();
+    uint8_t* const base = (uint8_t*)out.data();
+    uint8_t* op = base;
+    uint8_t* const opEnd = base + out.size();
+
+    for (;;) {
+        if (ip == ipEnd) return std::unexpected(Lz77Error::Corrupt);
+        const uint8_t token = *ip++;
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !GetLength(ip, ipEnd, literals, out.size())) return std::unexpected(Lz77Error::Corrupt);
+        if (literals > (size_t)(ipEnd - ip) || literals > (size_t)(opEnd - op)) return std::unexpected(Lz77Error::Corrupt);
+        // Short runs copy a fixed 16 bytes when both sides have the slack; the overshoot is
+        // rewritten by what follows
+        if (literals <= 16 && ipEnd - ip >= 16 && opEnd - op >= 16) std::memcpy(op, ip, 16);
+        else std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        if (ip == ipEnd) {
+            // The closing literals-only sequence
+            if ((token & 15) != 0 || op != opEnd) return std::unexpected(Lz77Error::Corrupt);
+            return {};
+        }
+
+        if (ipEnd - ip < 2) return std::unexpected(Lz77Error::Corrupt);
+        const size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - base)) return std::unexpected(Lz77Error::Corrupt);
+
+        size_t length = token & 15;
+        if (length == 15 && !GetLength(ip, ipEnd, length, out.size())) return std::unexpected(Lz77Error::Corrupt);
+        length += LZ77_MIN_MATCH;
+        if (length > (size_t)(opEnd - op)) return std::unexpected(Lz77Error::Corrupt);
+
+        const uint8_t* match = op - offset;
+        if (offset >= 16 && (size_t)(opEnd - op) >= length + 16) {
+            for (size_t done = 0; done < length; done += 16) std::memcpy(op + done, match + done, 16);
+        } else if (offset >= length) {
+            std::memcpy(op, match, length);
+        } else if (offset >= 8) {
+            // Overlapping, but every 8-byte step reads bytes already written
+            size_t done = 0;
+            for (; done + 8 <= length; done += 8) std::memcpy(op + done, match + done, 8);
+            for (; done < length; ++done) op[done] = match[done];
+        } else {
+            for (size_t i = 0; i < length; ++i) op[i] = match[i];
+        }
+        op += length;
+    }
+}
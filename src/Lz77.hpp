@@ -0,0 +1,54 @@
+#ifndef LZ77_HPP
+#define LZ77_HPP
+
+#include "stdafx.h"
+#include <functional>
+
+// In-house LZ77 block codec in the LZ4 mould: byte-aligned sequences, no entropy stage, so
+// decoding is little more than memcpy. A block is a run of sequences
+//
+//   token      high nibble literal count, low nibble match length - LZ77_MIN_MATCH
+//              (15 in either means "more follows": bytes added on until one is not 255)
+//   literals
+//   offset     u16 little-endian distance back to the match, 1..LZ77_WINDOW
+//   [length continuation bytes]
+//
+// and always ends with a literals-only sequence of at least LZ77_LAST_LITERALS bytes.
+
+#define LZ77_MIN_MATCH      4
+#define LZ77_LAST_LITERALS  5        // no match may reach into the last bytes of a block
+#define LZ77_MATCH_START    12       // nor start in the last 12
+#define LZ77_WINDOW         65535u   // u16 offsets
+#define LZ77_HASH_BITS      16
+#define LZ77_MAX_LEVEL      9
+
+enum class Lz77Error { None, Corrupt };
+
+// Reusable compressor state (match-finder tables, about 512 KiB); one per thread.
+class Lz77Compressor {
+public:
+    Lz77Compressor();
+
+    // Compresses `in` into `out` at `level`: 1 is a single hash probe with skipping over
+    // incompressible stretches, each step up doubles the hash-chain search depth, up to
+    // LZ77_MAX_LEVEL. Returns the compressed size, or 0 when it would not fit in `out`; give
+    // `out` fewer bytes than `in` to ask for "only if it shrinks".
+    size_t Compress(std::span<const std::byte> in, std::span<std::byte> out, int level);
+
+    // Same, handing the output to `flush` as it is finished: in order, `stride` bytes or more
+    // at a time (the last piece whatever is left), while it is still in cache. Output is never
+    // touched again once flushed, so `flush` may rewrite it in place. A false return abandons
+    // the block; either way 0 means nothing usable, possibly after some flushes.
+    using Flush = std::function<bool(std::span<std::byte> finished)>;
+    size_t Compress(std::span<const std::byte> in, std::span<std::byte> out, int level, size_t stride, const Flush& flush);
+
+private:
+    std::vector<uint32_t> mHead;    // hash -> most recent position + 1, 0 = none
+    std::vector<uint32_t> mChain;   // position % window -> previous position + 1 with that hash
+};
+
+// Decodes a block into exactly out.size() bytes. Every length and offset is bounds-checked,
+// so corrupt or hostile input fails with Corrupt rather than reading or writing out of range.
+std::expected<void, Lz77Error> Lz77Decompress(std::span<const std::byte> in, std::span<std::byte> out);
+
+#endif
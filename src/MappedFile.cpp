@@ -0,0 +1,201 @@
+#include "MappedFile.hpp"
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <filesystem>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        Close();
+        mData = std::exchange(other.mData, nullptr);
+        mSize = std::exchange(other.mSize, 0);
+        mOpen = std::exchange(other.mOpen, false);
+        mWritable = std::exchange(other.mWritable, false);
+#if defined(_WIN32)
+        mFile = std::exchange(other.mFile, nullptr);
+        mMapping = std::exchange(other.mMapping, nullptr);
+#else
+        mFd = std::exchange(other.mFd, -1);
+#endif
+    }
+    return *this;
+}
+
+#if defined(_WIN32)
+
+static std::wstring WidePath(const std::string& utf8) {
+    return std::filesystem::path(std::u8string((const char8_t*)utf8.data(), utf8.size())).wstring();
+}
+
+std::expected<void, MappedFileError> MappedFile::OpenRead(const std::string& path) {
+    Close();
+    HANDLE file = CreateFileW(WidePath(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::unexpected(MappedFileError::OpenFailed);
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) { CloseHandle(file); return std::unexpected(MappedFileError::OpenFailed); }
+    mFile = file;
+    mSize = (uint64_t)size.QuadPart;
+    mOpen = true;
+    return Map(false);
+}
+
+std::expected<void, MappedFileError> MappedFile::Create(const std::string& path, uint64_t size) {
+    Close();
+    HANDLE file = CreateFileW(WidePath(path).c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return std::unexpected(MappedFileError::OpenFailed);
+    LARGE_INTEGER end;
+    end.QuadPart = (LONGLONG)size;
+    if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+        CloseHandle(file);
+        return std::unexpected(MappedFileError::ResizeFailed);
+    }
+    mFile = file;
+    mSize = size;
+    mOpen = true;
+    return Map(true);
+}
+
+std::expected<void, MappedFileError> MappedFile::Map(bool writable) {
+    mWritable = writable;
+    if (mSize == 0) return {};   // CreateFileMapping rejects empty files
+    mMapping = CreateFileMappingW((HANDLE)mFile, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+    if (!mMapping) { Close(); return std::unexpected(MappedFileError::MapFailed); }
+    mData = (std::byte*)MapViewOfFile((HANDLE)mMapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+    if (!mData) { Close(); return std::unexpected(MappedFileError::MapFailed); }
+    return {};
+}
+
+std::expected<void, MappedFileError> MappedFile::Flush() {
+    if (!mWritable || !mData) return {};
+    if (!FlushViewOfFile(mData, 0) || !FlushFileBuffers((HANDLE)mFile)) {
+        return std::unexpected(MappedFileError::FlushFailed);
+    }
+    return {};
+}
+
+void MappedFile::Discard(uint64_t, uint64_t) {
+    // No cheap per-range hint for mapped views; the working-set manager trims them.
+}
+
+void MappedFile::Prefetch(uint64_t offset, uint64_t length) const {
+    if (!mData || offset >= mSize) return;
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = mData + offset;
+    range.NumberOfBytes = (SIZE_T)std::min(length, mSize - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::Close() {
+    if (mData) UnmapViewOfFile(mData);
+    if (mMapping) CloseHandle((HANDLE)mMapping);
+    if (mFile) CloseHandle((HANDLE)mFile);
+    mData = nullptr;
+    mMapping = nullptr;
+    mFile = nullptr;
+    mSize = 0;
+    mOpen = false;
+    mWritable = false;
+}
+
+#else
+
+std::expected<void, MappedFileError> MappedFile::OpenRead(const std::string& path) {
+    Close();
+    mFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (mFd < 0) return std::unexpected(MappedFileError::OpenFailed);
+    struct stat st;
+    if (::fstat(mFd, &st) != 0 || !S_ISREG(st.st_mode)) { Close(); return std::unexpected(MappedFileError::OpenFailed); }
+    mSize = (uint64_t)st.st_size;
+    mOpen = true;
+    return Map(false);
+}
+
+std::expected<void, MappedFileError> MappedFile::Create(const std::string& path, uint64_t size) {
+    Close();
+    mFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (mFd < 0) return std::unexpected(MappedFileError::OpenFailed);
+    if (::ftruncate(mFd, (off_t)size) != 0) { Close(); return std::unexpected(MappedFileError::ResizeFailed); }
+#if defined(__linux__)
+    // Reserve the blocks now: a full disk discovered later, on write-back of a mapped page,
+    // would arrive as SIGBUS instead of an error
+    if (size > 0) {
+        const int rc = ::posix_fallocate(mFd, 0, (off_t)size);
+        if (rc != 0 && rc != EOPNOTSUPP && rc != EINVAL) { Close(); return std::unexpected(MappedFileError::ResizeFailed); }
+    }
+#endif
+    mSize = size;
+    mOpen = true;
+    return Map(true);
+}
+
+std::expected<void, MappedFileError> MappedFile::Map(bool writable) {
+    mWritable = writable;
+    if (mSize == 0) return {};   // mmap rejects zero-length mappings
+    void* p = ::mmap(nullptr, (size_t)mSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, mFd, 0);
+    if (p == MAP_FAILED) { Close(); return std::unexpected(MappedFileError::MapFailed); }
+    mData = (std::byte*)p;
+    ::madvise(p, (size_t)mSize, MADV_SEQUENTIAL);
+    return {};
+}
+
+std::expected<void, MappedFileError> MappedFile::Flush() {
+    if (!mWritable || !mData) return {};
+    if (::msync(mData, (size_t)mSize, MS_SYNC) != 0) return std::unexpected(MappedFileError::FlushFailed);
+    return {};
+}
+
+void MappedFile::Discard(uint64_t offset, uint64_t length) {
+    if (!mData || offset >= mSize) return;
+    // madvise wants page-aligned ranges; shrink inward so neighbours stay mapped
+    const uint64_t page = (uint64_t)::sysconf(_SC_PAGESIZE);
+    const uint64_t begin = (offset + page - 1) / page * page;
+    const uint64_t end = std::min(offset + length, mSize) / page * page;
+    if (end <= begin) return;
+    if (mWritable) {
+        // Start write-back now so the range is clean by the time the kernel wants it back
+        ::msync(mData + begin, (size_t)(end - begin), MS_ASYNC);
+    } else {
+        ::madvise(mData + begin, (size_t)(end - begin), MADV_DONTNEED);
+    }
+}
+
+void MappedFile::Prefetch(uint64_t offset, uint64_t length) const {
+    if (!mData || offset >= mSize) return;
+    // Unlike Discard, grow outward: every page the range touches is wanted
+    const uint64_t page = (uint64_t)::sysconf(_SC_PAGESIZE);
+    const uint64_t begin = offset / page * page;
+    const uint64_t end = std::min(offset + length, mSize);
+    ::madvise(mData + begin, (size_t)(end - begin), MADV_WILLNEED);
+}
+
+void MappedFile::Close() {
+    if (mData) ::munmap(mData, (size_t)mSize);
+    if (mFd >= 0) ::close(mFd);
+    mData = nullptr;
+    mFd = -1;
+    mSize = 0;
+    mOpen = false;
+    mWritable = false;
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include "stdafx.h"
+#include <string>
+
+enum class MappedFileError { None, OpenFailed, ResizeFailed, MapFailed, FlushFailed };
+
+// A whole file mapped into memory (POSIX mmap, or a Windows file mapping). Inputs are mapped
+// read-only and handed out as spans, so data goes from the page cache straight into a cipher;
+// outputs are created at their final size and written through MutableData(). Pages are faulted
+// in and written back by the kernel, so files larger than RAM work as long as they fit the
+// address space. Empty files are valid and have an empty span.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps an existing file read-only, hinting sequential access.
+    std::expected<void, MappedFileError> OpenRead(const std::string& path);
+
+    // Creates (or truncates) a file of exactly `size` bytes and maps it writable.
+    std::expected<void, MappedFileError> Create(const std::string& path, uint64_t size);
+
+    // Writes dirty pages back to the file (outputs only); Close() does not wait for this.
+    std::expected<void, MappedFileError> Flush();
+
+    // Tells the kernel a consumed range will not be touched again, so it can drop those pages
+    // early instead of letting a huge sequential pass evict everything else.
+    void Discard(uint64_t offset, uint64_t length);
+
+    // Asks the kernel to start reading a range in now, ahead of a pass that will want it.
+    void Prefetch(uint64_t offset, uint64_t length) const;
+
+    void Close();
+
+    bool IsOpen() const { return mOpen; }
+    uint64_t Size() const { return mSize; }
+    std::span<const std::byte> Data() const { return { mData, (size_t)mSize }; }
+    std::span<std::byte> MutableData() { return { mWritable ? mData : nullptr, mWritable ? (size_t)mSize : 0 }; }
+
+private:
+    std::expected<void, MappedFileError> Map(bool writable);
+
+    std::byte* mData = nullptr;
+    uint64_t   mSize = 0;
+    bool       mOpen = false;
+    bool       mWritable = false;
+#if defined(_WIN32)
+    void*      mFile = nullptr;      // HANDLE
+    void*      mMapping = nullptr;   // HANDLE
+#else
+    int        mFd = -1;
+#endif
+};
+
+#endif
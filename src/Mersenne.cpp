@@ -1,4 +1,8 @@
 #include "Mersenne.hpp"
+#include "MersenneSIMD.hpp"
+#include "CpuFeatures.hpp"
+#include "MersenneJump.hpp"
+#include <cstring>
 
 // Constructor (seeds with default if none given)
 Mersenne::Mersenne(uint32_t seed) {
@@ -16,26 +20,122 @@ void Mersenne::Seed(uint32_t seed) {
 
 // Twist transformation
 void Mersenne::Twist() {
-    for (uint32_t i = 0; i < MERSENNE_N; ++i) {
-        uint32_t x = (mt[i] & MERSENNE_UPPER_MASK) | (mt[(i + 1) % MERSENNE_N] & MERSENNE_LOWER_MASK);
-        uint32_t xA = x >> 1;
-        if ((x & 1u) != 0) {
-            xA ^= MERSENNE_MATRIX_A;
-        }
-        mt[i] = mt[(i + MERSENNE_M) % MERSENNE_N] ^ xA;
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (cpu.avx512f) {
+        MersenneTwistAVX512(mt);
+    } else if (cpu.avx2) {
+        MersenneTwistAVX2(mt);
+    } else {
+        TwistScalar(mt);
     }
     index = 0;
 }
 
-// Generate next raw 32-bit number
-uint32_t Mersenne::Get() {
-    if (index >= MERSENNE_N) {
-        Twist();
+// Branch-free twist split at the two wrap points, so no index needs a modulo:
+// [0, N-M) pairs with mt[i+M], [N-M, N-1) with mt[i+M-N], and mt[N-1] with mt[0] / mt[M-1].
+void Mersenne::TwistScalar(uint32_t state[MERSENNE_N]) {
+    auto step = [](uint32_t cur, uint32_t next, uint32_t partner) {
+        const uint32_t x = (cur & MERSENNE_UPPER_MASK) | (next & MERSENNE_LOWER_MASK);
+        return partner ^ (x >> 1) ^ ((0u - (x & 1u)) & MERSENNE_MATRIX_A);
+    };
+    uint32_t i = 0;
+    for (; i < MERSENNE_N - MERSENNE_M; ++i) {
+        state[i] = step(state[i], state[i + 1], state[i + MERSENNE_M]);
     }
-    uint32_t y = mt[index++];
+    for (; i < MERSENNE_N - 1; ++i) {
+        state[i] = step(state[i], state[i + 1], state[i + MERSENNE_M - MERSENNE_N]);
+    }
+    state[MERSENNE_N - 1] = step(state[MERSENNE_N - 1], state[0], state[MERSENNE_M - 1]);
+}
+
+inline uint32_t Mersenne::Temper(uint32_t y) {
     y ^= (y >> 11);
     y ^= (y << 7)  & 0x9D2C5680u;
     y ^= (y << 15) & 0xEFC60000u;
     y ^= (y >> 18);
     return y;
 }
+
+// Generate next raw 32-bit number
+uint32_t Mersenne::Get() {
+    if (index >= MERSENNE_N) {
+        Twist();
+    }
+    return Temper(mt[index++]);
+}
+
+void Mersenne::Fill(std::span<uint32_t> out) {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    uint32_t* dst = out.data();
+    size_t remaining = out.size();
+
+    while (remaining > 0) {
+        if (index >= MERSENNE_N) {
+            Twist();
+        }
+        const size_t take = std::min<size_t>(remaining, MERSENNE_N - index);
+        const uint32_t* src = mt + index;
+
+        size_t done = 0;
+        if (cpu.avx512f) {
+            done = MersenneTemperAVX512(src, dst, take);
+        } else if (cpu.avx2) {
+            done = MersenneTemperAVX2(src, dst, take);
+        }
+        for (; done < take; ++done) dst[done] = Temper(src[done]);
+
+        index += (uint32_t)take;
+        dst += take;
+        remaining -= take;
+    }
+}
+
+// The linear state ahead of output x_n is S_n = (upper bit of x_{n-1}, x_n, ..., x_{n+622}):
+// exactly 19937 bits, and x_{n+623} = x_{n+396} ^ f(x_{n-1}, x_n). Jump(J) evaluates
+// g(T) S_n with g = x^J mod phi as sum_i g_i S_{n+i}, stepping a ring-buffer copy of S once
+// per coefficient, then loads the result back with index = 1.
+void Mersenne::Jump(uint32_t log2Steps) {
+    const MersennePolynomial& g = MersenneJumpPolynomial(log2Steps);
+
+    // Materialize S_n: the words of the next twist that S_n reaches into come from the recurrence
+    uint32_t extended[2 * MERSENNE_N];
+    std::memcpy(extended, mt, sizeof(mt));
+    const uint32_t start = index - 1;   // index is in [1, N] between calls
+    for (uint32_t k = 0; k < start; ++k) {
+        const uint32_t x = (extended[k] & MERSENNE_UPPER_MASK) | (extended[k + 1] & MERSENNE_LOWER_MASK);
+        extended[MERSENNE_N + k] = extended[k + MERSENNE_M] ^ (x >> 1) ^ ((0u - (x & 1u)) & MERSENNE_MATRIX_A);
+    }
+
+    uint32_t ring[MERSENNE_N], acc[MERSENNE_N] = {};
+    std::memcpy(ring, extended + start, sizeof(ring));
+    uint32_t head = 0;   // ring[head] holds x_{p-1} for the current S_p
+
+    for (size_t i = 0; i < MERSENNE_STATE_BITS; ++i) {
+        if ((g[i >> 6] >> (i & 63)) & 1u) {
+            const uint32_t tail = MERSENNE_N - head;
+            for (uint32_t j = 0; j < tail; ++j) acc[j] ^= ring[head + j];
+            for (uint32_t j = 0; j < head; ++j) acc[tail + j] ^= ring[j];
+        }
+        const uint32_t next = head + 1 == MERSENNE_N ? 0 : head + 1;
+        const uint32_t partner = head + MERSENNE_M < MERSENNE_N ? head + MERSENNE_M : head + MERSENNE_M - MERSENNE_N;
+        const uint32_t x = (ring[head] & MERSENNE_UPPER_MASK) | (ring[next] & MERSENNE_LOWER_MASK);
+        ring[head] = ring[partner] ^ (x >> 1) ^ ((0u - (x & 1u)) & MERSENNE_MATRIX_A);
+        head = next;
+    }
+
+    // acc = S_{n+J}: its first word only carries x_{n+J-1}'s upper bit, which is all the
+    // next twist reads from mt[0]
+    std::memcpy(mt, acc, sizeof(mt));
+    mt[0] &= MERSENNE_UPPER_MASK;
+    index = 1;
+}
+
+std::vector<Mersenne> Mersenne::Split(size_t count, uint32_t log2Spacing) const {
+    std::vector<Mersenne> streams;
+    streams.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        streams.push_back(i == 0 ? *this : streams.back());
+        if (i > 0) streams.back().Jump(log2Spacing);
+    }
+    return streams;
+}
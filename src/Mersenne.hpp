@@ -10,6 +10,8 @@
 #define MERSENNE_UPPER_MASK 0x80000000u
 #define MERSENNE_LOWER_MASK 0x7FFFFFFFu
 
+#define MERSENNE_SPLIT_LOG2 64   // Split() spaces streams 2^64 outputs apart
+
 class Mersenne {
 public:
     // Constructors
@@ -18,10 +20,24 @@ public:
 
     // Core generation
     uint32_t Get();
-    
+
+    // Bulk generation: the same sequence as out.size() calls to Get(), tempered 8-16 words at
+    // a time straight out of the state.
+    void Fill(std::span<uint32_t> out);
+
+    // Jump-ahead: the same state as 2^log2Steps calls to Get(), by polynomial arithmetic over
+    // GF(2) (a few ms per jump; the first jump of each size also builds its polynomial).
+    void Jump(uint32_t log2Steps);
+
+    // `count` generators whose streams start 2^log2Spacing outputs apart; the first one
+    // continues this generator's stream. Hand one to each worker for lock-free,
+    // non-overlapping sampling.
+    std::vector<Mersenne> Split(size_t count, uint32_t log2Spacing = MERSENNE_SPLIT_LOG2) const;
 
 private:
-    void Twist(); // state transition
+    void Twist(); // state transition, dispatched to the widest kernel the CPU has
+    static void TwistScalar(uint32_t state[MERSENNE_N]);
+    static inline uint32_t Temper(uint32_t y);
 
     uint32_t mt[MERSENNE_N];
     uint32_t index;
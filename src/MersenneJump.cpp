@@ -0,0 +1,136 @@
+#include "MersenneJump.hpp"
+#include "Mersenne.hpp"
+#include <bit>
+#include <map>
+#include <mutex>
+
+#define MERSENNE_POLY_WORDS ((MERSENNE_STATE_BITS + 64) / 64)   // 312: degree 19937 fits
+#define MERSENNE_BM_LENGTH  (2 * MERSENNE_STATE_BITS)           // Berlekamp-Massey needs 2 * degree
+
+static inline bool TestBit(const uint64_t* p, size_t bit) { return (p[bit >> 6] >> (bit & 63)) & 1u; }
+static inline void FlipBit(uint64_t* p, size_t bit) { p[bit >> 6] ^= 1ull << (bit & 63); }
+
+// dst ^= src << shift, over dst's first dstWords words
+static void XorShifted(uint64_t* dst, size_t dstWords, const uint64_t* src, size_t srcWords, size_t shift) {
+    const size_t wordShift = shift >> 6, bitShift = shift & 63;
+    for (size_t i = 0; i < srcWords && i + wordShift < dstWords; ++i) {
+        dst[i + wordShift] ^= src[i] << bitShift;
+        if (bitShift && i + wordShift + 1 < dstWords) dst[i + wordShift + 1] ^= src[i] >> (64 - bitShift);
+    }
+}
+
+// Berlekamp-Massey over GF(2) on bit 0 of the outputs of a seeded generator. Every output bit
+// is a linear functional of the state, so the shortest recurrence is the transition's minimal
+// polynomial, which for MT19937 is the full degree-19937 characteristic polynomial.
+static MersennePolynomial ComputeCharacteristic() {
+    const size_t n = MERSENNE_BM_LENGTH;
+    const size_t words = n / 64 + 2;
+
+    // Stored reversed (r[j] = s[n-1-j]) so the discrepancy sum sum_i c_i s[k-i] becomes an
+    // AND of C against a contiguous window of r starting at bit n-1-k.
+    std::vector<uint64_t> reversed(words + 1, 0);
+    Mersenne source(5489u);
+    for (size_t k = 0; k < n; ++k) {
+        if (source.Get() & 1u) FlipBit(reversed.data(), n - 1 - k);
+    }
+
+    std::vector<uint64_t> c(words, 0), b(words, 0), t(words);
+    c[0] = b[0] = 1;
+    size_t length = 0, last = 0;
+    bool haveLast = false;   // m = -1 in the textbook version
+
+    for (size_t k = 0; k < n; ++k) {
+        const size_t offset = n - 1 - k;
+        const size_t base = offset >> 6, shift = offset & 63;
+        uint64_t acc = 0;
+        for (size_t w = 0; w <= (length >> 6); ++w) {
+            uint64_t window = reversed[base + w] >> shift;
+            if (shift) window |= reversed[base + w + 1] << (64 - shift);
+            acc ^= c[w] & window;
+        }
+        if (!(std::popcount(acc) & 1)) continue;
+
+        const size_t distance = haveLast ? k - last : k + 1;
+        if (2 * length <= k) {
+            t = c;
+            XorShifted(c.data(), words, b.data(), words, distance);
+            length = k + 1 - length;
+            b.swap(t);
+            last = k;
+            haveLast = true;
+        } else {
+            XorShifted(c.data(), words, b.data(), words, distance);
+        }
+    }
+
+    // C(x) = 1 + c_1 x + ... + c_L x^L is the connection polynomial; the characteristic
+    // polynomial is its reciprocal x^L C(1/x).
+    MersennePolynomial phi(MERSENNE_POLY_WORDS, 0);
+    for (size_t i = 0; i <= length && i <= MERSENNE_STATE_BITS; ++i) {
+        if (TestBit(c.data(), i)) FlipBit(phi.data(), length - i);
+    }
+    return phi;
+}
+
+const MersennePolynomial& MersenneCharacteristicPolynomial() {
+    static const MersennePolynomial phi = ComputeCharacteristic();
+    return phi;
+}
+
+// Reduces a (2 * MERSENNE_POLY_WORDS)-word product modulo phi in place. phiShifted[r] holds
+// phi << r for r in [0, 64), so each leading term costs one aligned pass of word XORs.
+static void Reduce(uint64_t* p, const std::vector<MersennePolynomial>& phiShifted) {
+    for (size_t bit = 2 * (MERSENNE_STATE_BITS - 1); bit >= MERSENNE_STATE_BITS; --bit) {
+        if (!TestBit(p, bit)) continue;
+        const size_t shift = bit - MERSENNE_STATE_BITS;
+        const uint64_t* src = phiShifted[shift & 63].data();
+        uint64_t* dst = p + (shift >> 6);
+        for (size_t w = 0; w <= MERSENNE_POLY_WORDS; ++w) dst[w] ^= src[w];
+    }
+}
+
+// Carry-less square: bit i moves to bit 2i
+static inline uint64_t Spread32(uint32_t v) {
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8))  & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4))  & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2))  & 0x3333333333333333ull;
+    x = (x | (x << 1))  & 0x5555555555555555ull;
+    return x;
+}
+
+static MersennePolynomial ComputeJump(uint32_t log2Steps) {
+    const MersennePolynomial& phi = MersenneCharacteristicPolynomial();
+
+    std::vector<MersennePolynomial> phiShifted(64, MersennePolynomial(MERSENNE_POLY_WORDS + 1, 0));
+    for (size_t r = 0; r < 64; ++r) {
+        XorShifted(phiShifted[r].data(), MERSENNE_POLY_WORDS + 1, phi.data(), MERSENNE_POLY_WORDS, r);
+    }
+
+    // Padded so Reduce() can XOR a full phi-width pass at the highest offset
+    std::vector<uint64_t> square(3 * MERSENNE_POLY_WORDS, 0);
+    MersennePolynomial g(MERSENNE_POLY_WORDS, 0);
+    g[0] = 2;   // x
+    for (uint32_t i = 0; i < log2Steps % MERSENNE_STATE_BITS; ++i) {
+        for (size_t w = 0; w < MERSENNE_POLY_WORDS; ++w) {
+            square[2 * w]     = Spread32((uint32_t)g[w]);
+            square[2 * w + 1] = Spread32((uint32_t)(g[w] >> 32));
+        }
+        Reduce(square.data(), phiShifted);
+        std::copy(square.begin(), square.begin() + MERSENNE_POLY_WORDS, g.begin());
+        std::fill(square.begin(), square.end(), 0);
+    }
+    return g;
+}
+
+const MersennePolynomial& MersenneJumpPolynomial(uint32_t log2Steps) {
+    static std::mutex lock;
+    static std::map<uint32_t, MersennePolynomial> cache;
+
+    log2Steps %= MERSENNE_STATE_BITS;
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = cache.find(log2Steps);
+    if (it == cache.end()) it = cache.emplace(log2Steps, ComputeJump(log2Steps)).first;
+    return it->second;
+}
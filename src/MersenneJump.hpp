@@ -0,0 +1,21 @@
+#ifndef MERSENNEJUMP_HPP
+#define MERSENNEJUMP_HPP
+
+#include "stdafx.h"
+
+// GF(2)[x] arithmetic behind Mersenne::Jump(). A polynomial is a bit vector: bit i of word
+// i / 64 is the coefficient of x^i.
+using MersennePolynomial = std::vector<uint64_t>;
+
+// Dimension of the MT19937 state: 623 full words plus the top bit of one more.
+#define MERSENNE_STATE_BITS 19937
+
+// Characteristic polynomial (degree 19937) of the transition that produces one output. It is
+// recovered once from the output stream by Berlekamp-Massey and then shared.
+const MersennePolynomial& MersenneCharacteristicPolynomial();
+
+// x^(2^log2Steps) mod the characteristic polynomial, by repeated squaring. Cached per
+// log2Steps; the polynomial is primitive, so log2Steps only matters modulo 19937.
+const MersennePolynomial& MersenneJumpPolynomial(uint32_t log2Steps);
+
+#endif
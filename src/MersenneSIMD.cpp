@@ -0,0 +1,128 @@
+#include "MersenneSIMD.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MERSENNE_TARGET_AVX2
+#define MERSENNE_TARGET_AVX512
+#else
+#define MERSENNE_TARGET_AVX2   __attribute__((target("avx2")))
+#define MERSENNE_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// The twist is split the same way as the scalar one: [0, N-M) reads mt[i+M] (still old),
+// [N-M, N-1) reads mt[i+M-N] (already new, but 227 words behind, so a whole vector never
+// depends on itself), and i = N-1 wraps to mt[0]. Each vector loads mt[i..], mt[i+1..] and the
+// partner before it stores mt[i..], so the unaligned overlap of mt[i+1..] only sees old words.
+
+// ==================== AVX2: 8 words ====================
+MERSENNE_TARGET_AVX2 static inline __m256i TwistStep256(__m256i cur, __m256i next, __m256i partner) {
+    const __m256i upper = _mm256_set1_epi32((int)MERSENNE_UPPER_MASK);
+    const __m256i matrix = _mm256_set1_epi32((int)MERSENNE_MATRIX_A);
+    const __m256i x = _mm256_or_si256(_mm256_and_si256(cur, upper), _mm256_andnot_si256(upper, next));
+    // -(x & 1) & MATRIX_A without a branch: shift the low bit up to the sign and back down
+    const __m256i mag = _mm256_and_si256(_mm256_srai_epi32(_mm256_slli_epi32(x, 31), 31), matrix);
+    return _mm256_xor_si256(partner, _mm256_xor_si256(_mm256_srli_epi32(x, 1), mag));
+}
+
+static inline uint32_t TwistWord(uint32_t cur, uint32_t next, uint32_t partner) {
+    const uint32_t x = (cur & MERSENNE_UPPER_MASK) | (next & MERSENNE_LOWER_MASK);
+    return partner ^ (x >> 1) ^ ((0u - (x & 1u)) & MERSENNE_MATRIX_A);
+}
+
+MERSENNE_TARGET_AVX2 void MersenneTwistAVX2(uint32_t mt[MERSENNE_N]) {
+    const uint32_t split = MERSENNE_N - MERSENNE_M;   // 227
+    uint32_t i = 0;
+    for (; i + 8 <= split; i += 8) {
+        const __m256i cur = _mm256_loadu_si256((const __m256i*)(mt + i));
+        const __m256i next = _mm256_loadu_si256((const __m256i*)(mt + i + 1));
+        const __m256i partner = _mm256_loadu_si256((const __m256i*)(mt + i + MERSENNE_M));
+        _mm256_storeu_si256((__m256i*)(mt + i), TwistStep256(cur, next, partner));
+    }
+    for (; i < split; ++i) mt[i] = TwistWord(mt[i], mt[i + 1], mt[i + MERSENNE_M]);
+
+    for (; i + 8 <= MERSENNE_N - 1; i += 8) {
+        const __m256i cur = _mm256_loadu_si256((const __m256i*)(mt + i));
+        const __m256i next = _mm256_loadu_si256((const __m256i*)(mt + i + 1));
+        const __m256i partner = _mm256_loadu_si256((const __m256i*)(mt + i - split));
+        _mm256_storeu_si256((__m256i*)(mt + i), TwistStep256(cur, next, partner));
+    }
+    for (; i < MERSENNE_N - 1; ++i) mt[i] = TwistWord(mt[i], mt[i + 1], mt[i - split]);
+
+    mt[MERSENNE_N - 1] = TwistWord(mt[MERSENNE_N - 1], mt[0], mt[MERSENNE_M - 1]);
+    _mm256_zeroupper();
+}
+
+MERSENNE_TARGET_AVX2 size_t MersenneTemperAVX2(const uint32_t* in, uint32_t* out, size_t count) {
+    const __m256i maskB = _mm256_set1_epi32((int)0x9D2C5680u);
+    const __m256i maskC = _mm256_set1_epi32((int)0xEFC60000u);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i y = _mm256_loadu_si256((const __m256i*)(in + i));
+        y = _mm256_xor_si256(y, _mm256_srli_epi32(y, 11));
+        y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi32(y, 7), maskB));
+        y = _mm256_xor_si256(y, _mm256_and_si256(_mm256_slli_epi32(y, 15), maskC));
+        y = _mm256_xor_si256(y, _mm256_srli_epi32(y, 18));
+        _mm256_storeu_si256((__m256i*)(out + i), y);
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+// ==================== AVX-512: 16 words ====================
+MERSENNE_TARGET_AVX512 static inline __m512i TwistStep512(__m512i cur, __m512i next, __m512i partner) {
+    const __m512i upper = _mm512_set1_epi32((int)MERSENNE_UPPER_MASK);
+    const __m512i matrix = _mm512_set1_epi32((int)MERSENNE_MATRIX_A);
+    const __m512i x = _mm512_or_si512(_mm512_and_si512(cur, upper), _mm512_andnot_si512(upper, next));
+    const __m512i mag = _mm512_and_si512(_mm512_srai_epi32(_mm512_slli_epi32(x, 31), 31), matrix);
+    return _mm512_xor_si512(partner, _mm512_xor_si512(_mm512_srli_epi32(x, 1), mag));
+}
+
+MERSENNE_TARGET_AVX512 void MersenneTwistAVX512(uint32_t mt[MERSENNE_N]) {
+    const uint32_t split = MERSENNE_N - MERSENNE_M;
+    uint32_t i = 0;
+    for (; i + 16 <= split; i += 16) {
+        const __m512i cur = _mm512_loadu_si512(mt + i);
+        const __m512i next = _mm512_loadu_si512(mt + i + 1);
+        const __m512i partner = _mm512_loadu_si512(mt + i + MERSENNE_M);
+        _mm512_storeu_si512(mt + i, TwistStep512(cur, next, partner));
+    }
+    for (; i < split; ++i) mt[i] = TwistWord(mt[i], mt[i + 1], mt[i + MERSENNE_M]);
+
+    for (; i + 16 <= MERSENNE_N - 1; i += 16) {
+        const __m512i cur = _mm512_loadu_si512(mt + i);
+        const __m512i next = _mm512_loadu_si512(mt + i + 1);
+        const __m512i partner = _mm512_loadu_si512(mt + i - split);
+        _mm512_storeu_si512(mt + i, TwistStep512(cur, next, partner));
+    }
+    for (; i < MERSENNE_N - 1; ++i) mt[i] = TwistWord(mt[i], mt[i + 1], mt[i - split]);
+
+    mt[MERSENNE_N - 1] = TwistWord(mt[MERSENNE_N - 1], mt[0], mt[MERSENNE_M - 1]);
+    _mm256_zeroupper();
+}
+
+MERSENNE_TARGET_AVX512 size_t MersenneTemperAVX512(const uint32_t* in, uint32_t* out, size_t count) {
+    const __m512i maskB = _mm512_set1_epi32((int)0x9D2C5680u);
+    const __m512i maskC = _mm512_set1_epi32((int)0xEFC60000u);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i y = _mm512_loadu_si512(in + i);
+        y = _mm512_xor_si512(y, _mm512_srli_epi32(y, 11));
+        y = _mm512_xor_si512(y, _mm512_and_si512(_mm512_slli_epi32(y, 7), maskB));
+        y = _mm512_xor_si512(y, _mm512_and_si512(_mm512_slli_epi32(y, 15), maskC));
+        y = _mm512_xor_si512(y, _mm512_srli_epi32(y, 18));
+        _mm512_storeu_si512(out + i, y);
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+#else
+
+void MersenneTwistAVX2(uint32_t*) {}
+void MersenneTwistAVX512(uint32_t*) {}
+size_t MersenneTemperAVX2(const uint32_t*, uint32_t*, size_t) { return 0; }
+size_t MersenneTemperAVX512(const uint32_t*, uint32_t*, size_t) { return 0; }
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef MERSENNESIMD_HPP
+#define MERSENNESIMD_HPP
+
+#include "stdafx.h"
+#include "Mersenne.hpp"
+
+// Vector kernels behind Mersenne's Twist() and Fill(). They produce exactly the reference
+// MT19937 sequence. Callers check GetCpuFeatures() first.
+
+// Full in-place twist of the 624-word state.
+void MersenneTwistAVX2(uint32_t mt[MERSENNE_N]);
+void MersenneTwistAVX512(uint32_t mt[MERSENNE_N]);
+
+// out[i] = temper(in[i]) for as many whole vectors (8 / 16 words) as fit in `count`; returns
+// how many words that was, and the caller tempers the remainder.
+size_t MersenneTemperAVX2(const uint32_t* in, uint32_t* out, size_t count);
+size_t MersenneTemperAVX512(const uint32_t* in, uint32_t* out, size_t count);
+
+#endif
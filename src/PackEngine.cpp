@@ -0,0 +1,984 @@
+#include "PackEngine.hpp"
+#include "BoundedQueue.hpp"
+#include "BufferPool.hpp"
+#include "DirectoryWalker.hpp"
+#include "FastCdc.hpp"
+#include "IoBackend.hpp"
+#include "Lz77.hpp"
+#include "MappedFile.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+double PackProgress::EtaSeconds() const {
+    const double rate = BytesPerSecond();
+    if (rate <= 0.0 || bytesDone == 0) return -1.0;
+    return (double)(bytesTotal - std::min(bytesDone, bytesTotal)) / rate;
+}
+
+PackEngine::PackEngine() : mPool(&ThreadPool::Shared()), mCancel(false) {}
+
+void PackEngine::Begin(uint64_t bytesTotal) {
+    mState = PackProgress();
+    mState.bytesTotal = bytesTotal;
+    mStart = std::chrono::steady_clock::now();
+    if (mProgress) mProgress(mState);
+}
+
+void PackEngine::Advance(uint64_t bytes) {
+    mState.bytesDone += bytes;
+    mState.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count();
+    if (mProgress) mProgress(mState);
+}
+
+struct PackEngine::Source {
+    fs::path    path;
+    std::string entryPath;
+    uint64_t    size;
+};
+
+std::expected<std::string, PackError>
+PackEngine::Pack(const std::string& input, const std::string& outputDirectory) {
+    std::error_code ec;
+    const fs::path root(input);
+    if (!fs::exists(root, ec)) return std::unexpected(PackError::InputMissing);
+
+    std::vector<Source> sources;
+    const std::string rootName = root.filename().string();
+    if (fs::is_regular_file(root, ec)) {
+        sources.push_back({ root, rootName, (uint64_t)fs::file_size(root, ec) });
+    } else if (fs::is_directory(root, ec)) {
+        auto walked = DirectoryWalker(*mPool).Walk(root, &mCancel);
+        if (!walked) {
+            if (walked.error() == std::errc::operation_canceled) return std::unexpected(PackError::Cancelled);
+            return std::unexpected(PackError::ReadFailed);
+        }
+        sources.reserve(walked->size());
+        for (WalkedFile& f : *walked) {
+            sources.push_back({ std::move(f.path), rootName + "/" + f.relativePath, f.size });
+        }
+    } else {
+        return std::unexpected(PackError::UnsupportedInput);
+    }
+
+    uint64_t total = 0;
+    for (const Source& s : sources) total += s.size;
+
+    const fs::path target = fs::path(outputDirectory) / (rootName + PACK_EXTENSION);
+    PackWriter writer;
+    auto opened = writer.OpenMapped(target.string(), mOptions, total);
+    if (!opened) return std::unexpected(opened.error());
+    for (const Source& s : sources) {
+        auto added = writer.AddFile(s.entryPath, s.size);
+        if (!added) { writer.Abandon(); return std::unexpected(added.error()); }
+    }
+    auto begun = writer.BeginParallel();
+    if (!begun) { writer.Abandon(); return std::unexpected(begun.error()); }
+
+    Begin(total);
+    auto sealed = SealAll(writer, sources);
+    if (!sealed) { writer.Abandon(); return std::unexpected(sealed.error()); }
+
+    auto finished = writer.Finish();
+    if (!finished) return std::unexpected(finished.error());
+    return target.string();
+}
+
+namespace {
+
+// A run of file bytes that lies inside one chunk (deduplicating jobs: exactly one piece).
+struct PackSegment {
+    uint32_t source;
+    uint64_t sourceOffset;
+    uint64_t payloadOffset;
+    uint32_t length;
+};
+
+// One scheduled step: whole chunks, in payload order, with the segments that fill them.
+struct PackWorkUnit {
+    uint64_t                 bytes = 0;
+    uint64_t                 sequence = 0;   // deduplicating jobs: commit order
+    std::vector<PackSegment> segments;
+};
+
+// Per-thread input state: consecutive chunks of one large file reuse its mapping, and each
+// worker drives its own I/O backend (an io_uring is single-threaded) over the engine's
+// buffer arena.
+struct PackWorker {
+    uint32_t                                  mappedSource = UINT32_MAX;
+    MappedFile                                mapped;
+    std::unique_ptr<IoBackend>                io;
+    std::vector<std::pair<uint32_t, IoFile>>  files;   // sources open for the chunk being read
+    std::vector<IoRequest>                    reads;
+    std::vector<std::span<const std::byte>>   pieces;
+    std::unique_ptr<Lz77Compressor>           lz;      // compressed jobs, made on first use
+};
+
+// A compressed chunk sealed ahead of its turn, parked until every earlier one is committed.
+struct PackSealedChunk {
+    PooledBuffer buffer;
+    PackChunk    chunk;
+    bool         ready = false;
+};
+
+// A deduplicating unit, likewise parked: each piece's fingerprint and, for the pieces it fell
+// to this unit to store, the sealed chunk (back to back in `buffer`).
+struct PackSealedPiece {
+    Sha256Digest digest;
+    uint32_t     rawSize = 0;
+    bool         sealed = false;
+    PackChunk    chunk;
+    size_t       at = 0;   // in the unit's buffer
+};
+struct PackSealedUnit {
+    PooledBuffer                 buffer;
+    std::vector<PackSealedPiece> pieces;
+    bool                         ready = false;
+};
+
+// Which piece gets to seal each fingerprint, decided while units are sealed out of order. The
+// lowest payload offset claimed so far wins, so the first occurrence - the one that will be
+// committed as the chunk - is always sealed, whatever order the units come in; a later one
+// that got there first seals for nothing, and is dropped at commit.
+class PackClaims {
+public:
+    bool Claim(const Sha256Digest& digest, uint64_t payloadOffset) {
+        Shard& shard = mShards[digest[SHA256_DIGEST_SIZE - 1] % PACK_ENGINE_CLAIM_SHARDS];
+        std::lock_guard<std::mutex> guard(shard.lock);
+        const auto [it, inserted] = shard.first.try_emplace(digest, payloadOffset);
+        if (inserted) return true;
+        if (payloadOffset > it->second) return false;
+        it->second = payloadOffset;
+        return true;
+    }
+
+private:
+    struct Shard {
+        std::mutex                                                    lock;
+        std::unordered_map<Sha256Digest, uint64_t, Sha256DigestHash> first;
+    };
+    Shard mShards[PACK_ENGINE_CLAIM_SHARDS];
+};
+
+// State shared between the scheduling thread and the pool tasks that drain its queue. Tasks
+// never block: each takes units until the queue is empty and leaves, and the producer starts
+// another whenever fewer than one per pool thread are around. Tasks hold this by shared_ptr,
+// so one that only gets to run after the job is over finds the queue drained and leaves
+// without touching anything else.
+struct PackSchedule {
+    PackSchedule(size_t capacity, size_t window, bool dedup)
+        : queue(capacity), parked(dedup ? 0 : window), parkedUnits(dedup ? window : 0) {}
+
+    BoundedQueue<PackWorkUnit> queue;
+    std::mutex                 lock;
+    std::condition_variable    changed;
+    std::deque<uint64_t>       finished;      // bytes of each completed unit, not yet reported
+    size_t                     pending = 0;   // tasks submitted, not yet started
+    size_t                     active = 0;    // tasks running
+    std::vector<std::unique_ptr<PackWorker>> idle;   // worker state kept between tasks
+    PackError                  error = PackError::None;
+    std::atomic<bool>          failed = false;
+    std::vector<std::vector<PackSegment>> spare;   // emptied segment lists, for the next units
+    std::function<std::expected<void, PackError>(PackWorkUnit&, PackWorker&)> run;
+
+    // Compressed jobs: chunk i waits in parked[i % window] until chunks up to i - 1 are
+    // committed. The producer never schedules a chunk a window or more ahead of `committed`,
+    // so slots are never contended and the parked buffers stay within the pool's capacity.
+    // Deduplicating jobs do the same a unit at a time, in parkedUnits, counting units.
+    std::mutex                   commitLock;
+    std::vector<PackSealedChunk> parked;
+    std::vector<PackSealedUnit>  parkedUnits;
+    std::atomic<uint64_t>        committed = 0;
+    PackClaims                   claims;
+
+    // Segment lists cycle producer -> worker -> producer, so steady state allocates nothing
+    void Recycle(std::vector<PackSegment>&& segments) {
+        segments.clear();
+        std::lock_guard<std::mutex> guard(lock);
+        spare.push_back(std::move(segments));
+    }
+    std::vector<PackSegment> Fresh() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (spare.empty()) return std::vector<PackSegment>();
+        std::vector<PackSegment> segments = std::move(spare.back());
+        spare.pop_back();
+        return segments;
+    }
+
+    void Complete(uint64_t bytes, std::expected<void, PackError> result) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (result) {
+            finished.push_back(bytes);
+        } else if (error == PackError::None) {
+            error = result.error();
+            failed.store(true, std::memory_order_relaxed);
+        }
+        changed.notify_all();
+    }
+};
+
+// One selected entry's bytes within one chunk.
+struct PackSlice {
+    uint32_t chunk;
+    uint32_t target;        // into the job's outputs
+    uint64_t fileOffset;    // in the output
+    uint32_t chunkOffset;
+    uint32_t length;
+};
+
+} // namespace
+
+// Seals every chunk of the writer's layout. The calling thread cuts the payload into units of
+// whole chunks - many small files batched into one, a large file split across several, or,
+// deduplicating, content-defined pieces - and reports progress; pool workers take the units
+// off a bounded queue and seal them straight into their final place in the mapped output.
+// The layout is fixed before any work starts, so the archive does not depend on timing. When
+// the queue is full the caller runs a unit itself rather than wait, so the job completes even
+// if no pool thread is free to help. Compressed chunks and deduplicating units are committed
+// in order behind a bounded reorder window. Input that is not sealed straight from a mapping
+// goes through the worker's IoBackend, one batch per chunk, in buffers from the engine's
+// BufferPool, so memory stays flat however large the job.
+std::expected<void, PackError>
+PackEngine::SealAll(PackWriter& writer, const std::vector<Source>& sources) {
+    const uint32_t chunkSize = mOptions.chunkSize;
+    const uint64_t unitBytes = (uint64_t)std::max<uint32_t>(1, PACK_ENGINE_CHUNK / chunkSize) * chunkSize;
+    const size_t workers = mPool->ThreadCount();
+    const size_t queueCapacity = std::max<size_t>(1, workers) * PACK_ENGINE_QUEUE_PER_THREAD;
+    // Compressed jobs hold a sealed chunk from sealing until its turn to commit: room for
+    // everything queued or in progress, on top of one staging buffer per sealing thread.
+    // Deduplicating jobs do the same with whole units, and their buffers are unit-sized.
+    const bool compress = writer.Compressing();
+    const bool dedup = writer.Deduplicating();
+    const size_t window = dedup ? queueCapacity + workers + 1
+                        : compress ? (queueCapacity + workers + 1) * (size_t)(unitBytes / chunkSize) : 0;
+    auto schedule = std::make_shared<PackSchedule>(queueCapacity, window, dedup);
+    BufferPool& buffers = Buffers(dedup ? (uint32_t)unitBytes : chunkSize, workers + 1 + window);
+    const std::span<std::byte> arena = buffers.Arena();
+
+    // Compresses and encrypts a chunk into a pooled buffer, parks it, then commits whatever
+    // run of chunks is now complete in order - so whichever thread fills the gap writes out
+    // everything queued behind it
+    auto compressChunk = [&](PackWorker& worker, uint32_t chunk,
+                             std::span<const std::byte> raw) -> std::expected<void, PackError> {
+        if (!worker.lz) worker.lz = std::make_unique<Lz77Compressor>();
+        PooledBuffer out = buffers.Acquire();
+        auto sealed = writer.CompressChunk(chunk, raw, out.Span(), *worker.lz);
+        if (!sealed) return std::unexpected(sealed.error());
+
+        std::lock_guard<std::mutex> guard(schedule->commitLock);
+        PackSealedChunk& slot = schedule->parked[chunk % window];
+        slot.buffer = std::move(out);
+        slot.chunk = *sealed;
+        slot.ready = true;
+        for (uint64_t next = schedule->committed.load(std::memory_order_relaxed);; ++next) {
+            PackSealedChunk& head = schedule->parked[next % window];
+            if (!head.ready) break;
+            auto committed = writer.CommitChunk((uint32_t)next, head.chunk, head.buffer.Span().first(head.chunk.storedSize));
+            if (!committed) return committed;
+            head.buffer.Release();
+            head.ready = false;
+            schedule->committed.store(next + 1, std::memory_order_release);
+        }
+        return {};
+    };
+
+    // Gathers a chunk's segments into pieces and seals it. A chunk cut from a single file is
+    // sealed straight out of that file's mapping. Batched small files (and inputs that cannot
+    // be mapped) are read into a pooled chunk buffer as one I/O batch, which keeps every read
+    // of the chunk in flight at once and beats a map and unmap per file.
+    auto sealChunk = [&](PackWorker& worker, const PackSegment* first, const PackSegment* last,
+                         uint32_t chunk) -> std::expected<void, PackError> {
+        const uint64_t chunkStart = (uint64_t)chunk * chunkSize;
+        worker.pieces.clear();
+        if (last - first == 1) {
+            const Source& source = sources[first->source];
+            if (worker.mappedSource != first->source) {
+                worker.mapped.Close();
+                worker.mappedSource = UINT32_MAX;
+                if (worker.mapped.OpenRead(source.path.string())) {
+                    if (worker.mapped.Size() != source.size) return std::unexpected(PackError::InputChanged);
+                    worker.mappedSource = first->source;
+                }
+            }
+            if (worker.mappedSource == first->source) {
+                worker.pieces.push_back(worker.mapped.Data().subspan(first->sourceOffset, first->length));
+                auto sealed = compress ? compressChunk(worker, chunk, worker.pieces.front())
+                                       : writer.SealChunk(chunk, worker.pieces);
+                if (!sealed) return sealed;
+                worker.mapped.Discard(first->sourceOffset, first->length);
+                return {};
+            }
+        }
+
+        if (!worker.io) worker.io = IoBackend::Create(mIoKind, *mPool, std::span<const std::span<std::byte>>(&arena, 1));
+        const PooledBuffer staging = buffers.Acquire();
+        // Keep open only a file this chunk carries on with; reserve so the IoFile addresses
+        // in the requests stay put while the rest are opened
+        std::erase_if(worker.files, [&](const auto& open) { return open.first != first->source; });
+        worker.files.reserve((size_t)(last - first) + 1);
+        worker.reads.clear();
+        for (const PackSegment* s = first; s != last; ++s) {
+            if (worker.files.empty() || worker.files.back().first != s->source) {
+                IoFile file;
+                if (!file.OpenRead(sources[s->source].path.string())) return std::unexpected(PackError::OpenFailed);
+                worker.files.emplace_back(s->source, std::move(file));
+            }
+            std::byte* at = staging.Data() + (s->payloadOffset - chunkStart);
+            worker.reads.push_back({ &worker.files.back().second, s->sourceOffset, at, s->length, 0 });
+            worker.pieces.push_back(std::span<const std::byte>(at, s->length));
+        }
+        auto read = worker.io->Read(worker.reads);
+        if (!read) return std::unexpected(read.error() == IoError::ShortRead ? PackError::InputChanged : PackError::ReadFailed);
+        if (compress) {
+            const uint64_t rawSize = last[-1].payloadOffset + last[-1].length - chunkStart;
+            return compressChunk(worker, chunk, staging.Span().first((size_t)rawSize));
+        }
+        return writer.SealChunk(chunk, worker.pieces);
+    };
+
+    // Deduplicating jobs take a unit at a time: every piece is fingerprinted, the ones this
+    // unit is first to claim are compressed and encrypted into one pooled buffer, and the unit
+    // is parked and committed in order like a compressed chunk. Pieces of large files come
+    // straight out of their mapping; whole small files are read into a staging buffer first,
+    // each at its place in the unit, in batches that bound the files open at once.
+    auto sealUnit = [&](PackWorker& worker, const PackWorkUnit& unit) -> std::expected<void, PackError> {
+        const std::vector<PackSegment>& pieces = unit.segments;
+        const uint64_t unitStart = pieces.front().payloadOffset;
+        PooledBuffer staging;
+        worker.files.clear();
+        worker.files.reserve(PACK_ENGINE_OPEN_FILES);
+        worker.reads.clear();
+        worker.pieces.assign(pieces.size(), std::span<const std::byte>());
+        auto stage = [&](const PackSegment& p, IoFile file) {
+            if (!staging) staging = buffers.Acquire();
+            if (!worker.io) worker.io = IoBackend::Create(mIoKind, *mPool, std::span<const std::span<std::byte>>(&arena, 1));
+            worker.files.emplace_back(p.source, std::move(file));
+            std::byte* at = staging.Data() + (p.payloadOffset - unitStart);
+            worker.reads.push_back({ &worker.files.back().second, p.sourceOffset, at, p.length, 0 });
+            return std::span<const std::byte>(at, p.length);
+        };
+        auto readStaged = [&]() -> std::expected<void, PackError> {
+            if (worker.reads.empty()) return {};
+            auto read = worker.io->Read(worker.reads);
+            worker.reads.clear();
+            worker.files.clear();
+            if (!read) return std::unexpected(read.error() == IoError::ShortRead ? PackError::InputChanged : PackError::ReadFailed);
+            return {};
+        };
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            if (sources[pieces[i].source].size > chunkSize) continue;
+            if (worker.files.size() == PACK_ENGINE_OPEN_FILES) {
+                auto read = readStaged();
+                if (!read) return read;
+            }
+            IoFile file;
+            if (!file.OpenRead(sources[pieces[i].source].path.string())) return std::unexpected(PackError::OpenFailed);
+            worker.pieces[i] = stage(pieces[i], std::move(file));
+        }
+        auto read = readStaged();
+        if (!read) return read;
+
+        if (compress && !worker.lz) worker.lz = std::make_unique<Lz77Compressor>();
+        PooledBuffer out = buffers.Acquire();
+        // The slot is this unit's alone until it is marked ready: the unit a window back that
+        // had it was committed before this one was admitted
+        PackSealedUnit& slot = schedule->parkedUnits[unit.sequence % window];
+        slot.pieces.resize(pieces.size());
+        size_t fill = 0;
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            const PackSegment& p = pieces[i];
+            std::span<const std::byte> raw = worker.pieces[i];
+            bool mapped = false;
+            if (raw.empty()) {
+                const Source& source = sources[p.source];
+                if (worker.mappedSource != p.source) {
+                    worker.mapped.Close();
+                    worker.mappedSource = UINT32_MAX;
+                    if (worker.mapped.OpenRead(source.path.string())) {
+                        if (worker.mapped.Size() != source.size) return std::unexpected(PackError::InputChanged);
+                        worker.mappedSource = p.source;
+                    }
+                }
+                mapped = worker.mappedSource == p.source;
+                if (mapped) {
+                    raw = worker.mapped.Data().subspan(p.sourceOffset, p.length);
+                } else {
+                    IoFile file;
+                    if (!file.OpenRead(source.path.string())) return std::unexpected(PackError::OpenFailed);
+                    raw = stage(p, std::move(file));
+                    auto loaded = readStaged();
+                    if (!loaded) return loaded;
+                }
+            }
+
+            PackSealedPiece& piece = slot.pieces[i];
+            piece.digest = writer.Fingerprint(raw);
+            piece.rawSize = p.length;
+            piece.sealed = schedule->claims.Claim(piece.digest, p.payloadOffset);
+            if (piece.sealed) {
+                auto sealed = writer.SealPiece(p.payloadOffset, raw, out.Span().subspan(fill), worker.lz.get());
+                if (!sealed) return std::unexpected(sealed.error());
+                piece.chunk = *sealed;
+                piece.at = fill;
+                fill += sealed->storedSize;
+            }
+            if (mapped) worker.mapped.Discard(p.sourceOffset, p.length);
+        }
+        staging.Release();
+
+        std::lock_guard<std::mutex> guard(schedule->commitLock);
+        slot.buffer = std::move(out);
+        slot.ready = true;
+        for (uint64_t next = schedule->committed.load(std::memory_order_relaxed);; ++next) {
+            PackSealedUnit& head = schedule->parkedUnits[next % window];
+            if (!head.ready) break;
+            for (const PackSealedPiece& piece : head.pieces) {
+                const std::span<const std::byte> stored = piece.sealed
+                    ? head.buffer.Span().subspan(piece.at, piece.chunk.storedSize) : std::span<std::byte>();
+                auto committed = writer.CommitPiece(piece.rawSize, piece.digest, piece.sealed ? &piece.chunk : nullptr, stored);
+                if (!committed) return committed;
+            }
+            head.buffer.Release();
+            head.ready = false;
+            schedule->committed.store(next + 1, std::memory_order_release);
+        }
+        return {};
+    };
+
+    schedule->run = [&](PackWorkUnit& unit, PackWorker& worker) -> std::expected<void, PackError> {
+        if (IsCancelled()) return std::unexpected(PackError::Cancelled);
+        if (dedup) return sealUnit(worker, unit);
+        const std::vector<PackSegment>& segments = unit.segments;
+        size_t begin = 0;
+        while (begin < segments.size()) {
+            const uint32_t chunk = (uint32_t)(segments[begin].payloadOffset / chunkSize);
+            size_t end = begin + 1;
+            while (end < segments.size() && segments[end].payloadOffset / chunkSize == chunk) ++end;
+            auto sealed = sealChunk(worker, segments.data() + begin, segments.data() + end, chunk);
+            if (!sealed) return sealed;
+            begin = end;
+        }
+        return {};
+    };
+
+    auto drain = [schedule] {
+        std::unique_ptr<PackWorker> worker;
+        {
+            std::lock_guard<std::mutex> guard(schedule->lock);
+            --schedule->pending;
+            ++schedule->active;
+            if (!schedule->idle.empty()) {
+                worker = std::move(schedule->idle.back());
+                schedule->idle.pop_back();
+            }
+        }
+        if (!worker) worker = std::make_unique<PackWorker>();
+        while (std::optional<PackWorkUnit> unit = schedule->queue.TryPop()) {
+            if (!schedule->failed.load(std::memory_order_relaxed)) {   // else just drain
+                schedule->Complete(unit->bytes, schedule->run(*unit, *worker));
+            }
+            schedule->Recycle(std::move(unit->segments));
+        }
+        std::lock_guard<std::mutex> guard(schedule->lock);
+        schedule->idle.push_back(std::move(worker));
+        --schedule->active;
+        schedule->changed.notify_all();
+    };
+    auto spawn = [&] {
+        std::lock_guard<std::mutex> guard(schedule->lock);
+        if (schedule->pending + schedule->active >= workers) return;
+        ++schedule->pending;
+        mPool->Submit(drain);
+    };
+
+    PackWorker own;
+    auto report = [&] {
+        std::unique_lock<std::mutex> guard(schedule->lock);
+        while (!schedule->finished.empty()) {
+            const uint64_t bytes = schedule->finished.front();
+            schedule->finished.pop_front();
+            guard.unlock();
+            Advance(bytes);
+            guard.lock();
+        }
+    };
+    auto runQueued = [&] {
+        std::optional<PackWorkUnit> other = schedule->queue.TryPop();
+        if (!other) return false;
+        if (!schedule->failed.load()) schedule->Complete(other->bytes, schedule->run(*other, own));
+        schedule->Recycle(std::move(other->segments));
+        return true;
+    };
+    // A compressed unit waits until its last chunk is within a window of the last commit (a
+    // deduplicating one, until it is itself), helping with queued units meanwhile. Everything
+    // before it is already with a worker when the queue is empty, so the commits it waits for
+    // are on their way.
+    auto admit = [&](const PackWorkUnit& unit) {
+        if (!compress && !dedup) return;
+        const uint64_t last = dedup ? unit.sequence : unit.segments.back().payloadOffset / chunkSize;
+        while (!schedule->failed.load()) {
+            if (last < schedule->committed.load(std::memory_order_acquire) + window) return;
+            if (runQueued()) continue;
+            std::unique_lock<std::mutex> guard(schedule->lock);
+            if (last < schedule->committed.load(std::memory_order_acquire) + window || schedule->failed.load()) return;
+            schedule->changed.wait(guard);
+        }
+    };
+    auto submit = [&](PackWorkUnit& unit) {
+        admit(unit);
+        while (!schedule->queue.TryPush(unit)) runQueued();
+        spawn();
+        report();
+    };
+
+    // Walk the layout in payload order, cutting at chunk boundaries and every unitBytes
+    PackWorkUnit unit;
+    uint64_t payload = 0;
+    if (dedup) {
+        // Deduplicating: a piece per small file, content-defined pieces of larger ones (fixed
+        // ones if a file cannot be mapped), and a unit of whole pieces up to unitBytes
+        const FastCdc cdc(chunkSize);
+        MappedFile scan;
+        auto addPiece = [&](uint32_t source, uint64_t offset, uint32_t length) {
+            if (unit.bytes + length > unitBytes) {
+                submit(unit);
+                unit.bytes = 0;
+                unit.segments = schedule->Fresh();
+                ++unit.sequence;
+            }
+            unit.segments.push_back({ source, offset, payload, length });
+            unit.bytes += length;
+            payload += length;
+        };
+        for (uint32_t i = 0; i < sources.size() && !IsCancelled() && !schedule->failed.load(); ++i) {
+            const Source& source = sources[i];
+            if (source.size <= chunkSize) {
+                if (source.size) addPiece(i, 0, (uint32_t)source.size);
+                continue;
+            }
+            std::span<const std::byte> data;
+            if (scan.OpenRead(source.path.string())) {
+                if (scan.Size() != source.size) {
+                    schedule->Complete(0, std::unexpected(PackError::InputChanged));
+                    break;
+                }
+                data = scan.Data();
+            }
+            for (uint64_t offset = 0; offset < source.size && !IsCancelled() && !schedule->failed.load();) {
+                const uint32_t take = data.empty() ? (uint32_t)std::min<uint64_t>(chunkSize, source.size - offset)
+                                                   : (uint32_t)cdc.Cut(data.subspan((size_t)offset));
+                addPiece(i, offset, take);
+                offset += take;
+            }
+            scan.Close();
+        }
+    } else {
+        for (uint32_t i = 0; i < sources.size() && !IsCancelled() && !schedule->failed.load(); ++i) {
+            uint64_t offset = 0;
+            while (offset < sources[i].size) {
+                const uint64_t room = chunkSize - payload % chunkSize;
+                const uint32_t take = (uint32_t)std::min<uint64_t>(room, sources[i].size - offset);
+                unit.segments.push_back({ i, offset, payload, take });
+                unit.bytes += take;
+                offset += take;
+                payload += take;
+                if (payload % unitBytes == 0) {
+                    submit(unit);
+                    unit.bytes = 0;
+                    unit.segments = schedule->Fresh();
+                }
+            }
+        }
+    }
+    if (!unit.segments.empty()) submit(unit);
+    schedule->queue.Close();
+    while (runQueued()) {}
+
+    // Wait out the workers still sealing, reporting as their units land
+    std::unique_lock<std::mutex> guard(schedule->lock);
+    while (schedule->active != 0 || !schedule->finished.empty()) {
+        if (schedule->finished.empty()) {
+            schedule->changed.wait(guard);
+            continue;
+        }
+        guard.unlock();
+        report();
+        guard.lock();
+    }
+    const PackError error = schedule->error;
+    schedule->idle.clear();   // release mappings, rings and files now, not with the last late task
+    guard.unlock();
+    {
+        std::lock_guard<std::mutex> commitGuard(schedule->commitLock);
+        schedule->parked.clear();   // buffers parked behind a failed chunk go back to the pool
+        schedule->parkedUnits.clear();
+    }
+
+    if (IsCancelled()) return std::unexpected(PackError::Cancelled);
+    if (error != PackError::None) return std::unexpected(error);
+    return {};
+}
+
+// Kept between jobs; recreated only when a job needs larger or more buffers than it has.
+BufferPool& PackEngine::Buffers(uint32_t chunkSize, size_t capacity) {
+    if (!mBuffers || mBuffers->BufferSize() < chunkSize || mBuffers->Capacity() < capacity) {
+        mIo.reset();   // registered with the old arena
+        mBuffers = std::make_unique<BufferPool>(chunkSize, capacity);
+    }
+    return *mBuffers;
+}
+
+IoBackend& PackEngine::Io(uint32_t chunkSize) {
+    BufferPool& buffers = Buffers(chunkSize, mPool->ThreadCount() + 1);
+    if (!mIo) {
+        const std::span<std::byte> arena = buffers.Arena();
+        mIo = IoBackend::Create(mIoKind, *mPool, std::span<const std::span<std::byte>>(&arena, 1));
+    }
+    return *mIo;
+}
+
+std::expected<std::string, PackError>
+PackEngine::Extract(PackReader& reader, const PackEntry& entry, const std::string& outputDirectory) {
+    std::error_code ec;
+    const fs::path target = fs::path(outputDirectory) / fs::path(entry.path);
+    fs::create_directories(target.parent_path(), ec);
+
+    auto progress = [&](size_t bytes) -> std::expected<void, PackError> {
+        if (IsCancelled()) return std::unexpected(PackError::Cancelled);
+        Advance(bytes);
+        return {};
+    };
+
+    // Entries up to a chunk are decrypted into a pooled buffer and written with one
+    // positional write; mapping a small output costs more than the copy it saves
+    std::expected<void, PackError> read;
+    if (entry.length <= reader.ChunkSize()) {
+        IoBackend& io = Io(reader.ChunkSize());
+        IoFile out;
+        if (!out.Create(target.string(), entry.length)) return std::unexpected(PackError::OpenFailed);
+        const PooledBuffer staging = mBuffers->Acquire();
+        const std::span<std::byte> staged = staging.Span().first((size_t)entry.length);
+        read = reader.ReadInto(entry, staged, progress);
+        if (read && entry.length) {
+            const IoRequest write{ &out, 0, staged.data(), (uint32_t)entry.length, 0 };
+            if (!io.Write(std::span<const IoRequest>(&write, 1))) read = std::unexpected(PackError::WriteFailed);
+        }
+    } else {
+        // Larger ones are created at their final size and filled in place, straight out of
+        // the mapped archive
+        MappedFile out;
+        if (!out.Create(target.string(), entry.length)) return std::unexpected(PackError::OpenFailed);
+        read = reader.ReadInto(entry, out.MutableData(), progress);
+    }
+    if (!read) {
+        fs::remove(target, ec);
+        return std::unexpected(read.error());
+    }
+    return target.string();
+}
+
+// Per-thread state for jobs that read an archive: a cipher and decompression buffer of its
+// own, the outputs it has open, and its own I/O backend over the engine's buffer arena.
+struct PackEngine::ReadWorker {
+    PackCipherStream                       stream;
+    std::vector<std::byte>                 scratch;
+    std::unique_ptr<IoBackend>             io;
+    std::unordered_map<uint32_t, IoFile>   files;   // by target; nodes stay put, so requests can point at them
+    std::vector<IoRequest>                 writes;
+};
+
+// Runs task(group) for every group on the calling thread and the pool together, in whatever
+// order they get to them, and reports the bytes each returns as progress on the calling
+// thread. Every thread takes the next group off one counter until none are left, so the
+// caller never waits on a task the pool has not started (and, as with PackSchedule, a late
+// task finds nothing left). The first error stops the rest.
+std::expected<void, PackError> PackEngine::Spread(size_t groups, const GroupTask& task) {
+    struct State {
+        std::atomic<size_t>     next = 0;      // next group to take
+        size_t                  groups = 0;
+        const GroupTask*        task = nullptr;
+        std::mutex              lock;
+        std::condition_variable changed;
+        std::deque<uint64_t>    finished;      // bytes of each completed group, not yet reported
+        size_t                  active = 0;
+        std::vector<std::unique_ptr<ReadWorker>> idle;
+        PackError               error = PackError::None;
+        std::atomic<bool>       failed = false;
+
+        void Run(size_t group, ReadWorker& worker) {
+            if (failed.load(std::memory_order_relaxed)) return;
+            const std::expected<uint64_t, PackError> result = (*task)(group, worker);
+            std::lock_guard<std::mutex> guard(lock);
+            if (result) {
+                finished.push_back(*result);
+            } else if (error == PackError::None) {
+                error = result.error();
+                failed.store(true, std::memory_order_relaxed);
+            }
+            changed.notify_all();
+        }
+    };
+    auto state = std::make_shared<State>();
+    state->groups = groups;
+    state->task = &task;
+
+    auto drain = [state] {
+        std::unique_ptr<ReadWorker> worker;
+        {
+            std::lock_guard<std::mutex> guard(state->lock);
+            ++state->active;
+            if (!state->idle.empty()) {
+                worker = std::move(state->idle.back());
+                state->idle.pop_back();
+            }
+        }
+        for (size_t group; (group = state->next.fetch_add(1)) < state->groups;) {
+            if (!worker) worker = std::make_unique<ReadWorker>();
+            state->Run(group, *worker);
+        }
+        std::lock_guard<std::mutex> guard(state->lock);
+        if (worker) state->idle.push_back(std::move(worker));
+        --state->active;
+        state->changed.notify_all();
+    };
+    for (size_t i = 0; i < std::min(mPool->ThreadCount(), groups); ++i) mPool->Submit(drain);
+
+    auto report = [&] {
+        std::unique_lock<std::mutex> guard(state->lock);
+        while (!state->finished.empty()) {
+            const uint64_t bytes = state->finished.front();
+            state->finished.pop_front();
+            guard.unlock();
+            Advance(bytes);
+            guard.lock();
+        }
+    };
+    {
+        ReadWorker own;
+        for (size_t group; (group = state->next.fetch_add(1)) < groups;) {
+            state->Run(group, own);
+            report();
+        }
+    }
+
+    std::unique_lock<std::mutex> guard(state->lock);
+    while (state->active != 0 || !state->finished.empty()) {
+        if (state->finished.empty()) {
+            state->changed.wait(guard);
+            continue;
+        }
+        guard.unlock();
+        report();
+        guard.lock();
+    }
+    const PackError error = state->error;
+    state->idle.clear();   // close outputs and rings now, not with the last late task
+    guard.unlock();
+
+    if (IsCancelled()) return std::unexpected(PackError::Cancelled);
+    if (error != PackError::None) return std::unexpected(error);
+    return {};
+}
+
+// Creates every selected output at its final size up front, then decodes the chunks those
+// entries refer to through Spread(), each one once however many entries share it, with a
+// window of chunks prefetched ahead of the workers; every slice goes to its file with a
+// positional write.
+std::expected<std::string, PackError>
+PackEngine::Unpack(const std::string& packFile, const std::string& outputDirectory,
+                   std::span<const std::string> patterns) {
+    std::error_code ec;
+    if (!fs::exists(packFile, ec)) return std::unexpected(PackError::InputMissing);
+    if (!fs::is_regular_file(packFile, ec)) return std::unexpected(PackError::UnsupportedInput);
+
+    PackReader reader;
+    auto opened = reader.Open(packFile, mOptions.key);
+    if (!opened) return std::unexpected(opened.error());
+
+    const std::vector<PackEntry>& entries = reader.Entries();
+    std::vector<const PackEntry*> selected;
+    for (const PackEntry& e : entries) {
+        const bool wanted = patterns.empty() || std::any_of(patterns.begin(), patterns.end(),
+                                                            [&](const std::string& p) { return PackPathMatches(p, e.path); });
+        if (wanted) selected.push_back(&e);
+    }
+    if (!patterns.empty() && selected.empty()) return std::unexpected(PackError::EntryNotFound);
+
+    uint64_t total = 0;
+    for (const PackEntry* e : selected) total += e->length;
+    Begin(total);
+
+    // Every output exists at its final size before any chunk is decoded, so workers only ever
+    // open them for positional writes. On failure, take back everything this call created.
+    std::vector<std::string> targets;
+    targets.reserve(selected.size());
+    auto removeTargets = [&] {
+        for (const std::string& path : targets) fs::remove(path, ec);
+    };
+    fs::path lastParent;
+    for (const PackEntry* e : selected) {
+        const fs::path target = fs::path(outputDirectory) / fs::path(e->path);
+        if (target.parent_path() != lastParent) {
+            lastParent = target.parent_path();
+            fs::create_directories(lastParent, ec);
+        }
+        IoFile out;
+        if (IsCancelled() || !out.Create(target.string(), e->length)) {
+            removeTargets();
+            return std::unexpected(IsCancelled() ? PackError::Cancelled : PackError::OpenFailed);
+        }
+        targets.push_back(target.string());
+    }
+
+    // Cut the selection into per-chunk slices and group them by chunk, so each chunk is
+    // verified and decoded once for every slice of every entry that refers to it
+    const std::vector<PackChunk>& chunks = reader.Chunks();
+    const std::vector<PackRef>& refs = reader.Refs();
+    std::vector<PackSlice> slices;
+    for (uint32_t t = 0; t < selected.size(); ++t) {
+        const PackEntry& e = *selected[t];
+        const uint64_t end = e.offset + e.length;
+        for (uint32_t i = 0; i < e.chunkCount; ++i) {
+            const PackRef& ref = refs[e.firstChunk + i];
+            const uint64_t from = std::max(e.offset, ref.payloadOffset);
+            const uint64_t to = std::min(end, ref.payloadOffset + chunks[ref.chunk].rawSize);
+            if (to > from) {
+                slices.push_back({ ref.chunk, t, from - e.offset, (uint32_t)(from - ref.payloadOffset), (uint32_t)(to - from) });
+            }
+        }
+    }
+    std::stable_sort(slices.begin(), slices.end(), [](const PackSlice& a, const PackSlice& b) { return a.chunk < b.chunk; });
+    std::vector<size_t> groupStart;
+    for (size_t i = 0; i < slices.size(); ++i) {
+        if (i == 0 || slices[i].chunk != slices[i - 1].chunk) groupStart.push_back(i);
+    }
+    const size_t groups = groupStart.size();
+    groupStart.push_back(slices.size());
+
+    const size_t workers = mPool->ThreadCount();
+    const size_t readAhead = std::max<size_t>(1, workers) * PACK_ENGINE_READ_AHEAD;
+    BufferPool& buffers = Buffers(reader.ChunkSize(), workers + 1);
+    const std::span<std::byte> arena = buffers.Arena();
+    for (size_t g = 0; g < std::min(groups, readAhead); ++g) reader.Prefetch(slices[groupStart[g]].chunk);
+
+    // Decodes a chunk into a pooled buffer and writes each of its slices in place, as one
+    // batch; a worker keeps its outputs open from chunk to chunk, up to a limit
+    auto unpackChunk = [&](size_t group, ReadWorker& worker) -> std::expected<uint64_t, PackError> {
+        if (IsCancelled()) return std::unexpected(PackError::Cancelled);
+        if (group + readAhead < groups) reader.Prefetch(slices[groupStart[group + readAhead]].chunk);
+        if (!worker.io) {
+            worker.stream = reader.Stream();
+            worker.io = IoBackend::Create(mIoKind, *mPool, std::span<const std::span<std::byte>>(&arena, 1));
+        }
+        const uint32_t chunk = slices[groupStart[group]].chunk;
+        const PooledBuffer raw = buffers.Acquire();
+        auto read = reader.ReadChunk(chunk, raw.Span(), worker.stream, worker.scratch);
+        if (!read) return std::unexpected(read.error());
+        reader.Discard(chunk);
+
+        auto writeOut = [&]() -> std::expected<void, PackError> {
+            if (worker.writes.empty()) return {};
+            auto written = worker.io->Write(worker.writes);
+            worker.writes.clear();
+            if (!written) return std::unexpected(PackError::WriteFailed);
+            return {};
+        };
+        uint64_t bytes = 0;
+        for (size_t i = groupStart[group]; i < groupStart[group + 1]; ++i) {
+            const PackSlice& slice = slices[i];
+            auto open = worker.files.find(slice.target);
+            if (open == worker.files.end()) {
+                if (worker.files.size() == PACK_ENGINE_OPEN_FILES) {
+                    auto written = writeOut();
+                    if (!written) return std::unexpected(written.error());
+                    worker.files.clear();
+                }
+                IoFile file;
+                if (!file.OpenWrite(targets[slice.target])) return std::unexpected(PackError::OpenFailed);
+                open = worker.files.emplace(slice.target, std::move(file)).first;
+            }
+            worker.writes.push_back({ &open->second, slice.fileOffset, raw.Data() + slice.chunkOffset, slice.length, 0 });
+            bytes += slice.length;
+        }
+        auto written = writeOut();
+        if (!written) return std::unexpected(written.error());
+        return bytes;
+    };
+    auto spread = Spread(groups, unpackChunk);
+    if (!spread) {
+        removeTargets();
+        return std::unexpected(spread.error());
+    }
+    return outputDirectory;
+}
+
+std::expected<std::string, PackError>
+PackEngine::ExtractFile(const std::string& packFile, const std::string& entryPath, const std::string& outputDirectory) {
+    PackReader reader;
+    auto opened = reader.Open(packFile, mOptions.key);
+    if (!opened) return std::unexpected(opened.error());
+
+    const PackEntry* entry = reader.Find(entryPath);
+    if (!entry) return std::unexpected(PackError::EntryNotFound);
+    Begin(entry->length);
+    return Extract(reader, *entry, outputDirectory);
+}
+
+std::expected<std::string, PackError> PackEngine::Verify(const std::string& packFile) {
+    std::error_code ec;
+    if (!fs::exists(packFile, ec)) return std::unexpected(PackError::InputMissing);
+    if (!fs::is_regular_file(packFile, ec)) return std::unexpected(PackError::UnsupportedInput);
+
+    PackReader reader;
+    auto opened = reader.Open(packFile);   // checking needs no key
+    if (!opened) return std::unexpected(opened.error());
+
+    // Runs of whole chunks of about PACK_ENGINE_CHUNK stored bytes each, so small chunks do
+    // not cost a trip through the scheduler apiece
+    const std::vector<PackChunk>& chunks = reader.Chunks();
+    std::vector<uint32_t> groupStart;
+    uint64_t total = 0, run = 0;
+    for (uint32_t i = 0; i < chunks.size(); ++i) {
+        if (i == 0 || run >= PACK_ENGINE_CHUNK) {
+            groupStart.push_back(i);
+            run = 0;
+        }
+        run += chunks[i].storedSize;
+        total += chunks[i].storedSize;
+    }
+    const size_t groups = groupStart.size();
+    groupStart.push_back((uint32_t)chunks.size());
+    Begin(total);
+
+    const size_t readAhead = std::max<size_t>(1, mPool->ThreadCount()) * PACK_ENGINE_READ_AHEAD;
+    auto prefetch = [&](size_t group) {
+        for (uint32_t i = groupStart[group]; i < groupStart[group + 1]; ++i) reader.Prefetch(i);
+    };
+    for (size_t g = 0; g < std::min(groups, readAhead); ++g) prefetch(g);
+
+    std::vector<Sha256Digest> leaves(chunks.size());
+    auto checkChunks = [&](size_t group, ReadWorker&) -> std::expected<uint64_t, PackError> {
+        if (IsCancelled()) return std::unexpected(PackError::Cancelled);
+        if (group + readAhead < groups) prefetch(group + readAhead);
+        uint64_t bytes = 0;
+        for (uint32_t i = groupStart[group]; i < groupStart[group + 1]; ++i) {
+            auto leaf = reader.CheckChunk(i);
+            if (!leaf) return std::unexpected(leaf.error());
+            leaves[i] = *leaf;
+            reader.Discard(i);
+            bytes += chunks[i].storedSize;
+        }
+        return bytes;
+    };
+    auto spread = Spread(groups, checkChunks);
+    if (!spread) return std::unexpected(spread.error());
+    if (reader.HasTree() && PackTreeRoot(leaves) != reader.TreeRoot()) return std::unexpected(PackError::ChecksumMismatch);
+    return packFile;
+}
@@ -0,0 +1,101 @@
+#ifndef PACKENGINE_HPP
+#define PACKENGINE_HPP
+
+#include "stdafx.h"
+#include "PackFormat.hpp"
+#include "BufferPool.hpp"
+#include "IoBackend.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+
+#define PACK_ENGINE_CHUNK (1u << 20)   // bytes read and handed to the writer per step
+#define PACK_ENGINE_QUEUE_PER_THREAD 2 // scheduled work units in flight per pool thread
+#define PACK_ENGINE_OPEN_FILES 256     // deduplicating jobs: most small files read in one batch
+#define PACK_ENGINE_CLAIM_SHARDS 64    // locks over the fingerprint claims
+#define PACK_ENGINE_READ_AHEAD 4       // unpacking: chunks prefetched per pool thread, ahead of the workers
+#define PACK_EXTENSION    ".pack"
+
+struct PackProgress {
+    uint64_t bytesDone = 0;
+    uint64_t bytesTotal = 0;
+    double   elapsedSeconds = 0.0;
+
+    double BytesPerSecond() const { return elapsedSeconds > 0.0 ? (double)bytesDone / elapsedSeconds : 0.0; }
+    double EtaSeconds() const;   // < 0 while the rate is still unknown
+};
+
+// Pack Up / Unpack jobs, independent of Qt so they can run on any thread (see PackTask for the
+// GUI bridge). A job runs synchronously on the calling thread, with its chunks spread over a
+// thread pool; progress is reported through the callback, on the calling thread, after every
+// chunk, and Cancel() may be called from any other thread, after which the job stops at the
+// next chunk, removes its partial output and fails with Cancelled.
+class PackEngine {
+public:
+    using ProgressCallback = std::function<void(const PackProgress&)>;
+
+    PackEngine();
+
+    void SetProgressCallback(ProgressCallback callback) { mProgress = std::move(callback); }
+    void SetOptions(const PackOptions& options) { mOptions = options; }   // cipher, key, chunk size, compression, dedup, tree
+    const PackOptions& Options() const { return mOptions; }
+    void SetThreadPool(ThreadPool& pool) { mPool = &pool; }              // defaults to ThreadPool::Shared()
+    void SetIoBackend(IoBackendKind kind) {
+        if (kind == mIoKind) return;
+        mIoKind = kind;
+        mIo.reset();
+    }
+
+    // Packs a file, or every regular file under a directory (stored as "<dir name>/<relative
+    // path>", in sorted order), into <outputDirectory>/<input name>.pack; returns that path.
+    // Empty directories are not recorded.
+    std::expected<std::string, PackError> Pack(const std::string& input, const std::string& outputDirectory);
+
+    // Restores the entries of a .pack selected by `patterns` (see PackPathMatches; none
+    // selects every entry) under outputDirectory; returns outputDirectory. Fails with
+    // EntryNotFound when patterns are given and match nothing.
+    std::expected<std::string, PackError> Unpack(const std::string& packFile, const std::string& outputDirectory,
+                                                 std::span<const std::string> patterns = {});
+
+    // Checks every chunk's CRC - and, for an archive with a hash tree, the root over them -
+    // without decrypting anything, spread over the pool; returns packFile.
+    std::expected<std::string, PackError> Verify(const std::string& packFile);
+
+    // Restores a single entry, reading only its chunks; returns the written path.
+    std::expected<std::string, PackError> ExtractFile(const std::string& packFile, const std::string& entryPath,
+                                                      const std::string& outputDirectory);
+
+    void Cancel() { mCancel.store(true, std::memory_order_relaxed); }
+    bool IsCancelled() const { return mCancel.load(std::memory_order_relaxed); }
+
+private:
+    void Begin(uint64_t bytesTotal);
+    void Advance(uint64_t bytes);
+
+    struct Source;
+    std::expected<void, PackError> SealAll(PackWriter& writer, const std::vector<Source>& sources);
+
+    struct ReadWorker;
+    using GroupTask = std::function<std::expected<uint64_t, PackError>(size_t group, ReadWorker& worker)>;
+    std::expected<void, PackError> Spread(size_t groups, const GroupTask& task);
+
+    BufferPool& Buffers(uint32_t chunkSize, size_t capacity);   // chunk buffers for every stage of a job
+    IoBackend& Io(uint32_t chunkSize);         // the calling thread's backend, over Buffers()
+
+    std::expected<std::string, PackError>
+    Extract(PackReader& reader, const PackEntry& entry, const std::string& outputDirectory);
+
+    ProgressCallback                      mProgress;
+    PackOptions                           mOptions;
+    ThreadPool*                           mPool;
+    IoBackendKind                         mIoKind = IoBackendKind::Auto;
+    std::unique_ptr<BufferPool>           mBuffers;
+    std::unique_ptr<IoBackend>            mIo;         // registered with mBuffers, so declared after it
+    std::atomic<bool>                     mCancel;
+    PackProgress                          mState;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+#endif
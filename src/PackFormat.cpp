@@ -0,0 +1,1056 @@
+#include "PackFormat.hpp"
+#include "Crc32c.hpp"
+#include "CpuFeatures.hpp"
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <random>
+
+const char* PackErrorString(PackError error) {
+    switch (error) {
+    case PackError::None:             return "no error";
+    case PackError::Cancelled:        return "cancelled";
+    case PackError::InputMissing:     return "input does not exist";
+    case PackError::UnsupportedInput: return "input is not a regular file or directory";
+    case PackError::OpenFailed:       return "could not open a file";
+    case PackError::ReadFailed:       return "read failed";
+    case PackError::WriteFailed:      return "write failed";
+    case PackError::CipherFailed:     return "cipher failed";
+    case PackError::BadFormat:        return "not a valid pack file";
+    case PackError::ChecksumMismatch: return "checksum mismatch (corrupt pack file)";
+    case PackError::EntryNotFound:    return "no such entry in the pack file";
+    case PackError::InputChanged:     return "input changed while packing";
+    case PackError::DecompressFailed: return "could not decompress (wrong key or corrupt pack file)";
+    case PackError::AuthenticationFailed: return "authentication failed (wrong key or tampered pack file)";
+    case PackError::TooLarge:         return "input too large for the cipher (its keystream would repeat)";
+    }
+    return "unknown error";
+}
+
+// ---------- little-endian helpers ----------
+
+static void PutU16(std::vector<std::byte>& out, uint16_t v) {
+    for (int i = 0; i < 2; ++i) out.push_back(std::byte(v >> (8 * i)));
+}
+static void PutU32(std::vector<std::byte>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back(std::byte(v >> (8 * i)));
+}
+static void PutU64(std::vector<std::byte>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back(std::byte(v >> (8 * i)));
+}
+static void PutBytes(std::vector<std::byte>& out, const void* p, size_t n) {
+    const std::byte* b = (const std::byte*)p;
+    out.insert(out.end(), b, b + n);
+}
+
+// Bounds-checked cursor; any overrun latches `ok` to false and reads return 0
+struct ByteCursor {
+    const std::byte* p;
+    size_t           left;
+    bool             ok = true;
+
+    bool Take(void* dst, size_t n) {
+        if (!ok || n > left) { ok = false; std::memset(dst, 0, n); return false; }
+        std::memcpy(dst, p, n);
+        p += n;
+        left -= n;
+        return true;
+    }
+    uint64_t Le(size_t n) {
+        uint8_t b[8] = {};
+        Take(b, n);
+        uint64_t v = 0;
+        for (size_t i = 0; i < n; ++i) v |= (uint64_t)b[i] << (8 * i);
+        return v;
+    }
+    uint16_t U16() { return (uint16_t)Le(2); }
+    uint32_t U32() { return (uint32_t)Le(4); }
+    uint64_t U64() { return Le(8); }
+};
+
+PackCipherStream::PackCipherStream(PackCipher id, const uint8_t key[PACK_KEY_SIZE],
+                                   const uint8_t nonce[PACK_NONCE_SIZE]) {
+    switch (id) {
+    case PackCipher::None:     mCipher = CopyCipher{ CopyCipherMode::Wide }; break;
+    case PackCipher::ChaCha20: mCipher = ChaCha20Cipher(key, nonce); break;
+    case PackCipher::AesCtr:   mCipher = AesCtrCipher(key, nonce); break;
+    case PackCipher::ChaCha20Poly1305: mCipher = ChaCha20Poly1305Cipher(key, nonce); break;
+    }
+}
+
+// A chunk's keystream offset is unique within the archive (a deduplicated chunk is stored at
+// its first occurrence only), so it numbers the chunk's message.
+void PackCipherStream::Begin(uint64_t offset) {
+    std::visit([&](auto& cipher) {
+        if constexpr (SeekableCipher<std::decay_t<decltype(cipher)>>) cipher.seek(offset);
+        else cipher.restart(offset);
+    }, mCipher);
+}
+
+std::expected<void, PackError> PackCipherStream::Process(std::span<const std::byte> in, std::byte* out, bool forward) {
+    return std::visit([&](auto& cipher) -> std::expected<void, PackError> {
+        const auto result = forward ? cipher.encrypt(in, out) : cipher.decrypt(in, out);
+        if (!result) return std::unexpected(PackError::CipherFailed);
+        return {};
+    }, mCipher);
+}
+
+Poly1305Tag PackCipherStream::Tag() const {
+    const ChaCha20Poly1305Cipher* aead = std::get_if<ChaCha20Poly1305Cipher>(&mCipher);
+    return aead ? aead->tag() : Poly1305Tag{};
+}
+
+std::expected<void, PackError>
+PackCipherStream::Apply(uint64_t offset, std::span<const std::byte> in, std::byte* out, bool forward) {
+    if (Authenticated()) return std::unexpected(PackError::CipherFailed);
+    Begin(offset);
+    return Process(in, out, forward);
+}
+
+bool PackPathIsSafe(const std::string& path) {
+    if (path.empty() || path.size() > PACK_MAX_PATH) return false;
+    if (path.front() == '/' || path.find('\\') != std::string::npos) return false;
+    if (path.find(':') != std::string::npos) return false;   // drive letters, ADS
+    size_t start = 0;
+    while (start <= path.size()) {
+        const size_t end = std::min(path.find('/', start), path.size());
+        const std::string part = path.substr(start, end - start);
+        if (part.empty() || part == "." || part == "..") return false;
+        start = end + 1;
+    }
+    return true;
+}
+
+uint64_t PackPayloadLimit(PackCipher cipher) {
+    return cipher == PackCipher::ChaCha20 ? PACK_CHACHA20_MAX_PAYLOAD : UINT64_MAX;
+}
+
+uint32_t PackSealBlock() {
+    static const uint32_t block = [] {
+        const CpuFeatures& cpu = GetCpuFeatures();
+        const uint32_t cache = cpu.l2Bytes ? cpu.l2Bytes / 8 : cpu.l1dBytes;
+        if (cache == 0) return (uint32_t)PACK_SEAL_BLOCK;
+        return std::clamp(std::bit_floor(cache), (uint32_t)PACK_SEAL_BLOCK_MIN, (uint32_t)PACK_SEAL_BLOCK_MAX);
+    }();
+    return block;
+}
+
+// Ciphers `in` into `out` (they may be the same) `step` bytes at a time, continuing the chunk
+// the stream was last Begin()-ed on, and folds each step of stored bytes - the output when
+// sealing, the input when opening - into `crc` and, if given, `leaf` while it is still in
+// cache.
+static std::expected<void, PackError> CipherBlocks(PackCipherStream& cipher, std::span<const std::byte> in,
+                                                   std::byte* out, bool seal, uint32_t& crc, Sha256* leaf,
+                                                   size_t step = PackSealBlock()) {
+    for (size_t at = 0; at < in.size(); at += step) {
+        const std::span<const std::byte> block = in.subspan(at, std::min<size_t>(step, in.size() - at));
+        const std::span<const std::byte> stored = seal ? std::span<const std::byte>(out + at, block.size()) : block;
+        if (!seal) {
+            crc = Crc32c(stored, crc);
+            if (leaf) leaf->Update(stored);
+        }
+        auto applied = cipher.Process(block, out + at, seal);
+        if (!applied) return applied;
+        if (seal) {
+            crc = Crc32c(stored, crc);
+            if (leaf) leaf->Update(stored);
+        }
+    }
+    return {};
+}
+
+static void StartLeaf(Sha256& leaf) {
+    const std::byte prefix{ 0 };
+    leaf.Reset();
+    leaf.Update(std::span<const std::byte>(&prefix, 1));
+}
+
+Sha256Digest PackTreeRoot(std::span<const Sha256Digest> leaves) {
+    if (leaves.empty()) return Sha256::Hash({});
+    std::vector<Sha256Digest> level(leaves.begin(), leaves.end());
+    const std::byte prefix{ 1 };
+    while (level.size() > 1) {
+        size_t up = 0;
+        for (size_t i = 0; i < level.size(); i += 2) {
+            if (i + 1 == level.size()) {
+                level[up++] = level[i];
+                break;
+            }
+            Sha256 node;
+            node.Update(std::span<const std::byte>(&prefix, 1));
+            node.Update(std::as_bytes(std::span<const uint8_t>(level[i])));
+            node.Update(std::as_bytes(std::span<const uint8_t>(level[i + 1])));
+            level[up++] = node.Final();
+        }
+        level.resize(up);
+    }
+    return level[0];
+}
+
+// Matches from p and s on; '*' and '**' try every split, which is plenty for path lengths.
+static bool GlobMatch(const char* p, const char* s) {
+    while (*p) {
+        if (p[0] == '*' && p[1] == '*') {
+            p += 2;
+            if (*p == '/' && GlobMatch(p + 1, s)) return true;   // "**/" may match no directories
+            for (;; ++s) {
+                if (GlobMatch(p, s)) return true;
+                if (!*s) return false;
+            }
+        }
+        if (*p == '*') {
+            ++p;
+            for (;; ++s) {
+                if (GlobMatch(p, s)) return true;
+                if (!*s || *s == '/') return false;
+            }
+        }
+        if (!*s) return false;
+        if (*p == '?') {
+            if (*s == '/') return false;
+        } else if (*p == '[' && std::strchr(p + 2, ']')) {
+            const char* q = p + 1;
+            const bool negate = *q == '!' || *q == '^';
+            if (negate) ++q;
+            bool hit = false;
+            do {   // a ']' straight after the '[' (or '!') is a member, not the end
+                if (q[1] == '-' && q[2] && q[2] != ']') {
+                    hit |= (unsigned char)*s >= (unsigned char)q[0] && (unsigned char)*s <= (unsigned char)q[2];
+                    q += 3;
+                } else {
+                    hit |= *s == *q++;
+                }
+            } while (*q && *q != ']');
+            if (!*q || hit == negate || *s == '/') return false;
+            p = q;
+        } else if (*p != *s) {
+            return false;
+        }
+        ++p;
+        ++s;
+    }
+    return !*s;
+}
+
+bool PackPathMatches(const std::string& pattern, const std::string& path) {
+    std::string glob = pattern;
+    while (glob.size() > 1 && glob.back() == '/') glob.pop_back();
+    if (glob.empty()) return false;
+    if (GlobMatch(glob.c_str(), path.c_str())) return true;
+    // A pattern naming a directory selects everything under it
+    for (size_t slash = path.find('/'); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+        if (GlobMatch(glob.c_str(), path.substr(0, slash).c_str())) return true;
+    }
+    return false;
+}
+
+// ---------- PackWriter ----------
+
+PackWriter::~PackWriter() {
+    if (mOpen) Abandon();
+}
+
+std::expected<void, PackError> PackWriter::Start(const std::string& path, const PackOptions& options) {
+    if (mOpen) return std::unexpected(PackError::OpenFailed);
+    if (options.chunkSize < PACK_MIN_CHUNK || options.chunkSize > PACK_MAX_CHUNK ||
+        options.compressionLevel < 0 || options.compressionLevel > LZ77_MAX_LEVEL) {
+        return std::unexpected(PackError::BadFormat);
+    }
+    mPath = path;
+    mOptions = options;
+    mSealBlock = options.sealBlock ? options.sealBlock : PackSealBlock();
+    mChunkFill = 0;
+    mChunkCrc = 0;
+    StartLeaf(mChunkLeaf);
+    mPayload = 0;
+    mReserved = 0;
+    mFileOffset = PACK_HEADER_SIZE;
+    mInFile = false;
+    mParallel = false;
+    mSealedChunks.store(0, std::memory_order_relaxed);
+    mEntries.clear();
+    mChunks.clear();
+    mCompressed.clear();
+    mRefs.clear();
+    mStored.clear();
+    mCommitted = 0;
+
+    // Fresh nonce per archive, so two archives under one key never share keystream
+    std::random_device entropy;
+    for (size_t i = 0; i < PACK_NONCE_SIZE; i += 4) {
+        const uint32_t r = entropy();
+        std::memcpy(mNonce + i, &r, 4);
+    }
+    mCipher = PackCipherStream(options.cipher, options.key, mNonce);
+    return {};
+}
+
+static std::vector<std::byte> MakeHeader(const PackOptions& options, const uint8_t nonce[PACK_NONCE_SIZE]) {
+    std::vector<std::byte> header;
+    header.reserve(PACK_HEADER_SIZE);
+    PutBytes(header, PACK_MAGIC, 8);
+    PutU16(header, options.dedup ? PACK_VERSION_DEDUP : PACK_VERSION);
+    PutU16(header, PACK_HEADER_SIZE);
+    header.push_back(std::byte((uint8_t)options.cipher));
+    header.push_back(std::byte((uint8_t)(options.compressionLevel > 0 ? PackCompression::Lz77 : PackCompression::None)));
+    header.push_back(std::byte(options.tree ? PACK_FLAG_TREE : 0u));
+    header.resize(16, std::byte{0});
+    PutU32(header, options.chunkSize);
+    PutU32(header, 0);
+    PutBytes(header, nonce, PACK_NONCE_SIZE);
+    header.resize(PACK_HEADER_SIZE, std::byte{0});
+    return header;
+}
+
+std::expected<void, PackError> PackWriter::Open(const std::string& path, const PackOptions& options) {
+    if (options.dedup) return std::unexpected(PackError::BadFormat);   // needs the parallel fill
+    auto started = Start(path, options);
+    if (!started) return started;
+
+    mFile = std::fopen(path.c_str(), "wb");
+    if (!mFile) return std::unexpected(PackError::OpenFailed);
+    mOpen = true;
+    mSealed.assign(options.chunkSize, std::byte{0});
+
+    const std::vector<std::byte> header = MakeHeader(mOptions, mNonce);
+    if (std::fwrite(header.data(), 1, header.size(), mFile) != header.size()) {
+        Abandon();
+        return std::unexpected(PackError::WriteFailed);
+    }
+    return {};
+}
+
+std::expected<void, PackError>
+PackWriter::OpenMapped(const std::string& path, const PackOptions& options, uint64_t payloadBytes) {
+    if (payloadBytes > PackPayloadLimit(options.cipher)) return std::unexpected(PackError::TooLarge);
+    auto started = Start(path, options);
+    if (!started) return started;
+
+    if (!mMapped.Create(path, PACK_HEADER_SIZE + payloadBytes)) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        return std::unexpected(PackError::OpenFailed);
+    }
+    mOpen = true;
+    mReserved = payloadBytes;
+    mSealed.clear();
+
+    const std::vector<std::byte> header = MakeHeader(mOptions, mNonce);
+    std::memcpy(mMapped.MutableData().data(), header.data(), header.size());
+    return {};
+}
+
+std::expected<void, PackError> PackWriter::BeginFile(const std::string& relativePath) {
+    if (!mOpen || mInFile || mParallel || Deduplicating()) return std::unexpected(PackError::WriteFailed);
+    if (!PackPathIsSafe(relativePath)) return std::unexpected(PackError::UnsupportedInput);
+
+    PackEntry entry;
+    entry.path = relativePath;
+    entry.offset = mPayload;
+    entry.firstChunk = (uint32_t)(mPayload / mOptions.chunkSize);
+    mEntries.push_back(std::move(entry));
+    mInFile = true;
+    return {};
+}
+
+// Encrypts each slice where it will finally live - the chunk buffer, or the mapped output at
+// its file position - and folds it into the chunk CRC (and leaf) while it is still in cache. When
+// compressing, the raw bytes are only gathered here; FlushChunk() seals the whole chunk.
+std::expected<void, PackError> PackWriter::Write(std::span<const std::byte> data) {
+    if (!mOpen || !mInFile) return std::unexpected(PackError::WriteFailed);
+    const bool mapped = mMapped.IsOpen();
+    if (mapped && data.size() > mReserved - mPayload) return std::unexpected(PackError::InputChanged);
+    if (data.size() > PackPayloadLimit(mOptions.cipher) - mPayload) return std::unexpected(PackError::TooLarge);
+
+    while (!data.empty()) {
+        const size_t take = std::min<size_t>(data.size(), mOptions.chunkSize - mChunkFill);
+        if (Compressing()) {
+            mSealed.resize(mOptions.chunkSize);   // raw bytes wait here to be compressed
+            std::memcpy(mSealed.data() + mChunkFill, data.data(), take);
+        } else {
+            std::byte* out = mapped
+                ? mMapped.MutableData().data() + PACK_HEADER_SIZE + mPayload
+                : mSealed.data() + mChunkFill;
+            if (mChunkFill == 0) mCipher.Begin(mPayload);
+            auto sealed = CipherBlocks(mCipher, data.first(take), out, true, mChunkCrc, Tree() ? &mChunkLeaf : nullptr,
+                                       mSealBlock);
+            if (!sealed) return sealed;
+        }
+
+        mChunkFill += take;
+        mPayload += take;
+        data = data.subspan(take);
+        if (mChunkFill == mOptions.chunkSize) {
+            auto flushed = FlushChunk();
+            if (!flushed) return flushed;
+        }
+    }
+    return {};
+}
+
+std::expected<void, PackError> PackWriter::EndFile() {
+    if (!mOpen || !mInFile) return std::unexpected(PackError::WriteFailed);
+    PackEntry& entry = mEntries.back();
+    entry.length = mPayload - entry.offset;
+    entry.chunkCount = entry.length
+        ? (uint32_t)((entry.offset + entry.length - 1) / mOptions.chunkSize) - entry.firstChunk + 1
+        : 0;
+    mInFile = false;
+    return {};
+}
+
+std::expected<void, PackError> PackWriter::AddFile(const std::string& relativePath, uint64_t length) {
+    if (!mOpen || mInFile || mParallel || !mMapped.IsOpen() || mChunkFill != 0) {
+        return std::unexpected(PackError::WriteFailed);
+    }
+    if (!PackPathIsSafe(relativePath)) return std::unexpected(PackError::UnsupportedInput);
+    if (length > mReserved - mPayload) return std::unexpected(PackError::InputChanged);
+
+    // A deduplicating archive's refs are only known once committed; Finish() fills them in
+    PackEntry entry;
+    entry.path = relativePath;
+    entry.offset = mPayload;
+    entry.length = length;
+    if (!Deduplicating()) {
+        entry.firstChunk = (uint32_t)(mPayload / mOptions.chunkSize);
+        entry.chunkCount = length
+            ? (uint32_t)((entry.offset + length - 1) / mOptions.chunkSize) - entry.firstChunk + 1
+            : 0;
+    }
+    mEntries.push_back(std::move(entry));
+    mPayload += length;
+    return {};
+}
+
+std::expected<uint32_t, PackError> PackWriter::BeginParallel() {
+    if (!mOpen || mInFile || mParallel || !mMapped.IsOpen()) return std::unexpected(PackError::WriteFailed);
+    if (mPayload != mReserved) return std::unexpected(PackError::InputChanged);
+    if (Deduplicating()) {
+        mFileOffset = PACK_HEADER_SIZE;
+        mParallel = true;
+        return 0u;
+    }
+
+    const uint64_t count = (mPayload + mOptions.chunkSize - 1) / mOptions.chunkSize;
+    mChunks.assign((size_t)count, PackChunk());
+    for (size_t i = 0; i < mChunks.size(); ++i) {
+        const uint64_t start = (uint64_t)i * mOptions.chunkSize;
+        const uint32_t raw = (uint32_t)std::min<uint64_t>(mOptions.chunkSize, mPayload - start);
+        mChunks[i].fileOffset = PACK_HEADER_SIZE + start;
+        mChunks[i].keystreamOffset = start;
+        mChunks[i].storedSize = raw;
+        mChunks[i].rawSize = raw;
+    }
+    // Compressed chunks are placed as they are committed; the rest have a fixed slot each
+    mFileOffset = Compressing() ? PACK_HEADER_SIZE : PACK_HEADER_SIZE + mPayload;
+    mParallel = true;
+    return (uint32_t)count;
+}
+
+// Each call seals with its own copy of the cipher, so threads never share keystream state;
+// the chunk's slot in mChunks belongs to the caller until it returns.
+std::expected<void, PackError>
+PackWriter::SealChunk(uint32_t index, std::span<const std::span<const std::byte>> pieces) {
+    if (!mParallel || Compressing() || Deduplicating() || index >= mChunks.size()) {
+        return std::unexpected(PackError::WriteFailed);
+    }
+    PackChunk& chunk = mChunks[index];
+    const uint64_t start = (uint64_t)index * mOptions.chunkSize;
+    std::byte* out = mMapped.MutableData().data() + chunk.fileOffset;
+
+    PackCipherStream cipher = mCipher;
+    cipher.Begin(start);
+    uint32_t crc = 0;
+    Sha256 leaf;
+    StartLeaf(leaf);
+    size_t fill = 0;
+    for (std::span<const std::byte> piece : pieces) {
+        if (piece.size() > chunk.rawSize - fill) return std::unexpected(PackError::InputChanged);
+        auto sealed = CipherBlocks(cipher, piece, out + fill, true, crc, Tree() ? &leaf : nullptr, mSealBlock);
+        if (!sealed) return sealed;
+        fill += piece.size();
+    }
+    if (fill != chunk.rawSize) return std::unexpected(PackError::InputChanged);
+
+    mMapped.Discard(chunk.fileOffset, chunk.rawSize);
+    chunk.crc32c = crc;
+    chunk.tag = cipher.Tag();
+    if (Tree()) chunk.leaf = leaf.Final();
+    mSealedChunks.fetch_add(1, std::memory_order_release);
+    return {};
+}
+
+std::expected<PackChunk, PackError>
+PackWriter::CompressChunk(uint32_t index, std::span<const std::byte> raw, std::span<std::byte> out, Lz77Compressor& lz) const {
+    if (!mParallel || !Compressing() || Deduplicating() || index >= mChunks.size() ||
+        raw.size() != mChunks[index].rawSize) {
+        return std::unexpected(PackError::WriteFailed);
+    }
+    return Seal((uint64_t)index * mOptions.chunkSize, raw, out, &lz);
+}
+
+// One pass: the compressor hands over its output a seal step at a time and each step is
+// encrypted in place, checksummed and hashed before the next is made, so compressed bytes are
+// never written out to memory only to be read back. Compression only counts if it saves at
+// least a byte, so a stored size below the raw size is what marks a chunk as compressed on
+// the reading side too; a chunk that turns out not to shrink is started over and sealed raw.
+std::expected<PackChunk, PackError>
+PackWriter::Seal(uint64_t keystreamOffset, std::span<const std::byte> raw, std::span<std::byte> out,
+                 Lz77Compressor* lz) const {
+    if (raw.empty() || out.size() < raw.size() || (Compressing() && !lz)) return std::unexpected(PackError::WriteFailed);
+    PackChunk chunk;
+    chunk.keystreamOffset = keystreamOffset;
+    chunk.rawSize = (uint32_t)raw.size();
+    PackCipherStream cipher = mCipher;
+    Sha256 leaf;
+    Sha256* const hashing = Tree() ? &leaf : nullptr;
+
+    size_t packed = 0;
+    if (Compressing() && raw.size() > 1) {
+        cipher.Begin(keystreamOffset);
+        StartLeaf(leaf);
+        std::expected<void, PackError> sealed;
+        packed = lz->Compress(raw, out.first(raw.size() - 1), mOptions.compressionLevel, mSealBlock,
+                              [&](std::span<std::byte> finished) {
+                                  sealed = CipherBlocks(cipher, finished, finished.data(), true, chunk.crc32c, hashing,
+                                                        mSealBlock);
+                                  return sealed.has_value();
+                              });
+        if (!sealed) return std::unexpected(sealed.error());
+    }
+    if (packed) {
+        chunk.storedSize = (uint32_t)packed;
+        chunk.flags = PACK_CHUNK_COMPRESSED;
+    } else {
+        chunk.storedSize = chunk.rawSize;
+        chunk.crc32c = 0;
+        cipher.Begin(keystreamOffset);
+        StartLeaf(leaf);
+        auto sealed = CipherBlocks(cipher, raw, out.data(), true, chunk.crc32c, hashing, mSealBlock);
+        if (!sealed) return std::unexpected(sealed.error());
+    }
+    chunk.tag = cipher.Tag();
+    if (Tree()) chunk.leaf = leaf.Final();
+    return chunk;
+}
+
+// Keyed, so the plaintext index does not let anyone without the key confirm a guess at the
+// contents by hashing it.
+Sha256Digest PackWriter::Fingerprint(std::span<const std::byte> raw) const {
+    Sha256 hash;
+    hash.Update(std::as_bytes(std::span<const uint8_t>(mOptions.key, PACK_KEY_SIZE)));
+    hash.Update(raw);
+    return hash.Final();
+}
+
+std::expected<PackChunk, PackError>
+PackWriter::SealPiece(uint64_t payloadOffset, std::span<const std::byte> raw, std::span<std::byte> out,
+                      Lz77Compressor* lz) const {
+    if (!mParallel || !Deduplicating() || raw.size() > mOptions.chunkSize || payloadOffset > mPayload ||
+        raw.size() > mPayload - payloadOffset) {
+        return std::unexpected(PackError::WriteFailed);
+    }
+    return Seal(payloadOffset, raw, out, lz);
+}
+
+// A chunk is sealed at the payload position of its first occurrence, and pieces arrive in
+// payload order, so every stored chunk has keystream of its own.
+std::expected<void, PackError>
+PackWriter::CommitPiece(uint32_t rawSize, const Sha256Digest& digest, const PackChunk* sealed,
+                        std::span<const std::byte> stored) {
+    if (!mParallel || !Deduplicating() || rawSize == 0 || rawSize > mOptions.chunkSize ||
+        rawSize > mPayload - mCommitted || mRefs.size() >= UINT32_MAX) {
+        return std::unexpected(PackError::WriteFailed);
+    }
+    const auto known = mStored.find(digest);
+    uint32_t index;
+    if (known != mStored.end()) {
+        index = known->second;
+        if (mChunks[index].rawSize != rawSize) return std::unexpected(PackError::WriteFailed);
+    } else {
+        if (!sealed || sealed->rawSize != rawSize || sealed->keystreamOffset != mCommitted ||
+            stored.size() != sealed->storedSize || mFileOffset + stored.size() > PACK_HEADER_SIZE + mReserved) {
+            return std::unexpected(PackError::WriteFailed);
+        }
+        std::memcpy(mMapped.MutableData().data() + mFileOffset, stored.data(), stored.size());
+        mMapped.Discard(mFileOffset, stored.size());
+        index = (uint32_t)mChunks.size();
+        mChunks.push_back(*sealed);
+        mChunks.back().fileOffset = mFileOffset;
+        mChunks.back().digest = digest;
+        mStored.emplace(digest, index);
+        mFileOffset += stored.size();
+    }
+    mRefs.push_back({ mCommitted, index });
+    mCommitted += rawSize;
+    return {};
+}
+
+std::expected<void, PackError>
+PackWriter::CommitChunk(uint32_t index, const PackChunk& chunk, std::span<const std::byte> stored) {
+    if (!mParallel || !Compressing() || index >= mChunks.size() ||
+        index != mSealedChunks.load(std::memory_order_relaxed) || stored.size() != chunk.storedSize ||
+        chunk.rawSize != mChunks[index].rawSize || mFileOffset + stored.size() > PACK_HEADER_SIZE + mReserved) {
+        return std::unexpected(PackError::WriteFailed);
+    }
+    std::memcpy(mMapped.MutableData().data() + mFileOffset, stored.data(), stored.size());
+    mMapped.Discard(mFileOffset, stored.size());
+    mChunks[index] = chunk;
+    mChunks[index].fileOffset = mFileOffset;
+    mFileOffset += stored.size();
+    mSealedChunks.fetch_add(1, std::memory_order_release);
+    return {};
+}
+
+std::expected<void, PackError> PackWriter::FlushChunk() {
+    if (mChunkFill == 0) return {};
+
+    if (Compressing()) {
+        const uint32_t index = (uint32_t)mChunks.size();
+        if (!mLz) mLz = std::make_unique<Lz77Compressor>();
+        mCompressed.resize(mOptions.chunkSize);
+        auto sealed = Seal((uint64_t)index * mOptions.chunkSize, std::span<const std::byte>(mSealed.data(), mChunkFill),
+                           mCompressed, mLz.get());
+        if (!sealed) return std::unexpected(sealed.error());
+        const std::span<const std::byte> stored(mCompressed.data(), sealed->storedSize);
+        if (mMapped.IsOpen()) {
+            std::memcpy(mMapped.MutableData().data() + mFileOffset, stored.data(), stored.size());
+            mMapped.Discard(mFileOffset, stored.size());
+        } else if (std::fwrite(stored.data(), 1, stored.size(), mFile) != stored.size()) {
+            return std::unexpected(PackError::WriteFailed);
+        }
+        mChunks.push_back(*sealed);
+        mChunks.back().fileOffset = mFileOffset;
+        mFileOffset += stored.size();
+        mChunkFill = 0;
+        return {};
+    }
+
+    if (mMapped.IsOpen()) {
+        mMapped.Discard(mFileOffset, mChunkFill);   // start write-back, keep the page cache lean
+    } else if (std::fwrite(mSealed.data(), 1, mChunkFill, mFile) != mChunkFill) {
+        return std::unexpected(PackError::WriteFailed);
+    }
+
+    PackChunk chunk;
+    chunk.fileOffset = mFileOffset;
+    chunk.keystreamOffset = (uint64_t)mChunks.size() * mOptions.chunkSize;
+    chunk.storedSize = (uint32_t)mChunkFill;
+    chunk.rawSize = (uint32_t)mChunkFill;
+    chunk.crc32c = mChunkCrc;
+    chunk.tag = mCipher.Tag();
+    if (Tree()) chunk.leaf = mChunkLeaf.Final();
+    mChunks.push_back(chunk);
+    mFileOffset += mChunkFill;
+    mChunkFill = 0;
+    mChunkCrc = 0;
+    StartLeaf(mChunkLeaf);
+    return {};
+}
+
+std::expected<void, PackError> PackWriter::Finish() {
+    if (!mOpen) return std::unexpected(PackError::WriteFailed);
+    if (mInFile) {
+        auto ended = EndFile();
+        if (!ended) return ended;
+    }
+    if (mMapped.IsOpen() && mPayload != mReserved) {
+        Abandon();
+        return std::unexpected(PackError::InputChanged);
+    }
+    const bool complete = Deduplicating() ? mCommitted == mPayload
+                                          : mSealedChunks.load(std::memory_order_acquire) == mChunks.size();
+    if (mParallel && !complete) {
+        Abandon();
+        return std::unexpected(PackError::WriteFailed);
+    }
+    auto flushed = FlushChunk();
+    if (!flushed) return flushed;
+
+    // Point each entry at the refs covering its bytes; both lists run in payload order
+    if (Deduplicating()) {
+        size_t ref = 0;
+        for (PackEntry& e : mEntries) {
+            if (e.length == 0) continue;
+            while (mRefs[ref].payloadOffset + mChunks[mRefs[ref].chunk].rawSize <= e.offset) ++ref;
+            e.firstChunk = (uint32_t)ref;
+            while (mRefs[ref].payloadOffset + mChunks[mRefs[ref].chunk].rawSize < e.offset + e.length) ++ref;
+            e.chunkCount = (uint32_t)(ref - e.firstChunk + 1);
+        }
+    }
+
+    std::vector<std::byte> index;
+    PutU64(index, mEntries.size());
+    for (const PackEntry& e : mEntries) {
+        PutU16(index, (uint16_t)e.path.size());
+        PutBytes(index, e.path.data(), e.path.size());
+        PutU64(index, e.offset);
+        PutU64(index, e.length);
+        PutU32(index, e.firstChunk);
+        PutU32(index, e.chunkCount);
+    }
+    PutU64(index, mChunks.size());
+    for (const PackChunk& c : mChunks) {
+        PutU64(index, c.fileOffset);
+        if (Deduplicating()) PutU64(index, c.keystreamOffset);
+        PutU32(index, c.storedSize);
+        PutU32(index, c.rawSize);
+        PutU32(index, c.crc32c);
+        PutU32(index, c.flags);
+        if (mCipher.Authenticated()) PutBytes(index, c.tag.data(), c.tag.size());
+        if (Deduplicating()) PutBytes(index, c.digest.data(), c.digest.size());
+    }
+    if (Deduplicating()) {
+        PutU64(index, mRefs.size());
+        for (const PackRef& r : mRefs) PutU32(index, r.chunk);
+    }
+    if (Tree()) {
+        std::vector<Sha256Digest> leaves;
+        leaves.reserve(mChunks.size());
+        for (const PackChunk& c : mChunks) leaves.push_back(c.leaf);
+        const Sha256Digest root = PackTreeRoot(leaves);
+        PutBytes(index, root.data(), root.size());
+    }
+
+    std::vector<std::byte> footer;
+    PutU64(footer, mFileOffset);
+    PutU64(footer, index.size());
+    PutU32(footer, Crc32c(index));
+    PutU32(footer, 0);
+    PutBytes(footer, PACK_END_MAGIC, 8);
+
+    // A mapped payload is complete once unmapped - and cut back to what compressed chunks
+    // actually took; the index goes after it through the page cache like any other append
+    if (mMapped.IsOpen()) {
+        const uint64_t reserved = mMapped.Size();
+        mMapped.Close();
+        std::error_code ec;
+        if (mFileOffset < reserved) std::filesystem::resize_file(mPath, mFileOffset, ec);
+        if (ec) { Abandon(); return std::unexpected(PackError::WriteFailed); }
+        mFile = std::fopen(mPath.c_str(), "ab");
+        if (!mFile) { Abandon(); return std::unexpected(PackError::WriteFailed); }
+    }
+    const bool written = std::fwrite(index.data(), 1, index.size(), mFile) == index.size()
+                      && std::fwrite(footer.data(), 1, footer.size(), mFile) == footer.size();
+    const bool closed = std::fclose(mFile) == 0;
+    mFile = nullptr;
+    mOpen = false;
+    if (!written || !closed) {
+        std::error_code ec;
+        std::filesystem::remove(mPath, ec);
+        return std::unexpected(PackError::WriteFailed);
+    }
+    return {};
+}
+
+void PackWriter::Abandon() {
+    if (!mOpen) return;
+    if (mFile) std::fclose(mFile);
+    mFile = nullptr;
+    mMapped.Close();
+    mOpen = false;
+    std::error_code ec;
+    std::filesystem::remove(mPath, ec);
+}
+
+// ---------- PackReader ----------
+
+std::expected<void, PackError> PackReader::Open(const std::string& path, const uint8_t key[PACK_KEY_SIZE]) {
+    mFile.Close();
+    mEntries.clear();
+    mChunks.clear();
+    mRefs.clear();
+    mVerified.clear();
+    mLoadedChunk = -1;
+    mTreeRoot = {};
+
+    if (!mFile.OpenRead(path)) return std::unexpected(PackError::OpenFailed);
+    if (key) std::memcpy(mKey, key, PACK_KEY_SIZE);
+    else std::memset(mKey, 0, PACK_KEY_SIZE);
+
+    const std::span<const std::byte> file = mFile.Data();
+    const uint64_t size = file.size();
+    if (size < PACK_HEADER_SIZE + PACK_FOOTER_SIZE) return std::unexpected(PackError::BadFormat);
+
+    ByteCursor h{ file.data(), PACK_HEADER_SIZE };
+    char magic[8];
+    h.Take(magic, 8);
+    const uint16_t version = h.U16();
+    const uint16_t headerSize = h.U16();
+    uint8_t cipher = 0, compression = 0, flags = 0, reserved = 0;
+    h.Take(&cipher, 1);
+    h.Take(&compression, 1);
+    h.Take(&flags, 1);
+    h.Take(&reserved, 1);
+    mChunkSize = h.U32();
+    h.U32();
+    h.Take(mNonce, PACK_NONCE_SIZE);
+    if (std::memcmp(magic, PACK_MAGIC, 8) != 0 || (version != PACK_VERSION && version != PACK_VERSION_DEDUP) ||
+        headerSize != PACK_HEADER_SIZE ||
+        cipher > (uint8_t)PackCipher::ChaCha20Poly1305 || compression > (uint8_t)PackCompression::Lz77 || (flags & ~PACK_FLAG_TREE) ||
+        mChunkSize < PACK_MIN_CHUNK || mChunkSize > PACK_MAX_CHUNK) {
+        return std::unexpected(PackError::BadFormat);
+    }
+    mVersion = version;
+    mFlags = flags;
+    mCipher = (PackCipher)cipher;
+    mCompression = (PackCompression)compression;
+    mStream = PackCipherStream(mCipher, mKey, mNonce);
+
+    ByteCursor f{ file.data() + size - PACK_FOOTER_SIZE, PACK_FOOTER_SIZE };
+    const uint64_t indexOffset = f.U64();
+    const uint64_t indexSize = f.U64();
+    const uint32_t indexCrc = f.U32();
+    f.U32();
+    f.Take(magic, 8);
+    if (std::memcmp(magic, PACK_END_MAGIC, 8) != 0 || indexOffset < PACK_HEADER_SIZE ||
+        indexSize > size - PACK_FOOTER_SIZE || indexOffset != size - PACK_FOOTER_SIZE - indexSize) {
+        return std::unexpected(PackError::BadFormat);
+    }
+
+    const std::span<const std::byte> index = file.subspan((size_t)indexOffset, (size_t)indexSize);
+    if (Crc32c(index) != indexCrc) return std::unexpected(PackError::ChecksumMismatch);
+
+    ByteCursor in{ index.data(), index.size() };
+    const uint64_t entryCount = in.U64();
+    if (entryCount > index.size()) return std::unexpected(PackError::BadFormat);
+    mEntries.resize(entryCount);
+    for (PackEntry& e : mEntries) {
+        e.path.resize(in.U16());
+        in.Take(e.path.data(), e.path.size());
+        e.offset = in.U64();
+        e.length = in.U64();
+        e.firstChunk = in.U32();
+        e.chunkCount = in.U32();
+    }
+    const uint64_t chunkCount = in.U64();
+    if (chunkCount > index.size()) return std::unexpected(PackError::BadFormat);
+    const bool dedup = mVersion == PACK_VERSION_DEDUP;
+    mChunks.resize(chunkCount);
+    for (size_t i = 0; i < mChunks.size(); ++i) {
+        PackChunk& c = mChunks[i];
+        c.fileOffset = in.U64();
+        c.keystreamOffset = dedup ? in.U64() : (uint64_t)i * mChunkSize;
+        c.storedSize = in.U32();
+        c.rawSize = in.U32();
+        c.crc32c = in.U32();
+        c.flags = in.U32();
+        if (mStream.Authenticated()) in.Take(c.tag.data(), c.tag.size());
+        if (dedup) in.Take(c.digest.data(), c.digest.size());
+    }
+    if (dedup) {
+        const uint64_t refCount = in.U64();
+        if (refCount > index.size()) return std::unexpected(PackError::BadFormat);
+        mRefs.resize(refCount);
+        for (PackRef& r : mRefs) r.chunk = in.U32();
+    } else {
+        mRefs.resize(mChunks.size());
+        for (size_t i = 0; i < mRefs.size(); ++i) mRefs[i].chunk = (uint32_t)i;
+    }
+    if (HasTree()) in.Take(mTreeRoot.data(), mTreeRoot.size());
+    if (!in.ok || in.left != 0) return std::unexpected(PackError::BadFormat);
+    mVerified.assign(mChunks.size(), 0);
+
+    // Everything below is trusted by Read(), so check it once here
+    for (size_t i = 0; i < mChunks.size(); ++i) {
+        const PackChunk& c = mChunks[i];
+        const bool last = i + 1 == mChunks.size();
+        const bool compressed = c.flags == PACK_CHUNK_COMPRESSED && mCompression == PackCompression::Lz77;
+        const bool sized = compressed ? c.storedSize != 0 && c.storedSize < c.rawSize : c.storedSize == c.rawSize;
+        if ((c.flags != 0 && !compressed) || !sized || c.rawSize == 0 || c.rawSize > mChunkSize ||
+            (!dedup && !last && c.rawSize != mChunkSize) ||
+            c.fileOffset < PACK_HEADER_SIZE || c.fileOffset > indexOffset || c.storedSize > indexOffset - c.fileOffset) {
+            return std::unexpected(PackError::BadFormat);
+        }
+    }
+    uint64_t payload = 0;
+    for (PackRef& r : mRefs) {
+        if (r.chunk >= mChunks.size()) return std::unexpected(PackError::BadFormat);
+        r.payloadOffset = payload;
+        payload += mChunks[r.chunk].rawSize;
+    }
+    // An entry's refs must be exactly the ones its bytes fall in
+    const auto refEnd = [&](uint64_t ref) { return mRefs[ref].payloadOffset + mChunks[mRefs[ref].chunk].rawSize; };
+    for (const PackEntry& e : mEntries) {
+        if (!PackPathIsSafe(e.path) || e.offset > payload || e.length > payload - e.offset) {
+            return std::unexpected(PackError::BadFormat);
+        }
+        if (e.length == 0) {
+            if (e.chunkCount != 0) return std::unexpected(PackError::BadFormat);
+            continue;
+        }
+        const uint64_t first = e.firstChunk;
+        const uint64_t last = first + e.chunkCount - 1;
+        if (e.chunkCount == 0 || last >= mRefs.size() ||
+            mRefs[first].payloadOffset > e.offset || refEnd(first) <= e.offset ||
+            mRefs[last].payloadOffset >= e.offset + e.length || refEnd(last) < e.offset + e.length) {
+            return std::unexpected(PackError::BadFormat);
+        }
+    }
+    return {};
+}
+
+const PackEntry* PackReader::Find(const std::string& path) const {
+    for (const PackEntry& e : mEntries) {
+        if (e.path == path) return &e;
+    }
+    return nullptr;
+}
+
+std::span<const std::byte> PackReader::Stored(uint32_t index) const {
+    const PackChunk& c = mChunks[index];
+    return mFile.Data().subspan((size_t)c.fileOffset, c.storedSize);
+}
+
+// Small files share chunks, so each chunk's CRC is checked once, not once per entry
+std::expected<void, PackError> PackReader::VerifyChunk(uint32_t index) {
+    if (mVerified[index]) return {};
+    if (Crc32c(Stored(index)) != mChunks[index].crc32c) return std::unexpected(PackError::ChecksumMismatch);
+    mVerified[index] = 1;
+    return {};
+}
+
+// Decrypts a verified chunk into `raw` (rawSize bytes), checking its tag and decompressing on
+// the way if need be. Compressed and authenticated chunks are opened into mPacked first, so
+// `raw` - possibly the final output - only ever receives bytes whose tag has matched.
+std::expected<void, PackError> PackReader::Unseal(uint32_t index, std::span<std::byte> raw) {
+    const PackChunk& c = mChunks[index];
+    const bool compressed = c.flags & PACK_CHUNK_COMPRESSED;
+    const bool staged = compressed || mStream.Authenticated();
+    if (staged) mPacked.resize(c.storedSize);
+    mStream.Begin(c.keystreamOffset);
+    auto opened = mStream.Process(Stored(index), staged ? mPacked.data() : raw.data(), false);
+    if (!opened) return opened;
+    if (mStream.Authenticated() && !Poly1305::Equal(mStream.Tag(), c.tag)) {
+        return std::unexpected(PackError::AuthenticationFailed);
+    }
+    if (compressed) {
+        if (!Lz77Decompress(mPacked, raw)) return std::unexpected(PackError::DecompressFailed);
+    } else if (staged) {
+        std::memcpy(raw.data(), mPacked.data(), c.rawSize);
+    }
+    return {};
+}
+
+// The CRC (and the tag) is folded in block by block as the chunk is decrypted, so the stored
+// bytes are read once. Compressed and authenticated chunks are decrypted into `scratch` and
+// reach `raw` only once both match; a stored chunk under an unauthenticated cipher is
+// decrypted straight into `raw`, which the caller must discard if the CRC then fails.
+std::expected<void, PackError> PackReader::ReadChunk(uint32_t index, std::span<std::byte> raw, PackCipherStream& stream,
+                                                     std::vector<std::byte>& scratch) const {
+    if (!mFile.IsOpen() || index >= mChunks.size()) return std::unexpected(PackError::ReadFailed);
+    const PackChunk& c = mChunks[index];
+    if (raw.size() < c.rawSize) return std::unexpected(PackError::WriteFailed);
+    const bool compressed = c.flags & PACK_CHUNK_COMPRESSED;
+    const bool staged = compressed || stream.Authenticated();
+    if (staged) scratch.resize(c.storedSize);
+    uint32_t crc = 0;
+    stream.Begin(c.keystreamOffset);
+    auto opened = CipherBlocks(stream, Stored(index), staged ? scratch.data() : raw.data(), false, crc, nullptr);
+    if (!opened) return opened;
+    if (crc != c.crc32c) return std::unexpected(PackError::ChecksumMismatch);
+    if (stream.Authenticated() && !Poly1305::Equal(stream.Tag(), c.tag)) {
+        return std::unexpected(PackError::AuthenticationFailed);
+    }
+    if (compressed) {
+        if (!Lz77Decompress(scratch, raw.first(c.rawSize))) return std::unexpected(PackError::DecompressFailed);
+    } else if (staged) {
+        std::memcpy(raw.data(), scratch.data(), c.rawSize);
+    }
+    return {};
+}
+
+std::expected<Sha256Digest, PackError> PackReader::CheckChunk(uint32_t index) const {
+    if (!mFile.IsOpen() || index >= mChunks.size()) return std::unexpected(PackError::ReadFailed);
+    const std::span<const std::byte> stored = Stored(index);
+    const size_t step = PackSealBlock();
+    uint32_t crc = 0;
+    Sha256 leaf;
+    StartLeaf(leaf);
+    for (size_t at = 0; at < stored.size(); at += step) {
+        const std::span<const std::byte> block = stored.subspan(at, std::min<size_t>(step, stored.size() - at));
+        crc = Crc32c(block, crc);
+        if (HasTree()) leaf.Update(block);
+    }
+    if (crc != mChunks[index].crc32c) return std::unexpected(PackError::ChecksumMismatch);
+    return HasTree() ? leaf.Final() : Sha256Digest{};
+}
+
+void PackReader::Prefetch(uint32_t index) const {
+    mFile.Prefetch(mChunks[index].fileOffset, mChunks[index].storedSize);
+}
+
+void PackReader::Discard(uint32_t index) {
+    mFile.Discard(mChunks[index].fileOffset, mChunks[index].storedSize);
+}
+
+std::expected<void, PackError> PackReader::LoadChunk(uint32_t index) {
+    if (mLoadedChunk == (int64_t)index) return {};
+    auto verified = VerifyChunk(index);
+    if (!verified) return verified;
+    mLoadedChunk = -1;
+    mRaw.resize(mChunks[index].rawSize);
+    auto opened = Unseal(index, mRaw);
+    if (!opened) return opened;
+    mLoadedChunk = index;
+    return {};
+}
+
+std::expected<void, PackError> PackReader::Read(const PackEntry& entry, const Sink& sink) {
+    if (!mFile.IsOpen()) return std::unexpected(PackError::ReadFailed);
+    const uint64_t end = entry.offset + entry.length;
+    for (uint32_t i = 0; i < entry.chunkCount; ++i) {
+        const PackRef& ref = mRefs[entry.firstChunk + i];
+        auto loaded = LoadChunk(ref.chunk);
+        if (!loaded) return loaded;
+
+        const uint64_t chunkStart = ref.payloadOffset;
+        const uint64_t from = std::max(entry.offset, chunkStart) - chunkStart;
+        const uint64_t to = std::min(end, chunkStart + mRaw.size()) - chunkStart;
+        auto sunk = sink(std::span<const std::byte>(mRaw.data() + from, (size_t)(to - from)));
+        if (!sunk) return sunk;
+    }
+    return {};
+}
+
+std::expected<void, PackError>
+PackReader::ReadInto(const PackEntry& entry, std::span<std::byte> destination, const Progress& progress) {
+    if (!mFile.IsOpen()) return std::unexpected(PackError::ReadFailed);
+    if (destination.size() < entry.length) return std::unexpected(PackError::WriteFailed);
+
+    const uint64_t end = entry.offset + entry.length;
+    for (uint32_t i = 0; i < entry.chunkCount; ++i) {
+        const uint32_t index = mRefs[entry.firstChunk + i].chunk;
+        auto verified = VerifyChunk(index);
+        if (!verified) return verified;
+
+        const uint64_t chunkStart = mRefs[entry.firstChunk + i].payloadOffset;
+        const uint64_t from = std::max(entry.offset, chunkStart);
+        const uint64_t to = std::min(end, chunkStart + mChunks[index].rawSize);
+        std::byte* out = destination.data() + (from - entry.offset);
+        if (!(mChunks[index].flags & PACK_CHUNK_COMPRESSED) && !mStream.Authenticated()) {
+            // Decrypt only this entry's slice of the chunk, at its place in the keystream
+            const uint64_t skip = from - chunkStart;
+            const auto slice = Stored(index).subspan((size_t)skip, (size_t)(to - from));
+            auto opened = mStream.Apply(mChunks[index].keystreamOffset + skip, slice, out, false);
+            if (!opened) return opened;
+        } else if (to - from == mChunks[index].rawSize) {
+            auto opened = Unseal(index, std::span<std::byte>(out, (size_t)(to - from)));
+            if (!opened) return opened;
+        } else {
+            // A compressed or authenticated chunk only opens whole; neighbours sharing it reuse the buffer
+            auto loaded = LoadChunk(index);
+            if (!loaded) return loaded;
+            std::memcpy(out, mRaw.data() + (from - chunkStart), (size_t)(to - from));
+        }
+
+        if (to == chunkStart + mChunks[index].rawSize) {
+            mFile.Discard(mChunks[index].fileOffset, mChunks[index].storedSize);   // chunk fully consumed
+        }
+        if (progress) {
+            auto reported = progress((size_t)(to - from));
+            if (!reported) return reported;
+        }
+    }
+    return {};
+}
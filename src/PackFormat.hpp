@@ -0,0 +1,340 @@
+#ifndef PACKFORMAT_HPP
+#define PACKFORMAT_HPP
+
+#include "stdafx.h"
+#include "MappedFile.hpp"
+#include "CopyCipher.h"
+#include "ChaCha20Cipher.h"
+#include "AesCtrCipher.h"
+#include "ChaCha20Poly1305Cipher.h"
+#include "Lz77.hpp"
+#include "Sha256.hpp"
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+// ===== .pack container, versions 1 and 2 =====
+//
+//   header   PACK_HEADER_SIZE bytes: magic, version, cipher, compression, flags, chunk size, nonce
+//   chunks   the payload (every file's bytes back to back) cut into chunkSize pieces, the last
+//            one short - version 2: cut by content, and each distinct piece stored once - each
+//            optionally LZ77-compressed, then encrypted at keystream offset = its payload
+//            position (version 2: that of its first occurrence)
+//   index    entry count, entries (path, payload offset, length, first chunk, chunk count),
+//            chunk count, chunk table (file offset, [v2] keystream offset, stored size, raw
+//            size, CRC-32C of the stored bytes, flags, [ChaCha20-Poly1305] tag, [v2]
+//            fingerprint), [v2] ref count and ref table (chunk per payload piece, which an
+//            entry's first / count index instead of chunks), [PACK_FLAG_TREE] hash tree
+//            root (PackTreeRoot)
+//   footer   PACK_FOOTER_SIZE bytes: index offset, index size, CRC-32C of the index, end magic
+//
+// All integers are little-endian. Writing is a single pass; the index is appended once the
+// payload is complete. A reader maps the file, loads header, footer and index, then touches
+// only the chunks of whichever entry it wants.
+
+#define PACK_MAGIC          "HQPACK\r\n"   // 8 bytes; the CR LF catches text-mode mangling
+#define PACK_END_MAGIC      "HQPKEND\n"
+#define PACK_VERSION        1u
+#define PACK_VERSION_DEDUP  2u
+#define PACK_HEADER_SIZE    64u
+#define PACK_FOOTER_SIZE    32u
+#define PACK_NONCE_SIZE     16u            // AES-CTR uses all 16 bytes, ChaCha20 the first 12
+#define PACK_TAG_SIZE       POLY1305_TAG_SIZE   // per chunk, ChaCha20-Poly1305 archives
+#define PACK_KEY_SIZE       32u
+#define PACK_DEFAULT_CHUNK  (1u << 20)
+#define PACK_MIN_CHUNK      (4u << 10)
+#define PACK_MAX_CHUNK      (64u << 20)
+#define PACK_MAX_PATH       4096u
+#define PACK_CHACHA20_MAX_PAYLOAD ((uint64_t)1 << 38)   // 2^32 64-byte blocks: past this the counter repeats
+#define PACK_CHUNK_COMPRESSED 1u           // PackChunk::flags: stored bytes are an LZ77 block
+#define PACK_FLAG_TREE      1u             // header flags: the index ends with a hash tree root
+#define PACK_SEAL_BLOCK     (32u << 10)    // bytes per sealing step when the cache sizes are unknown
+#define PACK_SEAL_BLOCK_MIN (16u << 10)    // range PackSealBlock() picks from
+#define PACK_SEAL_BLOCK_MAX (64u << 10)
+
+enum class PackError {
+    None, Cancelled, InputMissing, UnsupportedInput, OpenFailed, ReadFailed, WriteFailed,
+    CipherFailed, BadFormat, ChecksumMismatch, EntryNotFound, InputChanged, DecompressFailed,
+    AuthenticationFailed, TooLarge
+};
+
+const char* PackErrorString(PackError error);
+
+enum class PackCipher : uint8_t { None = 0, ChaCha20 = 1, AesCtr = 2, ChaCha20Poly1305 = 3 };
+enum class PackCompression : uint8_t { None = 0, Lz77 = 1 };
+
+struct PackOptions {
+    PackCipher cipher = PackCipher::ChaCha20;
+    uint8_t    key[PACK_KEY_SIZE] = {};   // all-zero unless the caller supplies one
+    uint32_t   chunkSize = PACK_DEFAULT_CHUNK;
+    int        compressionLevel = 0;      // 0 stores chunks as they are, 1..LZ77_MAX_LEVEL
+    bool       dedup = false;             // version 2: content-defined chunks, each stored once
+    bool       tree = false;              // hash tree over the stored chunks, root kept in the index
+    uint32_t   sealBlock = 0;             // bytes per sealing step; 0 picks PackSealBlock()
+};
+
+// Most payload bytes an archive under `cipher` may hold. ChaCha20 archives encrypt the whole
+// payload as one keystream under one nonce, which its 32-bit block counter cannot take past
+// 256 GiB without repeating; the others have no practical limit.
+uint64_t PackPayloadLimit(PackCipher cipher);
+
+// Bytes a chunk is sealed (and opened) in per step: compressed, encrypted and checksummed
+// while that much is still in cache. An eighth of the L2 share of one logical processor -
+// room for the step's input and output, the match finder's hot entries and the neighbour on
+// the same core - within PACK_SEAL_BLOCK_MIN..PACK_SEAL_BLOCK_MAX; worked out once. Nothing
+// on disk depends on it.
+uint32_t PackSealBlock();
+
+// The archive's cipher, keyed once and repositioned for every chunk. ChaCha20-Poly1305 makes
+// each chunk its own RFC 8439 message, under the archive nonce with the chunk's keystream
+// offset XORed in, so chunks open independently and a forged one fails rather than decrypting
+// to garbage.
+class PackCipherStream {
+public:
+    PackCipherStream() = default;
+    PackCipherStream(PackCipher id, const uint8_t key[PACK_KEY_SIZE], const uint8_t nonce[PACK_NONCE_SIZE]);
+
+    // Starts the chunk at payload position `offset`: seeks there, or, authenticated, begins
+    // the chunk's own message. Process() then ciphers the chunk's bytes in order, in and out
+    // possibly the same, and Tag() is the authenticator over what it has been given so far.
+    void Begin(uint64_t offset);
+    std::expected<void, PackError> Process(std::span<const std::byte> in, std::byte* out, bool forward);
+    Poly1305Tag Tag() const;   // all zero when not Authenticated()
+    bool Authenticated() const { return std::holds_alternative<ChaCha20Poly1305Cipher>(mCipher); }
+
+    // Random access, unauthenticated streams only: out = cipher(in), with in[0] at payload
+    // position `offset`, anywhere in a chunk.
+    std::expected<void, PackError> Apply(uint64_t offset, std::span<const std::byte> in, std::byte* out, bool forward);
+
+private:
+    std::variant<CopyCipher, ChaCha20Cipher, AesCtrCipher, ChaCha20Poly1305Cipher> mCipher;
+};
+
+struct PackEntry {
+    std::string path;          // relative, '/'-separated, UTF-8
+    uint64_t    offset = 0;    // payload position of the first byte
+    uint64_t    length = 0;
+    uint32_t    firstChunk = 0;    // into the ref table (version 1: ref i is chunk i)
+    uint32_t    chunkCount = 0;
+};
+
+struct PackChunk {
+    uint64_t     fileOffset = 0;       // where the stored bytes start in the .pack file
+    uint64_t     keystreamOffset = 0;  // version 1: index x chunk size
+    uint32_t     storedSize = 0;
+    uint32_t     rawSize = 0;
+    uint32_t     crc32c = 0;           // of the stored bytes
+    uint32_t     flags = 0;            // PACK_CHUNK_COMPRESSED, or 0
+    Sha256Digest digest = {};          // version 2 only: keyed SHA-256 of the raw bytes (Fingerprint)
+    Poly1305Tag  tag = {};             // ChaCha20-Poly1305 archives only
+    Sha256Digest leaf = {};            // tree archives: leaf hash of the stored bytes, in memory only
+};
+
+// One piece of the payload: which chunk holds the bytes at payloadOffset.
+struct PackRef {
+    uint64_t payloadOffset = 0;
+    uint32_t chunk = 0;
+};
+
+// Streams files into a new .pack. BeginFile / Write* / EndFile per file, then Finish().
+// A mapped writer can instead be filled in parallel: declare every file up front with
+// AddFile(), call BeginParallel(), seal each chunk exactly once from whichever thread has its
+// bytes, then Finish(). With compression on, a chunk's place in the file depends on how far
+// every earlier one shrank, so the parallel fill is split in two: CompressChunk() from any
+// thread, then CommitChunk() in chunk order. Deduplicating archives are filled the same way
+// and only that way, a piece at a time: Fingerprint() and SealPiece() from any thread,
+// CommitPiece() in payload order.
+class PackWriter {
+public:
+    PackWriter() = default;
+    ~PackWriter();
+
+    PackWriter(const PackWriter&) = delete;
+    PackWriter& operator=(const PackWriter&) = delete;
+
+    std::expected<void, PackError> Open(const std::string& path, const PackOptions& options);
+
+    // Same, for a payload of exactly `payloadBytes`: the output is created at header + payload
+    // size and mapped, and Write() encrypts straight from the caller's span into the mapping.
+    // Finish() fails with InputChanged if the files written do not add up to payloadBytes.
+    std::expected<void, PackError> OpenMapped(const std::string& path, const PackOptions& options, uint64_t payloadBytes);
+
+    std::expected<void, PackError> BeginFile(const std::string& relativePath);
+    std::expected<void, PackError> Write(std::span<const std::byte> data);
+    std::expected<void, PackError> EndFile();
+
+    // Parallel fill (OpenMapped only). AddFile lays out the next `length` payload bytes for a
+    // file without writing them; BeginParallel fixes the layout and returns the chunk count
+    // (0 when deduplicating: chunks are only known as they are committed).
+    std::expected<void, PackError> AddFile(const std::string& relativePath, uint64_t length);
+    std::expected<uint32_t, PackError> BeginParallel();
+
+    // Encrypts chunk `index` from `pieces`, its raw bytes in payload order, into the mapping.
+    // Safe to call concurrently for different chunks; each chunk must be sealed exactly once.
+    // Uncompressed, non-deduplicating archives only.
+    std::expected<void, PackError> SealChunk(uint32_t index, std::span<const std::span<const std::byte>> pieces);
+
+    // Compressed archives: compresses chunk `index` from its raw bytes and encrypts the result
+    // into `out` (at least a chunk's worth), storing the raw bytes instead when compression
+    // does not save anything. Safe to call concurrently; returns the chunk's index record,
+    // for CommitChunk() to place.
+    std::expected<PackChunk, PackError> CompressChunk(uint32_t index, std::span<const std::byte> raw,
+                                                      std::span<std::byte> out, Lz77Compressor& lz) const;
+
+    // Copies a compressed chunk's stored bytes into the mapping behind the previous one.
+    // Chunks must be committed exactly once each, in index order, one call at a time.
+    std::expected<void, PackError> CommitChunk(uint32_t index, const PackChunk& chunk, std::span<const std::byte> stored);
+
+    // Deduplicating archives: the fingerprint a piece is matched by.
+    Sha256Digest Fingerprint(std::span<const std::byte> raw) const;
+
+    // Compresses (at the archive's level) and encrypts a piece that starts at payload position
+    // `payloadOffset` into `out` (at least raw.size() bytes); `lz` may be null at level 0.
+    // Safe to call concurrently. Only the first occurrence of a fingerprint needs sealing.
+    std::expected<PackChunk, PackError> SealPiece(uint64_t payloadOffset, std::span<const std::byte> raw,
+                                                  std::span<std::byte> out, Lz77Compressor* lz) const;
+
+    // Appends the next piece of the payload, one call at a time in payload order. A piece
+    // whose fingerprint is already stored becomes a reference to that chunk; any other must
+    // come with what SealPiece() made of it, and is copied into the mapping.
+    std::expected<void, PackError> CommitPiece(uint32_t rawSize, const Sha256Digest& digest,
+                                               const PackChunk* sealed, std::span<const std::byte> stored);
+
+    bool Compressing() const { return mOptions.compressionLevel > 0; }
+    bool Deduplicating() const { return mOptions.dedup; }
+    bool Tree() const { return mOptions.tree; }
+
+    std::expected<void, PackError> Finish();   // flushes the last chunk, writes index and footer
+    void Abandon();                            // closes and deletes a partial file
+
+private:
+    std::expected<void, PackError> Start(const std::string& path, const PackOptions& options);
+    std::expected<void, PackError> FlushChunk();
+    std::expected<PackChunk, PackError> Seal(uint64_t keystreamOffset, std::span<const std::byte> raw,
+                                             std::span<std::byte> out, Lz77Compressor* lz) const;
+
+    std::FILE*             mFile = nullptr;    // streaming output
+    MappedFile             mMapped;            // mapped output (OpenMapped)
+    std::string            mPath;
+    PackOptions            mOptions;
+    PackCipherStream       mCipher;
+    uint8_t                mNonce[PACK_NONCE_SIZE] = {};
+    std::vector<std::byte> mSealed;            // the chunk being filled: streaming mode, or raw when compressing
+    std::vector<std::byte> mCompressed;        // sequential compression: the sealed chunk
+    std::unique_ptr<Lz77Compressor> mLz;       // sequential compression, made on first use
+    size_t                 mChunkFill = 0;
+    size_t                 mSealBlock = PACK_SEAL_BLOCK;   // bytes per sealing step (options.sealBlock, resolved)
+    uint32_t               mChunkCrc = 0;      // running CRC-32C of the chunk being filled
+    Sha256                 mChunkLeaf;         // tree archives: its running leaf hash
+    uint64_t               mPayload = 0;       // payload bytes accepted so far
+    uint64_t               mReserved = 0;      // mapped mode: payload size the output was created for
+    uint64_t               mFileOffset = 0;    // start of the chunk being filled in the .pack file
+    bool                   mOpen = false;
+    bool                   mInFile = false;
+    bool                   mParallel = false;  // BeginParallel() was called
+    std::atomic<uint32_t>  mSealedChunks = 0;  // parallel mode: chunks sealed (or committed) so far
+    std::vector<PackEntry> mEntries;
+    std::vector<PackChunk> mChunks;
+    std::vector<PackRef>   mRefs;              // deduplicating archives
+    std::unordered_map<Sha256Digest, uint32_t, Sha256DigestHash> mStored;   // fingerprint -> chunk
+    uint64_t               mCommitted = 0;     // deduplicating archives: payload bytes committed
+};
+
+// Random-access reader over a finished .pack.
+class PackReader {
+public:
+    // Receives an entry's bytes in order, one chunk slice at a time; an error stops the read.
+    using Sink = std::function<std::expected<void, PackError>(std::span<const std::byte>)>;
+
+    PackReader() = default;
+
+    PackReader(const PackReader&) = delete;
+    PackReader& operator=(const PackReader&) = delete;
+
+    std::expected<void, PackError> Open(const std::string& path, const uint8_t key[PACK_KEY_SIZE] = nullptr);
+
+    const std::vector<PackEntry>& Entries() const { return mEntries; }
+    const std::vector<PackChunk>& Chunks() const { return mChunks; }
+    const std::vector<PackRef>&   Refs() const { return mRefs; }
+    uint16_t   Version() const { return mVersion; }
+    PackCipher Cipher() const { return mCipher; }
+    PackCompression Compression() const { return mCompression; }
+    uint32_t   ChunkSize() const { return mChunkSize; }
+    bool       HasTree() const { return mFlags & PACK_FLAG_TREE; }
+    const Sha256Digest& TreeRoot() const { return mTreeRoot; }
+
+    const PackEntry* Find(const std::string& path) const;
+
+    // Reads only the chunks the entry refers to, verifying each chunk's CRC before decrypting
+    // (and, authenticated, its tag before handing any of it on).
+    std::expected<void, PackError> Read(const PackEntry& entry, const Sink& sink);
+
+    // Zero-copy variant: decrypts the entry straight from the mapped archive into
+    // `destination` (entry.length bytes), calling `progress` after every chunk. Compressed
+    // (or authenticated) chunks are opened straight into `destination` when the entry spans
+    // all of one, through the chunk buffer otherwise.
+    using Progress = std::function<std::expected<void, PackError>(size_t bytes)>;
+    std::expected<void, PackError> ReadInto(const PackEntry& entry, std::span<std::byte> destination,
+                                            const Progress& progress = {});
+
+    // Chunk-at-a-time access for many threads at once, each with its own copy of Stream() and
+    // its own scratch buffer: ReadChunk decrypts (and decompresses) chunk `index` into `raw`
+    // (rawSize bytes), checking its CRC - and tag - on the way; on failure `raw` may hold
+    // unchecked bytes (never unauthenticated ones) and is to be discarded. Prefetch and Discard
+    // pass read-ahead and done-with hints on to the mapping.
+    PackCipherStream Stream() const { return mStream; }
+    std::expected<void, PackError> ReadChunk(uint32_t index, std::span<std::byte> raw, PackCipherStream& stream,
+                                             std::vector<std::byte>& scratch) const;
+    void Prefetch(uint32_t index) const;
+    void Discard(uint32_t index);
+
+    // Checks chunk `index` without decrypting it - its CRC, in one pass with its leaf hash
+    // for tree archives - and returns that leaf hash (zero otherwise). Needs no key, and is
+    // safe to call from many threads at once.
+    std::expected<Sha256Digest, PackError> CheckChunk(uint32_t index) const;
+
+private:
+    std::expected<void, PackError> VerifyChunk(uint32_t index);
+    std::expected<void, PackError> LoadChunk(uint32_t index);
+    std::span<const std::byte> Stored(uint32_t index) const;
+    std::expected<void, PackError> Unseal(uint32_t index, std::span<std::byte> raw);
+
+    MappedFile             mFile;
+    uint16_t               mVersion = PACK_VERSION;
+    uint8_t                mFlags = 0;
+    Sha256Digest           mTreeRoot = {};
+    PackCipher             mCipher = PackCipher::None;
+    PackCompression        mCompression = PackCompression::None;
+    PackCipherStream       mStream;
+    uint32_t               mChunkSize = 0;
+    uint8_t                mKey[PACK_KEY_SIZE] = {};
+    uint8_t                mNonce[PACK_NONCE_SIZE] = {};
+    std::vector<PackEntry> mEntries;
+    std::vector<PackChunk> mChunks;
+    std::vector<PackRef>   mRefs;
+    std::vector<uint8_t>   mVerified;          // per chunk: CRC already checked
+    std::vector<std::byte> mRaw;
+    std::vector<std::byte> mPacked;            // a compressed chunk, decrypted
+    int64_t                mLoadedChunk = -1;
+};
+
+// True when a stored path is safe to join onto an output directory: relative, no empty,
+// "." or ".." components, no backslashes or drive letters.
+bool PackPathIsSafe(const std::string& path);
+
+// The root of the hash tree over a tree archive's chunks, in chunk order. A leaf is SHA-256 of
+// a zero byte and the chunk's stored bytes, a node SHA-256 of a one byte and its two
+// children (RFC 6962's domain separation), and an odd node out moves up a level as it is.
+// Covers the whole payload, and needs no key to check.
+Sha256Digest PackTreeRoot(std::span<const Sha256Digest> leaves);
+
+// True when a stored path is selected by `pattern`: the path itself, a directory above it, or
+// a glob matching either - '*' and '?' stay within one component, '**' spans any number of
+// them, and [abc], [a-z], [!a-z] match one character.
+bool PackPathMatches(const std::string& pattern, const std::string& path);
+
+#endif
@@ -0,0 +1,48 @@
+#include "PackTask.hpp"
+#include <QElapsedTimer>
+
+PackTask::PackTask(Kind kind, QString input, QString outputDirectory, QObject* parent)
+: QObject(parent), mKind(kind), mInput(std::move(input)), mOutputDirectory(std::move(outputDirectory)),
+  mLastReportMs(-1) {
+}
+
+PackTask::~PackTask() {
+    if (mDone.valid()) {
+        mEngine.Cancel();
+        mDone.wait();
+    }
+}
+
+void PackTask::Start(QThreadPool* pool) {
+    if (mDone.valid()) return;   // one job per task
+    auto done = std::make_shared<std::promise<void>>();
+    mDone = done->get_future();
+    pool->start([this, done] {
+        Run();
+        done->set_value();
+    });
+}
+
+void PackTask::Run() {
+    QElapsedTimer clock;
+    clock.start();
+
+    // Called on the worker for every chunk; forwards a throttled subset (and always the last)
+    mEngine.SetProgressCallback([this, &clock](const PackProgress& p) {
+        const qint64 now = clock.elapsed();
+        const bool last = p.bytesDone >= p.bytesTotal;
+        if (!last && mLastReportMs >= 0 && now - mLastReportMs < PACK_TASK_PROGRESS_INTERVAL_MS) return;
+        mLastReportMs = now;
+        emit progress((qint64)p.bytesDone, (qint64)p.bytesTotal, p.BytesPerSecond(), p.EtaSeconds());
+    });
+
+    const std::string input = mInput.toStdString();
+    const std::string output = mOutputDirectory.toStdString();
+    const auto result = mKind == Kind::Pack ? mEngine.Pack(input, output) : mEngine.Unpack(input, output);
+
+    if (result) {
+        emit finished(true, QString::fromStdString(*result));
+    } else {
+        emit finished(false, QString::fromUtf8(PackErrorString(result.error())));
+    }
+}
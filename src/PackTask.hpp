@@ -0,0 +1,44 @@
+#ifndef PACKTASK_HPP
+#define PACKTASK_HPP
+
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <future>
+#include "PackEngine.hpp"
+
+#define PACK_TASK_PROGRESS_INTERVAL_MS 50   // at most ~20 progress signals per second
+
+// Runs one PackEngine job on a QThreadPool worker and reports back through signals. The task
+// lives on the GUI thread while the job runs elsewhere, so every signal reaches GUI slots as a
+// queued call and the event loop never blocks on the job. Destroying a running task cancels
+// the job and waits for the worker to let go of it.
+class PackTask : public QObject {
+    Q_OBJECT
+public:
+    enum class Kind { Pack, Unpack };
+
+    PackTask(Kind kind, QString input, QString outputDirectory, QObject* parent = nullptr);
+    ~PackTask() override;
+
+    void Start(QThreadPool* pool = QThreadPool::globalInstance());
+    void Cancel() { mEngine.Cancel(); }
+
+signals:
+    // etaSeconds < 0 while unknown
+    void progress(qint64 bytesDone, qint64 bytesTotal, double bytesPerSecond, double etaSeconds);
+    // On success `message` is the written path, otherwise a readable error
+    void finished(bool ok, QString message);
+
+private:
+    void Run();
+
+    Kind              mKind;
+    QString           mInput;
+    QString           mOutputDirectory;
+    PackEngine        mEngine;
+    std::future<void> mDone;
+    qint64            mLastReportMs;
+};
+
+#endif
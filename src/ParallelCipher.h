@@ -0,0 +1,83 @@
+#ifndef PARALLELCIPHER_H
+#define PARALLELCIPHER_H
+
+#include "stdafx.h"
+#include "Cipher.h"
+#include "ThreadPool.hpp"
+#include <mutex>
+#include <optional>
+
+#define PARALLEL_CIPHER_DEFAULT_CHUNK (1u << 20)   // 1 MiB: large enough to amortize a seek + task
+
+// Chunk-parallel engine over any SeekableCipher. A buffer is cut into fixed-size chunks; each
+// chunk runs on a copy of the prototype positioned with seek(streamOffset + chunkStart), so no
+// worker waits on another and the output is byte-identical to one cipher walking the whole
+// stream. The engine is itself a SeekableCipher and tracks the stream offset across calls.
+template<SeekableCipher CipherType>
+class ParallelCipher {
+public:
+    using error_type = typename CipherType::error_type;
+
+    explicit ParallelCipher(CipherType prototype,
+                            ThreadPool& pool = ThreadPool::Shared(),
+                            size_t chunkSize = PARALLEL_CIPHER_DEFAULT_CHUNK)
+    : mPrototype(std::move(prototype)), mPool(&pool),
+      mChunkSize(chunkSize ? chunkSize : PARALLEL_CIPHER_DEFAULT_CHUNK), mOffset(0) {}
+
+    std::expected<void, error_type>
+    encrypt(std::span<const std::byte> source, std::byte* destination) {
+        return Run(source, destination, true);
+    }
+
+    std::expected<void, error_type>
+    decrypt(std::span<const std::byte> source, std::byte* destination) {
+        return Run(source, destination, false);
+    }
+
+    void seek(uint64_t offset) { mOffset = offset; }
+    uint64_t tell() const { return mOffset; }
+
+    size_t chunkSize() const { return mChunkSize; }
+
+private:
+    std::expected<void, error_type>
+    Run(std::span<const std::byte> source, std::byte* destination, bool forward) {
+        const size_t total = source.size();
+        const size_t chunks = (total + mChunkSize - 1) / mChunkSize;
+
+        std::mutex failLock;
+        std::optional<std::pair<size_t, error_type>> failure;  // lowest failing chunk wins
+
+        auto work = [&](size_t i) {
+            const size_t begin = i * mChunkSize;
+            const size_t len = std::min(mChunkSize, total - begin);
+
+            CipherType cipher = mPrototype;
+            cipher.seek(mOffset + begin);
+            auto result = forward
+                ? cipher.encrypt(source.subspan(begin, len), destination + begin)
+                : cipher.decrypt(source.subspan(begin, len), destination + begin);
+            if (!result) {
+                std::lock_guard<std::mutex> guard(failLock);
+                if (!failure || i < failure->first) failure.emplace(i, result.error());
+            }
+        };
+
+        if (chunks <= 1) {
+            if (chunks == 1) work(0);
+        } else {
+            mPool->ParallelFor(chunks, work);
+        }
+
+        mOffset += total;
+        if (failure) return std::unexpected(failure->second);
+        return {};
+    }
+
+    CipherType  mPrototype;
+    ThreadPool* mPool;
+    size_t      mChunkSize;
+    uint64_t    mOffset;
+};
+
+#endif
@@ -0,0 +1,304 @@
+#include "Poly1305.hpp"
+#include "CpuFeatures.hpp"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define POLY1305_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define POLY1305_TARGET
+#else
+#define POLY1305_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+#define POLY1305_LIMB_MASK   0x3ffffffu
+#define POLY1305_HIBIT       (1u << 24)   // 2^128, in the top limb
+#define POLY1305_WIDE_BLOCKS 16u          // shortest run worth setting up four accumulators for
+
+static inline uint32_t LoadLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void StoreLE32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+// h = h * r mod 2^130 - 5, limbs left partially reduced (h1 may run a few bits over 26)
+static void MulMod(uint32_t h[5], const uint32_t r[5]) {
+    const uint32_t s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+    const uint64_t d0 = (uint64_t)h[0] * r[0] + (uint64_t)h[1] * s4 + (uint64_t)h[2] * s3 + (uint64_t)h[3] * s2 + (uint64_t)h[4] * s1;
+    uint64_t       d1 = (uint64_t)h[0] * r[1] + (uint64_t)h[1] * r[0] + (uint64_t)h[2] * s4 + (uint64_t)h[3] * s3 + (uint64_t)h[4] * s2;
+    uint64_t       d2 = (uint64_t)h[0] * r[2] + (uint64_t)h[1] * r[1] + (uint64_t)h[2] * r[0] + (uint64_t)h[3] * s4 + (uint64_t)h[4] * s3;
+    uint64_t       d3 = (uint64_t)h[0] * r[3] + (uint64_t)h[1] * r[2] + (uint64_t)h[2] * r[1] + (uint64_t)h[3] * r[0] + (uint64_t)h[4] * s4;
+    uint64_t       d4 = (uint64_t)h[0] * r[4] + (uint64_t)h[1] * r[3] + (uint64_t)h[2] * r[2] + (uint64_t)h[3] * r[1] + (uint64_t)h[4] * r[0];
+    d1 += d0 >> 26;
+    d2 += d1 >> 26;
+    d3 += d2 >> 26;
+    d4 += d3 >> 26;
+    uint64_t h0 = (d0 & POLY1305_LIMB_MASK) + (d4 >> 26) * 5;
+    h[1] = (uint32_t)(d1 & POLY1305_LIMB_MASK) + (uint32_t)(h0 >> 26);
+    h[0] = (uint32_t)(h0 & POLY1305_LIMB_MASK);
+    h[2] = (uint32_t)(d2 & POLY1305_LIMB_MASK);
+    h[3] = (uint32_t)(d3 & POLY1305_LIMB_MASK);
+    h[4] = (uint32_t)(d4 & POLY1305_LIMB_MASK);
+}
+
+// h = (h + block) * r for each 16-byte block; hibit is 2^128 for a whole block, 0 for the
+// final partial one (which carries its own 0x01 terminator)
+static void BlocksPortable(uint32_t h[5], const uint32_t r[5][5], const uint8_t* p, size_t blocks, uint32_t hibit) {
+    for (; blocks; --blocks, p += POLY1305_BLOCK_SIZE) {
+        h[0] += LoadLE32(p) & POLY1305_LIMB_MASK;
+        h[1] += (LoadLE32(p + 3) >> 2) & POLY1305_LIMB_MASK;
+        h[2] += (LoadLE32(p + 6) >> 4) & POLY1305_LIMB_MASK;
+        h[3] += (LoadLE32(p + 9) >> 6) & POLY1305_LIMB_MASK;
+        h[4] += (LoadLE32(p + 12) >> 8) | hibit;
+        MulMod(h, r[0]);
+    }
+}
+
+#if defined(POLY1305_X86)
+// Four accumulators, one per 64-bit lane: lane j takes blocks j, j + 4, j + 8, ..., each
+// step multiplying by r^4. Two groups go per iteration - acc * r^8 + group * r^4 + next
+// group - so the two products do not wait on each other, and one carry pass serves both.
+// After the last group lane j is multiplied by r^(4 - j), which leaves every block with
+// exactly the power of r the serial evaluation gives it, and the lanes are summed into h.
+
+// d += a * r, limb by limb, unreduced (s = 5r stands in for the limbs that wrap past 2^130)
+POLY1305_TARGET static void MulAddX4(__m256i d[5], const __m256i a[5], const __m256i r[5], const __m256i s[5]) {
+    d[0] = _mm256_add_epi64(d[0], _mm256_mul_epu32(a[0], r[0]));
+    d[1] = _mm256_add_epi64(d[1], _mm256_mul_epu32(a[0], r[1]));
+    d[2] = _mm256_add_epi64(d[2], _mm256_mul_epu32(a[0], r[2]));
+    d[3] = _mm256_add_epi64(d[3], _mm256_mul_epu32(a[0], r[3]));
+    d[4] = _mm256_add_epi64(d[4], _mm256_mul_epu32(a[0], r[4]));
+    d[0] = _mm256_add_epi64(d[0], _mm256_mul_epu32(a[1], s[4]));
+    d[1] = _mm256_add_epi64(d[1], _mm256_mul_epu32(a[1], r[0]));
+    d[2] = _mm256_add_epi64(d[2], _mm256_mul_epu32(a[1], r[1]));
+    d[3] = _mm256_add_epi64(d[3], _mm256_mul_epu32(a[1], r[2]));
+    d[4] = _mm256_add_epi64(d[4], _mm256_mul_epu32(a[1], r[3]));
+    d[0] = _mm256_add_epi64(d[0], _mm256_mul_epu32(a[2], s[3]));
+    d[1] = _mm256_add_epi64(d[1], _mm256_mul_epu32(a[2], s[4]));
+    d[2] = _mm256_add_epi64(d[2], _mm256_mul_epu32(a[2], r[0]));
+    d[3] = _mm256_add_epi64(d[3], _mm256_mul_epu32(a[2], r[1]));
+    d[4] = _mm256_add_epi64(d[4], _mm256_mul_epu32(a[2], r[2]));
+    d[0] = _mm256_add_epi64(d[0], _mm256_mul_epu32(a[3], s[2]));
+    d[1] = _mm256_add_epi64(d[1], _mm256_mul_epu32(a[3], s[3]));
+    d[2] = _mm256_add_epi64(d[2], _mm256_mul_epu32(a[3], s[4]));
+    d[3] = _mm256_add_epi64(d[3], _mm256_mul_epu32(a[3], r[0]));
+    d[4] = _mm256_add_epi64(d[4], _mm256_mul_epu32(a[3], r[1]));
+    d[0] = _mm256_add_epi64(d[0], _mm256_mul_epu32(a[4], s[1]));
+    d[1] = _mm256_add_epi64(d[1], _mm256_mul_epu32(a[4], s[2]));
+    d[2] = _mm256_add_epi64(d[2], _mm256_mul_epu32(a[4], s[3]));
+    d[3] = _mm256_add_epi64(d[3], _mm256_mul_epu32(a[4], s[4]));
+    d[4] = _mm256_add_epi64(d[4], _mm256_mul_epu32(a[4], r[0]));
+}
+
+// Back to 26-bit limbs (h1 and h4 a few bits over), two carry chains at a time
+POLY1305_TARGET static void CarryX4(__m256i h[5], __m256i d[5]) {
+    const __m256i mask = _mm256_set1_epi64x(POLY1305_LIMB_MASK);
+    d[4] = _mm256_add_epi64(d[4], _mm256_srli_epi64(d[3], 26)); d[3] = _mm256_and_si256(d[3], mask);
+    d[1] = _mm256_add_epi64(d[1], _mm256_srli_epi64(d[0], 26)); d[0] = _mm256_and_si256(d[0], mask);
+    __m256i c = _mm256_srli_epi64(d[4], 26);                     d[4] = _mm256_and_si256(d[4], mask);
+    d[0] = _mm256_add_epi64(d[0], _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+    d[2] = _mm256_add_epi64(d[2], _mm256_srli_epi64(d[1], 26)); d[1] = _mm256_and_si256(d[1], mask);
+    d[3] = _mm256_add_epi64(d[3], _mm256_srli_epi64(d[2], 26)); d[2] = _mm256_and_si256(d[2], mask);
+    d[1] = _mm256_add_epi64(d[1], _mm256_srli_epi64(d[0], 26)); d[0] = _mm256_and_si256(d[0], mask);
+    d[4] = _mm256_add_epi64(d[4], _mm256_srli_epi64(d[3], 26)); d[3] = _mm256_and_si256(d[3], mask);
+    for (int i = 0; i < 5; ++i) h[i] = d[i];
+}
+
+// Four consecutive blocks, block j's limbs in lane j
+POLY1305_TARGET static void LoadX4(__m256i m[5], const uint8_t* p) {
+    const __m256i mask = _mm256_set1_epi64x(POLY1305_LIMB_MASK);
+    const __m256i a = _mm256_loadu_si256((const __m256i*)p);          // lo0 hi0 lo1 hi1
+    const __m256i b = _mm256_loadu_si256((const __m256i*)(p + 32));   // lo2 hi2 lo3 hi3
+    const __m256i lo = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b), 0xD8);
+    const __m256i hi = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(a, b), 0xD8);
+    m[0] = _mm256_and_si256(lo, mask);
+    m[1] = _mm256_and_si256(_mm256_srli_epi64(lo, 26), mask);
+    m[2] = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(lo, 52), _mm256_slli_epi64(hi, 12)), mask);
+    m[3] = _mm256_and_si256(_mm256_srli_epi64(hi, 14), mask);
+    m[4] = _mm256_or_si256(_mm256_srli_epi64(hi, 40), _mm256_set1_epi64x(POLY1305_HIBIT));
+}
+
+POLY1305_TARGET static void BlocksAvx2(uint32_t h[5], const uint32_t r[5][5], const uint8_t* p, size_t blocks,
+                                       uint32_t hibit) {
+    if (blocks >= POLY1305_WIDE_BLOCKS && hibit) {
+        __m256i r4[5], s4[5], r8[5], s8[5], rn[5], sn[5], acc[5], m[5], d[5];
+        for (int i = 0; i < 5; ++i) {
+            r4[i] = _mm256_set1_epi64x(r[3][i]);
+            s4[i] = _mm256_set1_epi64x(r[3][i] * 5);
+            r8[i] = _mm256_set1_epi64x(r[4][i]);
+            s8[i] = _mm256_set1_epi64x(r[4][i] * 5);
+            rn[i] = _mm256_set_epi64x(r[0][i], r[1][i], r[2][i], r[3][i]);   // lane 0 gets r^4, lane 3 r
+            sn[i] = _mm256_set_epi64x(r[0][i] * 5, r[1][i] * 5, r[2][i] * 5, r[3][i] * 5);
+        }
+        LoadX4(acc, p);
+        for (int i = 0; i < 5; ++i) acc[i] = _mm256_add_epi64(acc[i], _mm256_set_epi64x(0, 0, 0, h[i]));
+        p += 4 * POLY1305_BLOCK_SIZE;
+        blocks -= 4;
+        for (; blocks >= 8; blocks -= 8, p += 8 * POLY1305_BLOCK_SIZE) {
+            LoadX4(m, p);
+            for (int i = 0; i < 5; ++i) d[i] = _mm256_setzero_si256();
+            MulAddX4(d, acc, r8, s8);
+            MulAddX4(d, m, r4, s4);
+            CarryX4(acc, d);
+            LoadX4(m, p + 4 * POLY1305_BLOCK_SIZE);
+            for (int i = 0; i < 5; ++i) acc[i] = _mm256_add_epi64(acc[i], m[i]);
+        }
+        if (blocks >= 4) {
+            for (int i = 0; i < 5; ++i) d[i] = _mm256_setzero_si256();
+            MulAddX4(d, acc, r4, s4);
+            CarryX4(acc, d);
+            LoadX4(m, p);
+            for (int i = 0; i < 5; ++i) acc[i] = _mm256_add_epi64(acc[i], m[i]);
+            p += 4 * POLY1305_BLOCK_SIZE;
+            blocks -= 4;
+        }
+        for (int i = 0; i < 5; ++i) d[i] = _mm256_setzero_si256();
+        MulAddX4(d, acc, rn, sn);
+        CarryX4(acc, d);
+
+        uint64_t sum[5];
+        for (int i = 0; i < 5; ++i) {
+            const __m128i pair = _mm_add_epi64(_mm256_castsi256_si128(acc[i]), _mm256_extracti128_si256(acc[i], 1));
+            sum[i] = (uint64_t)_mm_cvtsi128_si64(pair) + (uint64_t)_mm_extract_epi64(pair, 1);
+        }
+        sum[1] += sum[0] >> 26;
+        sum[2] += sum[1] >> 26;
+        sum[3] += sum[2] >> 26;
+        sum[4] += sum[3] >> 26;
+        const uint64_t h0 = (sum[0] & POLY1305_LIMB_MASK) + (sum[4] >> 26) * 5;
+        h[1] = (uint32_t)(sum[1] & POLY1305_LIMB_MASK) + (uint32_t)(h0 >> 26);
+        h[0] = (uint32_t)(h0 & POLY1305_LIMB_MASK);
+        h[2] = (uint32_t)(sum[2] & POLY1305_LIMB_MASK);
+        h[3] = (uint32_t)(sum[3] & POLY1305_LIMB_MASK);
+        h[4] = (uint32_t)(sum[4] & POLY1305_LIMB_MASK);
+    }
+    BlocksPortable(h, r, p, blocks, hibit);
+}
+#endif
+
+using BlocksFn = void (*)(uint32_t h[5], const uint32_t r[5][5], const uint8_t* p, size_t blocks, uint32_t hibit);
+
+static BlocksFn PickBlocks() {
+#if defined(POLY1305_X86)
+    if (GetCpuFeatures().avx2) return BlocksAvx2;
+#endif
+    return BlocksPortable;
+}
+
+// Picked on first use, like Sha256's kernel
+static void Blocks(uint32_t h[5], const uint32_t r[5][5], const uint8_t* p, size_t blocks, uint32_t hibit) {
+    static const BlocksFn blocksFn = PickBlocks();
+    blocksFn(h, r, p, blocks, hibit);
+}
+
+Poly1305::~Poly1305() {
+    volatile uint8_t* p = (volatile uint8_t*)this;
+    for (size_t n = sizeof(*this); n; --n) *p++ = 0;
+}
+
+void Poly1305::Reset(const uint8_t key[POLY1305_KEY_SIZE]) {
+    uint8_t k[POLY1305_KEY_SIZE] = {};
+    if (key) std::memcpy(k, key, POLY1305_KEY_SIZE);
+
+    // r with the RFC's clamping folded into the limb masks
+    mR[0][0] = LoadLE32(k) & 0x3ffffff;
+    mR[0][1] = (LoadLE32(k + 3) >> 2) & 0x3ffff03;
+    mR[0][2] = (LoadLE32(k + 6) >> 4) & 0x3ffc0ff;
+    mR[0][3] = (LoadLE32(k + 9) >> 6) & 0x3f03fff;
+    mR[0][4] = (LoadLE32(k + 12) >> 8) & 0x00fffff;
+    for (int i = 1; i < 4; ++i) {
+        std::memcpy(mR[i], mR[i - 1], sizeof(mR[i]));
+        MulMod(mR[i], mR[0]);
+    }
+    std::memcpy(mR[4], mR[3], sizeof(mR[4]));
+    MulMod(mR[4], mR[3]);
+    for (int i = 0; i < 4; ++i) mPad[i] = LoadLE32(k + 16 + 4 * i);
+    std::memset(mH, 0, sizeof(mH));
+    mFill = 0;
+}
+
+void Poly1305::Update(std::span<const std::byte> data) {
+    const uint8_t* p = (const uint8_t*)data.data();
+    size_t n = data.size();
+    if (mFill) {
+        const size_t take = std::min(n, POLY1305_BLOCK_SIZE - mFill);
+        std::memcpy(mBlock + mFill, p, take);
+        mFill += take;
+        p += take;
+        n -= take;
+        if (mFill < POLY1305_BLOCK_SIZE) return;
+        Blocks(mH, mR, mBlock, 1, POLY1305_HIBIT);
+        mFill = 0;
+    }
+    if (n >= POLY1305_BLOCK_SIZE) {
+        Blocks(mH, mR, p, n / POLY1305_BLOCK_SIZE, POLY1305_HIBIT);
+        p += n / POLY1305_BLOCK_SIZE * POLY1305_BLOCK_SIZE;
+        n %= POLY1305_BLOCK_SIZE;
+    }
+    std::memcpy(mBlock, p, n);
+    mFill = n;
+}
+
+void Poly1305::Pad() {
+    if (!mFill) return;
+    std::memset(mBlock + mFill, 0, POLY1305_BLOCK_SIZE - mFill);
+    Blocks(mH, mR, mBlock, 1, POLY1305_HIBIT);
+    mFill = 0;
+}
+
+Poly1305Tag Poly1305::Final() {
+    if (mFill) {
+        mBlock[mFill] = 1;
+        std::memset(mBlock + mFill + 1, 0, POLY1305_BLOCK_SIZE - mFill - 1);
+        Blocks(mH, mR, mBlock, 1, 0);
+        mFill = 0;
+    }
+
+    // Carry fully, then subtract p once if h >= p, without branching on h
+    uint32_t h0 = mH[0], h1 = mH[1], h2 = mH[2], h3 = mH[3], h4 = mH[4];
+    h2 += h1 >> 26; h1 &= POLY1305_LIMB_MASK;
+    h3 += h2 >> 26; h2 &= POLY1305_LIMB_MASK;
+    h4 += h3 >> 26; h3 &= POLY1305_LIMB_MASK;
+    h0 += (h4 >> 26) * 5; h4 &= POLY1305_LIMB_MASK;
+    h1 += h0 >> 26; h0 &= POLY1305_LIMB_MASK;
+
+    uint32_t g0 = h0 + 5;
+    uint32_t g1 = h1 + (g0 >> 26); g0 &= POLY1305_LIMB_MASK;
+    uint32_t g2 = h2 + (g1 >> 26); g1 &= POLY1305_LIMB_MASK;
+    uint32_t g3 = h3 + (g2 >> 26); g2 &= POLY1305_LIMB_MASK;
+    uint32_t g4 = h4 + (g3 >> 26) - (1u << 26); g3 &= POLY1305_LIMB_MASK;
+    const uint32_t useG = (g4 >> 31) - 1;   // all ones when h - p did not go negative
+    h0 = (h0 & ~useG) | (g0 & useG);
+    h1 = (h1 & ~useG) | (g1 & useG);
+    h2 = (h2 & ~useG) | (g2 & useG);
+    h3 = (h3 & ~useG) | (g3 & useG);
+    h4 = (h4 & ~useG) | (g4 & useG);
+
+    // tag = (h + s) mod 2^128
+    const uint32_t w[4] = { h0 | (h1 << 26), (h1 >> 6) | (h2 << 20), (h2 >> 12) | (h3 << 14), (h3 >> 18) | (h4 << 8) };
+    Poly1305Tag tag;
+    uint64_t f = 0;
+    for (int i = 0; i < 4; ++i) {
+        f = (uint64_t)w[i] + mPad[i] + (f >> 32);
+        StoreLE32(tag.data() + 4 * i, (uint32_t)f);
+    }
+    return tag;
+}
+
+Poly1305Tag Poly1305::Mac(const uint8_t key[POLY1305_KEY_SIZE], std::span<const std::byte> data) {
+    Poly1305 mac(key);
+    mac.Update(data);
+    return mac.Final();
+}
+
+bool Poly1305::Equal(const Poly1305Tag& a, const Poly1305Tag& b) {
+    uint8_t diff = 0;
+    for (size_t i = 0; i < POLY1305_TAG_SIZE; ++i) diff |= a[i] ^ b[i];
+    return diff == 0;
+}
@@ -0,0 +1,40 @@
+#ifndef POLY1305_HPP
+#define POLY1305_HPP
+
+#include "stdafx.h"
+#include <array>
+
+#define POLY1305_KEY_SIZE   32u
+#define POLY1305_TAG_SIZE   16u
+#define POLY1305_BLOCK_SIZE 16u
+
+using Poly1305Tag = std::array<uint8_t, POLY1305_TAG_SIZE>;
+
+// Poly1305 (RFC 8439 2.5), incremental, over a one-time key. The accumulator is kept in five
+// 26-bit limbs; long runs of blocks go eight at a time through AVX2 when the CPU has it -
+// four interleaved accumulators, each stepped by r^4 (two steps at once, by r^8), folded
+// back together with r^4..r^1 - and through the portable limb arithmetic otherwise. Both
+// give the same tag.
+class Poly1305 {
+public:
+    Poly1305() { Reset(nullptr); }
+    explicit Poly1305(const uint8_t key[POLY1305_KEY_SIZE]) { Reset(key); }
+    ~Poly1305();
+
+    void Reset(const uint8_t key[POLY1305_KEY_SIZE]);   // null: an all-zero key
+    void Update(std::span<const std::byte> data);
+    void Pad();            // zero-fills to the next block boundary (RFC 8439's pad16)
+    Poly1305Tag Final();   // Reset() before reusing the authenticator
+
+    static Poly1305Tag Mac(const uint8_t key[POLY1305_KEY_SIZE], std::span<const std::byte> data);
+    static bool Equal(const Poly1305Tag& a, const Poly1305Tag& b);   // in constant time
+
+private:
+    uint32_t mH[5];        // accumulator
+    uint32_t mR[5][5];     // r, r^2, r^3, r^4, r^8 (r clamped)
+    uint32_t mPad[4];      // s, added at the end
+    uint8_t  mBlock[POLY1305_BLOCK_SIZE];
+    size_t   mFill;
+};
+
+#endif
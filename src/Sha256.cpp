@@ -0,0 +1,164 @@
+#include "Sha256.hpp"
+#include "CpuFeatures.hpp"
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SHA256_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SHANI_TARGET
+#else
+#define SHANI_TARGET __attribute__((target("sha,sse4.1")))
+#endif
+#endif
+
+alignas(16) static const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t LoadBE32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return std::endian::native == std::endian::little ? std::byteswap(v) : v;
+}
+
+static void CompressPortable(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    for (; blocks; --blocks, data += SHA256_BLOCK_SIZE) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) w[i] = LoadBE32(data + 4 * i);
+        for (int i = 16; i < 64; ++i) {
+            const uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            const uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        for (int i = 0; i < 64; ++i) {
+            const uint32_t t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g))
+                              + kRoundConstants[i] + w[i];
+            const uint32_t t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            h = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+        state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+    }
+}
+
+#if defined(SHA256_X86)
+// sha256rnds2 works on the state as ABEF / CDGH halves and does two rounds per call; each
+// group of four message words is extended to the next with sha256msg1 / msg2.
+SHANI_TARGET static void CompressShaNi(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    const __m128i byteSwap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);   // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);   // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);       // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);            // CDGH
+
+    for (; blocks; --blocks, data += SHA256_BLOCK_SIZE) {
+        const __m128i abef = state0, cdgh = state1;
+        __m128i msg[4];
+        for (int i = 0; i < 4; ++i) msg[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16 * i)), byteSwap);
+        for (int i = 0; i < 16; ++i) {
+            __m128i words = _mm_add_epi32(msg[i & 3], _mm_load_si128((const __m128i*)&kRoundConstants[4 * i]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+            if (i < 12) {
+                // Words 4i+16 .. 4i+19, into the slot whose words were just consumed
+                __m128i next = _mm_sha256msg1_epu32(msg[i & 3], msg[(i + 1) & 3]);
+                next = _mm_add_epi32(next, _mm_alignr_epi8(msg[(i + 3) & 3], msg[(i + 2) & 3], 4));
+                msg[i & 3] = _mm_sha256msg2_epu32(next, msg[(i + 3) & 3]);
+            }
+            words = _mm_shuffle_epi32(words, 0x0E);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, words);
+        }
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1B);                  // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);               // DCHG
+    _mm_storeu_si128((__m128i*)&state[0], _mm_blend_epi16(tmp, state1, 0xF0));   // DCBA
+    _mm_storeu_si128((__m128i*)&state[4], _mm_alignr_epi8(state1, tmp, 8));      // HGFE
+}
+#endif
+
+using CompressFn = void (*)(uint32_t*, const uint8_t*, size_t);
+
+static CompressFn PicCompress() {
+#if defined(SHA256_X86)
+    if (GetCpuFeatures().sha && GetCpuFeatures().sse41) return CompressShaNi;
+#endif
+    return CompressPortable;
+}
+
+// Picked on first use rather than during static initialisation, so hashing from another
+// translation unit's static constructor is safe too
+static void Compress(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    static const CompressFn compress = PicCompress();
+    compress(state, data, blocks);
+}
+
+void Sha256::Reset() {
+    static const uint32_t initial[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    std::memcpy(mState, initial, sizeof(mState));
+    mFill = 0;
+    mLength = 0;
+}
+
+void Sha256::Update(std::span<const std::byte> data) {
+    const uint8_t* p = (const uint8_t*)data.data();
+    size_t n = data.size();
+    mLength += n;
+    if (mFill) {
+        const size_t take = std::min(n, SHA256_BLOCK_SIZE - mFill);
+        std::memcpy(mBlock + mFill, p, take);
+        mFill += take;
+        p += take;
+        n -= take;
+        if (mFill < SHA256_BLOCK_SIZE) return;
+        Compress(mState, mBlock, 1);
+        mFill = 0;
+    }
+    if (n >= SHA256_BLOCK_SIZE) {
+        Compress(mState, p, n / SHA256_BLOCK_SIZE);
+        p += n / SHA256_BLOCK_SIZE * SHA256_BLOCK_SIZE;
+        n %= SHA256_BLOCK_SIZE;
+    }
+    std::memcpy(mBlock, p, n);
+    mFill = n;
+}
+
+Sha256Digest Sha256::Final() {
+    const uint64_t bits = mLength * 8;
+    mBlock[mFill++] = 0x80;
+    if (mFill > SHA256_BLOCK_SIZE - 8) {
+        std::memset(mBlock + mFill, 0, SHA256_BLOCK_SIZE - mFill);
+        Compress(mState, mBlock, 1);
+        mFill = 0;
+    }
+    std::memset(mBlock + mFill, 0, SHA256_BLOCK_SIZE - 8 - mFill);
+    for (int i = 0; i < 8; ++i) mBlock[SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (8 * i));
+    Compress(mState, mBlock, 1);
+
+    Sha256Digest digest;
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < 4; ++j) digest[4 * i + j] = (uint8_t)(mState[i] >> (24 - 8 * j));
+    }
+    return digest;
+}
+
+Sha256Digest Sha256::Hash(std::span<const std::byte> data) {
+    Sha256 hasher;
+    hasher.Update(data);
+    return hasher.Final();
+}
@@ -0,0 +1,40 @@
+#ifndef SHA256_HPP
+#define SHA256_HPP
+
+#include "stdafx.h"
+#include <array>
+
+#define SHA256_DIGEST_SIZE 32
+#define SHA256_BLOCK_SIZE  64
+
+using Sha256Digest = std::array<uint8_t, SHA256_DIGEST_SIZE>;
+
+// SHA-256 (FIPS 180-4), incremental. Blocks go through the x86 SHA extensions when the CPU
+// has them, the portable rounds otherwise; both give the same digest.
+class Sha256 {
+public:
+    Sha256() { Reset(); }
+
+    void Reset();
+    void Update(std::span<const std::byte> data);
+    Sha256Digest Final();   // pads and returns the digest; Reset() before reusing the hasher
+
+    static Sha256Digest Hash(std::span<const std::byte> data);
+
+private:
+    uint32_t mState[8];
+    uint8_t  mBlock[SHA256_BLOCK_SIZE];
+    size_t   mFill;
+    uint64_t mLength;    // bytes hashed so far
+};
+
+// Hashing a digest for unordered containers: it is already uniformly distributed.
+struct Sha256DigestHash {
+    size_t operator()(const Sha256Digest& digest) const {
+        size_t h;
+        std::copy_n(digest.data(), sizeof(h), (uint8_t*)&h);
+        return h;
+    }
+};
+
+#endif
@@ -0,0 +1,127 @@
+#include "ThreadPool.hpp"
+
+// Index of the pool queue owned by the current thread (per pool), or SIZE_MAX off-pool
+static thread_local const ThreadPool* tCurrentPool = nullptr;
+static thread_local size_t tWorkerIndex = SIZE_MAX;
+
+ThreadPool::ThreadPool(size_t threads)
+: mPending(0), mNextQueue(0), mStopping(false) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    mQueues.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) mQueues.push_back(std::make_unique<Queue>());
+
+    mThreads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        mThreads.emplace_back([this, i] { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(mWakeLock);
+        mStopping = true;
+    }
+    mWake.notify_all();
+    for (std::thread& t : mThreads) t.join();
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    const size_t home = (tCurrentPool == this)
+        ? tWorkerIndex
+        : mNextQueue.fetch_add(1, std::memory_order_relaxed) % mQueues.size();
+    {
+        std::lock_guard<std::mutex> guard(mQueues[home]->lock);
+        mQueues[home]->tasks.push_back(std::move(task));
+    }
+    {
+        // Publish under the wake lock so a worker about to sleep cannot miss it
+        std::lock_guard<std::mutex> guard(mWakeLock);
+        mPending.fetch_add(1, std::memory_order_release);
+    }
+    mWake.notify_one();
+}
+
+bool ThreadPool::TryRunOne(size_t home) {
+    std::function<void()> task;
+    const size_t n = mQueues.size();
+
+    for (size_t k = 0; k < n && !task; ++k) {
+        const size_t q = (home + k) % n;
+        std::lock_guard<std::mutex> guard(mQueues[q]->lock);
+        auto& tasks = mQueues[q]->tasks;
+        if (tasks.empty()) continue;
+        if (k == 0) {
+            task = std::move(tasks.back());
+            tasks.pop_back();
+        } else {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    mPending.fetch_sub(1, std::memory_order_acq_rel);
+    task();
+    return true;
+}
+
+void ThreadPool::WorkerLoop(size_t index) {
+    tCurrentPool = this;
+    tWorkerIndex = index;
+
+    for (;;) {
+        if (TryRunOne(index)) continue;
+
+        std::unique_lock<std::mutex> guard(mWakeLock);
+        mWake.wait(guard, [this] { return mStopping || mPending.load(std::memory_order_acquire) != 0; });
+        if (mStopping && mPending.load(std::memory_order_acquire) == 0) return;
+    }
+}
+
+bool ThreadPool::IsWorkerThread() const {
+    return tCurrentPool == this;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& fn) {
+    if (count == 0) return;
+    if (count == 1) {
+        fn(0);
+        return;
+    }
+
+    // Shared so a finishing task can still signal after the caller has observed completion
+    struct Completion {
+        std::atomic<size_t>     remaining;
+        std::mutex              lock;
+        std::condition_variable done;
+    };
+    auto completion = std::make_shared<Completion>();
+    completion->remaining.store(count, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < count; ++i) {
+        Submit([completion, &fn, i] {
+            fn(i);
+            if (completion->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> guard(completion->lock);
+                completion->done.notify_all();
+            }
+        });
+    }
+
+    // Help instead of blocking; only sleep once there is nothing left to pick up
+    const size_t home = (tCurrentPool == this) ? tWorkerIndex : 0;
+    while (completion->remaining.load(std::memory_order_acquire) != 0) {
+        if (TryRunOne(home)) continue;
+        std::unique_lock<std::mutex> guard(completion->lock);
+        completion->done.wait_for(guard, std::chrono::milliseconds(1), [&] {
+            return completion->remaining.load(std::memory_order_acquire) == 0;
+        });
+    }
+}
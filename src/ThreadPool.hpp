@@ -0,0 +1,58 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include "stdafx.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its own work at
+// the back (LIFO, cache-warm) and, when empty, steals from the front of the other workers'
+// deques (FIFO, oldest and usually largest work first). Tasks submitted from outside the pool
+// are dealt round-robin across the deques.
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0);    // 0 = std::thread::hardware_concurrency()
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t ThreadCount() const { return mThreads.size(); }
+
+    // True on one of this pool's worker threads.
+    bool IsWorkerThread() const;
+
+    void Submit(std::function<void()> task);
+
+    // Runs fn(i) for every i in [0, count) and returns once all have finished. The calling
+    // thread executes tasks too, so this is safe to call from inside a pool task.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    // Process-wide pool sized to the machine, created on first use.
+    static ThreadPool& Shared();
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool TryRunOne(size_t home);                // own back first, then steal fronts
+    void WorkerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::vector<std::thread> mThreads;
+
+    std::mutex              mWakeLock;
+    std::condition_variable mWake;
+    std::atomic<size_t>     mPending;           // queued, not yet started
+    std::atomic<size_t>     mNextQueue;         // round-robin slot for external submits
+    bool                    mStopping;
+};
+
+#endif
@@ -10,12 +10,15 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QDir>
+#include <QProgressBar>
+#include <QPointer>
 #include <vector>
 #include "Cipher.h"
 #include "CopyCipher.h"
 #include "Mersenne.hpp"
 #include "ChaCha20Counter.hpp"
 #include "AESCounter.hpp"
+#include "PackTask.hpp"
 
 struct UI {
     // Window
@@ -43,6 +46,10 @@ struct UI {
     static constexpr int ActionButtonH = 40;
     static constexpr int RedSquareSize = 24;
 
+    // Progress
+    static constexpr int ProgressHeight = 20;
+    static constexpr int CancelButtonW = 90;
+
     // Style
     static constexpr int CornerRadius = 12;
 };
@@ -63,6 +70,14 @@ static void styleLine(QLineEdit* e) {
     );
 }
 
+static QString formatDuration(double seconds) {
+    if (seconds < 0.0) return "--";
+    const qint64 s = (qint64)(seconds + 0.5);
+    if (s >= 3600) return QString("%1h %2m").arg(s / 3600).arg((s % 3600) / 60);
+    if (s >= 60) return QString("%1m %2s").arg(s / 60).arg(s % 60);
+    return QString("%1s").arg(s);
+}
+
 static QString pickExistingFile(QWidget* parent) {
     return QFileDialog::getOpenFileName(parent, "Choose File", QDir::homePath());
 }
@@ -188,27 +203,78 @@ int main(int argc, char *argv[]) {
         if (!p.isEmpty()) r4.second.first->setText(p);
     });
 
-    // ---- Pack Up: QString -> unsigned char buffer -> QString ----
-    QObject::connect(packBtn, &QPushButton::clicked, &window, [&]{
-        // 1) read unicode string
-        const QString original = r1.second.first->text();
-
-        // 2) convert to a UTF-8 byte array, then to std::vector<unsigned char>
-        const QByteArray utf8 = original.toUtf8();
-        std::vector<unsigned char> buffer(utf8.begin(), utf8.end());
-
-        // (You now have an array of unsigned chars: buffer.data(), buffer.size())
-
-        // 3) convert back to QString (still treating bytes as UTF-8)
-        const QString roundTrip = QString::fromUtf8(reinterpret_cast<const char*>(buffer.data()),
-                                                    static_cast<int>(buffer.size()));
+    // ---- Progress row: bar, status, cancel ----
+    auto *progressRow = new QWidget;
+    auto *ph = new QHBoxLayout(progressRow);
+    ph->setContentsMargins(0,0,0,0);
+    ph->setSpacing(UI::RowSpacing);
+
+    auto *progressBar = new QProgressBar;
+    progressBar->setFixedHeight(UI::ProgressHeight);
+    progressBar->setRange(0, 1000);
+    progressBar->setValue(0);
+    progressBar->setTextVisible(false);
+    ph->addWidget(progressBar, 1);
+
+    auto *statusLabel = new QLabel("Idle");
+    ph->addWidget(statusLabel, 0, Qt::AlignVCenter);
+
+    auto *cancelBtn = new QPushButton("Cancel");
+    styleBlueButton(cancelBtn);
+    cancelBtn->setFixedSize(UI::CancelButtonW, UI::RightButtonH);
+    cancelBtn->setEnabled(false);
+    ph->addWidget(cancelBtn);
+
+    root->addWidget(progressRow);
+
+    // ---- Pack Up / Unpack: run on the thread pool, report back through queued signals ----
+    QPointer<PackTask> activeTask;
+
+    auto startTask = [&](PackTask::Kind kind, const QString& input, const QString& output) {
+        if (activeTask) return;
+        if (input.isEmpty() || output.isEmpty()) {
+            QMessageBox::warning(&window, "Missing Path", "Choose both an input and an output first.");
+            return;
+        }
+
+        auto *task = new PackTask(kind, input, output, &window);
+        activeTask = task;
+        packBtn->setEnabled(false);
+        unpackBtn->setEnabled(false);
+        cancelBtn->setEnabled(true);
+        progressBar->setValue(0);
+        statusLabel->setText(kind == PackTask::Kind::Pack ? "Packing..." : "Unpacking...");
+
+        QObject::connect(task, &PackTask::progress, &window,
+                         [&](qint64 done, qint64 total, double bytesPerSecond, double etaSeconds) {
+            progressBar->setValue(total > 0 ? (int)(done * 1000 / total) : 0);
+            statusLabel->setText(QString("%1 / %2 MB  %3 MB/s  ETA %4")
+                .arg(done / 1e6, 0, 'f', 1)
+                .arg(total / 1e6, 0, 'f', 1)
+                .arg(bytesPerSecond / 1e6, 0, 'f', 1)
+                .arg(formatDuration(etaSeconds)));
+        });
+        QObject::connect(task, &PackTask::finished, &window, [&, task](bool ok, const QString& message) {
+            packBtn->setEnabled(true);
+            unpackBtn->setEnabled(true);
+            cancelBtn->setEnabled(false);
+            activeTask = nullptr;
+            statusLabel->setText(ok ? "Done" : QString("Failed: %1").arg(message));
+            if (ok) progressBar->setValue(progressBar->maximum());
+            task->deleteLater();
+            if (ok) QMessageBox::information(&window, "Finished", QString("Wrote:\n%1").arg(message));
+        });
+        task->Start();
+    };
 
-        // 4) show confirmation
-        QMessageBox::information(&window, "Round Trip",
-            QString("Original:\n%1\n\nBytes: %2\n\nRound-trip:\n%3")
-                .arg(original)
-                .arg(buffer.size())
-                .arg(roundTrip));
+    QObject::connect(packBtn, &QPushButton::clicked, &window, [&]{
+        startTask(PackTask::Kind::Pack, r1.second.first->text(), r2.second.first->text());
+    });
+    QObject::connect(unpackBtn, &QPushButton::clicked, &window, [&]{
+        startTask(PackTask::Kind::Unpack, r3.second.first->text(), r4.second.first->text());
+    });
+    QObject::connect(cancelBtn, &QPushButton::clicked, &window, [&]{
+        if (activeTask) activeTask->Cancel();
     });
 
     window.show();
@@ -0,0 +1,226 @@
+#include "test_aes_counter.h"
+#include "AESCounter.hpp"
+#include <cstring>
+
+namespace {
+
+// FIPS-197 C.3 (AES-256). The plaintext's last 4 bytes become the injected counter.
+const uint8_t kFipsKey[32] = {
+    0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+    0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f
+};
+const uint8_t kFipsPlain[16] = {
+    0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,0x88,0x99,0xaa,0xbb,0xcc,0xdd,0xee,0xff
+};
+const uint8_t kFipsCipher[16] = {
+    0x8e,0xa2,0xb7,0xca,0x51,0x67,0x45,0xbf,0xea,0xfc,0x49,0x90,0x4b,0x49,0x60,0x89
+};
+
+std::vector<uint8_t> keystreamViaGet(AESCounter& aes, size_t words) {
+    std::vector<uint8_t> out(words * 4);
+    for (size_t i = 0; i < words; ++i) {
+        const uint32_t v = aes.Get();
+        std::memcpy(out.data() + 4 * i, &v, 4); // Get() is little-endian over the stream
+    }
+    return out;
+}
+
+} // namespace
+
+void AESCounterTest::fips197Vector() {
+    for (AESBackend backend : { AESBackend::Reference, AESBackend::TTable, AESBackend::Bitsliced }) {
+        AESCounter aes;
+        QVERIFY(aes.SetBackend(backend));
+        QVERIFY(aes.SeedKeyIV(kFipsKey, kFipsPlain, 0xccddeeffu));
+        const std::vector<uint8_t> block = keystreamViaGet(aes, 4);
+        QVERIFY(std::memcmp(block.data(), kFipsCipher, 16) == 0);
+    }
+}
+
+void AESCounterTest::ttableMatchesReference() {
+    uint8_t key[32], iv[16];
+    for (int v = 0; v < 8; ++v) {
+        for (int i = 0; i < 32; ++i) key[i] = (uint8_t)(v * 37 + i * 11);
+        for (int i = 0; i < 16; ++i) iv[i]  = (uint8_t)(v * 101 + i * 7);
+
+        AESCounter ref, fast;
+        QVERIFY(ref.SetBackend(AESBackend::Reference));
+        QVERIFY(fast.SetBackend(AESBackend::TTable));
+        QVERIFY(ref.SeedKeyIV(key, iv, 0xFFFFFFF0u + (uint32_t)v)); // crosses a 32-bit carry
+        QVERIFY(fast.SeedKeyIV(key, iv, 0xFFFFFFF0u + (uint32_t)v));
+        QCOMPARE(keystreamViaGet(fast, 1024), keystreamViaGet(ref, 1024));
+    }
+
+    // Seed() derives key/iv through EncryptBlock, so it must agree as well
+    const char phrase[] = "File Wizard Pro X";
+    AESCounter ref, fast;
+    ref.SetBackend(AESBackend::Reference);
+    fast.SetBackend(AESBackend::TTable);
+    ref.Seed((const uint8_t*)phrase, sizeof(phrase));
+    fast.Seed((const uint8_t*)phrase, sizeof(phrase));
+    QCOMPARE(keystreamViaGet(fast, 256), keystreamViaGet(ref, 256));
+}
+
+void AESCounterTest::bulkMatchesGet() {
+    AESCounter ref;
+    ref.SeedKeyIV(kFipsKey, kFipsPlain, 1);
+    const std::vector<uint8_t> expected = keystreamViaGet(ref, 1000);
+
+    // Odd-sized Generate() calls interleaved with Get()
+    AESCounter aes;
+    aes.SeedKeyIV(kFipsKey, kFipsPlain, 1);
+    std::vector<std::byte> got(expected.size());
+    const size_t steps[] = { 3, 1, 17, 200, 129, 5, 1000 };
+    size_t pos = 0;
+    for (size_t i = 0; pos + 4 <= got.size(); ++i) {
+        if (i % 3 == 2) {
+            const uint32_t v = aes.Get();
+            std::memcpy(got.data() + pos, &v, 4);
+            pos += 4;
+        } else {
+            const size_t n = std::min(steps[i % 7], got.size() - pos);
+            aes.Generate(std::span<std::byte>(got.data() + pos, n));
+            pos += n;
+        }
+    }
+    QVERIFY(std::memcmp(got.data(), expected.data(), pos) == 0);
+
+    // In-place XorKeystream over zeros yields the keystream itself
+    AESCounter x;
+    x.SeedKeyIV(kFipsKey, kFipsPlain, 1);
+    std::vector<std::byte> buf(expected.size() - 3, std::byte{0});
+    x.XorKeystream(buf, buf.data());
+    QVERIFY(std::memcmp(buf.data(), expected.data(), buf.size()) == 0);
+}
+
+void AESCounterTest::bulkSplitsMatchGet() {
+    AESCounter ref;
+    ref.SeedKeyIV(kFipsKey, kFipsPlain, 7);
+    const std::vector<uint8_t> expected = keystreamViaGet(ref, 1024);
+
+    // Every split point through the first few lockstep groups: Generate() up to it, one Get(),
+    // then XorKeystream() over non-zero bytes at an unaligned destination, then the rest bulk
+    std::vector<std::byte> plain(600), scratch(plain.size() + 1);
+    for (size_t i = 0; i < plain.size(); ++i) plain[i] = std::byte((uint8_t)(i * 29 + 3));
+    for (size_t first = 0; first <= 300; ++first) {
+        AESCounter aes;
+        aes.SeedKeyIV(kFipsKey, kFipsPlain, 7);
+        std::vector<std::byte> got(expected.size());
+        aes.Generate(std::span<std::byte>(got.data(), first));
+        size_t pos = first;
+        const uint32_t v = aes.Get();
+        std::memcpy(got.data() + pos, &v, 4);
+        pos += 4;
+
+        const size_t n = 517;
+        std::byte* dst = scratch.data() + 1;
+        aes.XorKeystream(std::span<const std::byte>(plain).first(n), dst);
+        for (size_t i = 0; i < n; ++i) got[pos + i] = dst[i] ^ plain[i];
+        pos += n;
+
+        aes.Generate(std::span<std::byte>(got.data() + pos, got.size() - pos));
+        QVERIFY(std::memcmp(got.data(), expected.data(), got.size()) == 0);
+    }
+}
+
+void AESCounterTest::hardwareMatchesReference() {
+    uint8_t key[32], iv[16];
+    for (int i = 0; i < 32; ++i) key[i] = (uint8_t)(0xA5 ^ (i * 29));
+    for (int i = 0; i < 16; ++i) iv[i]  = (uint8_t)(0x3C + i);
+    iv[8] = 0xFF; // carry out of the low 64 bits of the counter within the run
+
+    AESCounter ref;
+    ref.SetBackend(AESBackend::Reference);
+    ref.SeedKeyIV(key, iv, 0xFFFFFFF8u);
+    const std::vector<uint8_t> expected = keystreamViaGet(ref, 4096);
+
+    for (AESBackend backend : { AESBackend::AESNI, AESBackend::VAES }) {
+        AESCounter hw;
+        if (!hw.SetBackend(backend)) continue; // not available on this CPU
+        hw.SeedKeyIV(key, iv, 0xFFFFFFF8u);
+
+        // Unaligned bulk sizes exercise the 16-block, 8-block and tail paths
+        std::vector<std::byte> got(expected.size());
+        size_t pos = 0;
+        for (size_t n : { size_t(5), size_t(16 * 16 + 3), size_t(16 * 7), size_t(4000) }) {
+            hw.Generate(std::span<std::byte>(got.data() + pos, n));
+            pos += n;
+        }
+        hw.Generate(std::span<std::byte>(got.data() + pos, got.size() - pos));
+        QVERIFY(std::memcmp(got.data(), expected.data(), got.size()) == 0);
+
+        // Seed() runs the key schedule through the hardware expansion
+        const char phrase[] = "pack";
+        AESCounter a, b;
+        a.SetBackend(AESBackend::Reference);
+        b.SetBackend(backend);
+        a.Seed((const uint8_t*)phrase, sizeof(phrase));
+        b.Seed((const uint8_t*)phrase, sizeof(phrase));
+        QCOMPARE(keystreamViaGet(b, 64), keystreamViaGet(a, 64));
+    }
+}
+
+void AESCounterTest::bitslicedMatchesReference() {
+    uint8_t key[32], iv[16];
+    for (int v = 0; v < 4; ++v) {
+        for (int i = 0; i < 32; ++i) key[i] = (uint8_t)(v * 59 + i * 13 + 1);
+        for (int i = 0; i < 16; ++i) iv[i]  = (uint8_t)(v * 17 + i);
+
+        AESCounter ref, bs;
+        QVERIFY(ref.SetBackend(AESBackend::Reference));
+        QVERIFY(bs.SetBackend(AESBackend::Bitsliced));
+        ref.SeedKeyIV(key, iv, (uint32_t)v);
+        bs.SeedKeyIV(key, iv, (uint32_t)v);
+        const std::vector<uint8_t> expected = keystreamViaGet(ref, 2048);
+
+        // Partial batches (1..7 blocks) as well as full 8-block groups
+        std::vector<std::byte> got(expected.size());
+        size_t pos = 0;
+        for (size_t n : { size_t(16), size_t(48), size_t(112), size_t(128 * 5 + 7) }) {
+            bs.Generate(std::span<std::byte>(got.data() + pos, n));
+            pos += n;
+        }
+        bs.Generate(std::span<std::byte>(got.data() + pos, got.size() - pos));
+        QVERIFY(std::memcmp(got.data(), expected.data(), got.size()) == 0);
+    }
+
+    // The circuit-based key schedule (Seed() -> ExpandKey256) matches the table one
+    const char phrase[] = "constant time";
+    AESCounter a, b;
+    a.SetBackend(AESBackend::Reference);
+    b.SetBackend(AESBackend::Bitsliced);
+    a.Seed((const uint8_t*)phrase, sizeof(phrase));
+    b.Seed((const uint8_t*)phrase, sizeof(phrase));
+    QCOMPARE(keystreamViaGet(b, 64), keystreamViaGet(a, 64));
+}
+
+void AESCounterTest::seekMatchesSequential() {
+    AESCounter ref;
+    ref.SeedKeyIV(kFipsKey, kFipsPlain, 0xFFFFFFFEu); // seeks cross the 32-bit counter boundary
+    const std::vector<uint8_t> expected = keystreamViaGet(ref, 2048);
+
+    for (AESBackend backend : { AESBackend::TTable, AESBackend::Bitsliced, AESBackend::Auto }) {
+        AESCounter aes;
+        QVERIFY(aes.SetBackend(backend));
+        aes.SeedKeyIV(kFipsKey, kFipsPlain, 0xFFFFFFFEu);
+        QCOMPARE(aes.Tell(), uint64_t(0));
+
+        for (uint64_t off : { uint64_t(5000), uint64_t(0), uint64_t(17), uint64_t(64), uint64_t(4093), uint64_t(777) }) {
+            aes.Seek(off);
+            QCOMPARE(aes.Tell(), off);
+            std::vector<std::byte> got(200);
+            aes.Generate(got);
+            QVERIFY(std::memcmp(got.data(), expected.data() + off, got.size()) == 0);
+            QCOMPARE(aes.Tell(), off + got.size());
+        }
+
+        // Get() after a word-aligned Seek
+        aes.Seek(4 * 301);
+        uint32_t w;
+        std::memcpy(&w, expected.data() + 4 * 301, 4);
+        QCOMPARE(aes.Get(), w);
+        QCOMPARE(aes.Tell(), uint64_t(4 * 302));
+    }
+}
+
+QTEST_APPLESS_MAIN(AESCounterTest)
@@ -0,0 +1,14 @@
+#pragma once
+#include <QtTest/QtTest>
+
+class AESCounterTest : public QObject {
+    Q_OBJECT
+private slots:
+    void fips197Vector();
+    void ttableMatchesReference();
+    void bulkMatchesGet();
+    void bulkSplitsMatchGet();
+    void hardwareMatchesReference();
+    void bitslicedMatchesReference();
+    void seekMatchesSequential();
+};
@@ -0,0 +1,223 @@
+#include "test_chacha20_counter.h"
+#include "ChaCha20Counter.hpp"
+#include "ChaCha20Poly1305Cipher.h"
+#include <cstring>
+
+namespace {
+
+uint8_t kKey[32] = {
+    0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,0x08,0x09,0x0a,0x0b,0x0c,0x0d,0x0e,0x0f,
+    0x10,0x11,0x12,0x13,0x14,0x15,0x16,0x17,0x18,0x19,0x1a,0x1b,0x1c,0x1d,0x1e,0x1f
+};
+
+std::vector<uint8_t> keystreamViaGet(ChaCha20Counter& cc, size_t words) {
+    std::vector<uint8_t> out(words * 4);
+    for (size_t i = 0; i < words; ++i) {
+        const uint32_t v = cc.Get();
+        std::memcpy(out.data() + 4 * i, &v, 4);
+    }
+    return out;
+}
+
+} // namespace
+
+void ChaCha20CounterTest::rfc8439BlockFunction() {
+    // RFC 8439 2.3.2
+    const uint8_t nonce[12] = { 0x00,0x00,0x00,0x09, 0x00,0x00,0x00,0x4a, 0x00,0x00,0x00,0x00 };
+    const uint8_t expected[64] = {
+        0x10,0xf1,0xe7,0xe4,0xd1,0x3b,0x59,0x15,0x50,0x0f,0xdd,0x1f,0xa3,0x20,0x71,0xc4,
+        0xc7,0xd1,0xf4,0xc7,0x33,0xc0,0x68,0x03,0x04,0x22,0xaa,0x9a,0xc3,0xd4,0x6c,0x4e,
+        0xd2,0x82,0x64,0x46,0x07,0x9f,0xaa,0x09,0x14,0xc2,0xd7,0x05,0xd9,0x8b,0x02,0xa2,
+        0xb5,0x12,0x9c,0xd1,0xde,0x16,0x4e,0xb9,0xcb,0xd0,0x83,0xe8,0xa2,0x50,0x3c,0x4e
+    };
+    ChaCha20Counter cc;
+    QVERIFY(cc.SeedKeyNonce(kKey, nonce, 1));
+    const std::vector<uint8_t> block = keystreamViaGet(cc, 16);
+    QVERIFY(std::memcmp(block.data(), expected, 64) == 0);
+}
+
+void ChaCha20CounterTest::rfc8439Encryption() {
+    // RFC 8439 2.4.2 (first 64 bytes of the ciphertext)
+    const uint8_t nonce[12] = { 0x00,0x00,0x00,0x00, 0x00,0x00,0x00,0x4a, 0x00,0x00,0x00,0x00 };
+    const char plaintext[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip "
+                             "for the future, sunscreen would be it.";
+    const uint8_t expected[64] = {
+        0x6e,0x2e,0x35,0x9a,0x25,0x68,0xf9,0x80,0x41,0xba,0x07,0x28,0xdd,0x0d,0x69,0x81,
+        0xe9,0x7e,0x7a,0xec,0x1d,0x43,0x60,0xc2,0x0a,0x27,0xaf,0xcc,0xfd,0x9f,0xae,0x0b,
+        0xf9,0x1b,0x65,0xc5,0x52,0x47,0x33,0xab,0x8f,0x59,0x3d,0xab,0xcd,0x62,0xb3,0x57,
+        0x16,0x39,0xd6,0x24,0xe6,0x51,0x52,0xab,0x8f,0x53,0x0c,0x35,0x9f,0x08,0x61,0xd8
+    };
+    const size_t len = sizeof(plaintext) - 1;
+    for (ChaChaBackend backend : { ChaChaBackend::Scalar, ChaChaBackend::Auto }) {
+        ChaCha20Counter cc;
+        QVERIFY(cc.SetBackend(backend));
+        cc.SeedKeyNonce(kKey, nonce, 1);
+        std::vector<std::byte> ct(len);
+        cc.XorKeystream(std::span<const std::byte>((const std::byte*)plaintext, len), ct.data());
+        QVERIFY(std::memcmp(ct.data(), expected, sizeof(expected)) == 0);
+    }
+}
+
+void ChaCha20CounterTest::simdMatchesScalar() {
+    uint8_t nonce[12];
+    for (int i = 0; i < 12; ++i) nonce[i] = (uint8_t)(0x40 + i);
+
+    // Start just below 2^32 so every kernel wraps the 32-bit block counter mid-group
+    const uint32_t start = 0xFFFFFFF3u;
+    ChaCha20Counter ref;
+    ref.SeedKeyNonce(kKey, nonce, start);
+    const std::vector<uint8_t> expected = keystreamViaGet(ref, 64 * 16 * 3 / 4 + 16 * 5);
+
+    for (ChaChaBackend backend : { ChaChaBackend::Scalar, ChaChaBackend::SSE2,
+                                   ChaChaBackend::AVX2, ChaChaBackend::AVX512 }) {
+        ChaCha20Counter cc;
+        if (!cc.SetBackend(backend)) continue; // not available on this CPU
+        cc.SeedKeyNonce(kKey, nonce, start);
+
+        std::vector<std::byte> got(expected.size());
+        size_t pos = 0;
+        for (size_t n : { size_t(7), size_t(64 * 4), size_t(64 * 8 + 1), size_t(64 * 16 + 63) }) {
+            cc.Generate(std::span<std::byte>(got.data() + pos, n));
+            pos += n;
+        }
+        cc.Generate(std::span<std::byte>(got.data() + pos, got.size() - pos));
+        QVERIFY(std::memcmp(got.data(), expected.data(), got.size()) == 0);
+    }
+}
+
+void ChaCha20CounterTest::bulkMatchesGet() {
+    const char seed[] = "File Wizard Pro X";
+    ChaCha20Counter ref;
+    ref.Seed((const uint8_t*)seed, sizeof(seed));
+    const std::vector<uint8_t> expected = keystreamViaGet(ref, 2000);
+
+    ChaCha20Counter cc;
+    cc.Seed((const uint8_t*)seed, sizeof(seed));
+    std::vector<std::byte> got(expected.size());
+    const size_t steps[] = { 3, 1, 130, 1024, 5, 513, 2 };
+    size_t pos = 0;
+    for (size_t i = 0; pos + 4 <= got.size(); ++i) {
+        if (i % 3 == 2) {
+            const uint32_t v = cc.Get();
+            std::memcpy(got.data() + pos, &v, 4);
+            pos += 4;
+        } else {
+            const size_t n = std::min(steps[i % 7], got.size() - pos);
+            cc.Generate(std::span<std::byte>(got.data() + pos, n));
+            pos += n;
+        }
+    }
+    QVERIFY(std::memcmp(got.data(), expected.data(), pos) == 0);
+}
+
+void ChaCha20CounterTest::seekMatchesSequential() {
+    const uint8_t nonce[12] = { 1,2,3,4,5,6,7,8,9,10,11,12 };
+    ChaCha20Counter ref;
+    ref.SeedKeyNonce(kKey, nonce, 0xFFFFFFF0u); // seeks cross the 32-bit counter wrap
+    const std::vector<uint8_t> expected = keystreamViaGet(ref, 4096);
+
+    for (ChaChaBackend backend : { ChaChaBackend::Scalar, ChaChaBackend::Auto }) {
+        ChaCha20Counter cc;
+        QVERIFY(cc.SetBackend(backend));
+        cc.SeedKeyNonce(kKey, nonce, 0xFFFFFFF0u);
+        QCOMPARE(cc.Tell(), uint64_t(0));
+
+        for (uint64_t off : { uint64_t(9000), uint64_t(0), uint64_t(63), uint64_t(64), uint64_t(1025), uint64_t(15000) }) {
+            cc.Seek(off);
+            QCOMPARE(cc.Tell(), off);
+            std::vector<std::byte> got(1100);
+            cc.Generate(got);
+            QVERIFY(std::memcmp(got.data(), expected.data() + off, got.size()) == 0);
+            QCOMPARE(cc.Tell(), off + got.size());
+        }
+
+        cc.Seek(4 * 1000);
+        uint32_t w;
+        std::memcpy(&w, expected.data() + 4 * 1000, 4);
+        QCOMPARE(cc.Get(), w);
+        QCOMPARE(cc.Tell(), uint64_t(4 * 1001));
+    }
+}
+
+void ChaCha20CounterTest::poly1305MatchesRfc8439() {
+    // RFC 8439 2.5.2
+    const uint8_t key[32] = {
+        0x85,0xd6,0xbe,0x78,0x57,0x55,0x6d,0x33,0x7f,0x44,0x52,0xfe,0x42,0xd5,0x06,0xa8,
+        0x01,0x03,0x80,0x8a,0xfb,0x0d,0xb2,0xfd,0x4a,0xbf,0xf6,0xaf,0x41,0x49,0xf5,0x1b
+    };
+    const char message[] = "Cryptographic Forum Research Group";
+    const Poly1305Tag expected = {
+        0xa8,0x06,0x1d,0xc1,0x30,0x51,0x36,0xc6,0xc2,0x2b,0x8b,0xaf,0x0c,0x01,0x27,0xa9
+    };
+    QVERIFY(Poly1305::Mac(key, std::as_bytes(std::span<const char>(message, sizeof(message) - 1))) == expected);
+
+    // Fed a byte at a time every block goes through the one-block path; in one call, long
+    // runs take the four-way (AVX2) path where the CPU has it
+    std::vector<std::byte> data(5000);
+    for (size_t i = 0; i < data.size(); ++i) data[i] = std::byte(i * 131 + (i >> 7));
+    for (size_t size : { 0, 1, 16, 63, 64, 255, 256, 257, 1000, 4999, 5000 }) {
+        Poly1305 bytewise(key);
+        for (size_t i = 0; i < size; ++i) bytewise.Update(std::span<const std::byte>(&data[i], 1));
+        QVERIFY(Poly1305::Mac(key, std::span<const std::byte>(data).first(size)) == bytewise.Final());
+    }
+}
+
+void ChaCha20CounterTest::aeadMatchesRfc8439() {
+    // RFC 8439 2.8.2
+    uint8_t key[32];
+    for (int i = 0; i < 32; ++i) key[i] = (uint8_t)(0x80 + i);
+    const uint8_t nonce[12] = { 0x07,0x00,0x00,0x00, 0x40,0x41,0x42,0x43,0x44,0x45,0x46,0x47 };
+    const uint8_t aad[12] = { 0x50,0x51,0x52,0x53,0xc0,0xc1,0xc2,0xc3,0xc4,0xc5,0xc6,0xc7 };
+    const char plaintext[] = "Ladies and Gentlemen of the class of '99: If I could offer you only one tip "
+                             "for the future, sunscreen would be it.";
+    const uint8_t expected[114] = {
+        0xd3,0x1a,0x8d,0x34,0x64,0x8e,0x60,0xdb,0x7b,0x86,0xaf,0xbc,0x53,0xef,0x7e,0xc2,
+        0xa4,0xad,0xed,0x51,0x29,0x6e,0x08,0xfe,0xa9,0xe2,0xb5,0xa7,0x36,0xee,0x62,0xd6,
+        0x3d,0xbe,0xa4,0x5e,0x8c,0xa9,0x67,0x12,0x82,0xfa,0xfb,0x69,0xda,0x92,0x72,0x8b,
+        0x1a,0x71,0xde,0x0a,0x9e,0x06,0x0b,0x29,0x05,0xd6,0xa5,0xb6,0x7e,0xcd,0x3b,0x36,
+        0x92,0xdd,0xbd,0x7f,0x2d,0x77,0x8b,0x8c,0x98,0x03,0xae,0xe3,0x28,0x09,0x1b,0x58,
+        0xfa,0xb3,0x24,0xe4,0xfa,0xd6,0x75,0x94,0x55,0x85,0x80,0x8b,0x48,0x31,0xd7,0xbc,
+        0x3f,0xf4,0xde,0xf0,0x8e,0x4b,0x7a,0x9d,0xe5,0x76,0xd2,0x65,0x86,0xce,0xc6,0x4b,
+        0x61,0x16
+    };
+    const Poly1305Tag expectedTag = {
+        0x1a,0xe1,0x0b,0x59,0x4f,0x09,0xe2,0x6a,0x7e,0x90,0x2e,0xcb,0xd0,0x60,0x06,0x91
+    };
+    const size_t len = sizeof(plaintext) - 1;
+    QCOMPARE(len, sizeof(expected));
+
+    // Sealed in two uneven calls, as a stream would be
+    ChaCha20Poly1305Cipher sealer(key, nonce);
+    std::vector<std::byte> ct(len);
+    const auto pt = std::as_bytes(std::span<const char>(plaintext, len));
+    QVERIFY(sealer.aad(std::as_bytes(std::span<const uint8_t>(aad))).has_value());
+    QVERIFY(sealer.encrypt(pt.first(50), ct.data()).has_value());
+    QVERIFY(sealer.encrypt(pt.subspan(50), ct.data() + 50).has_value());
+    QVERIFY(std::memcmp(ct.data(), expected, len) == 0);
+    QVERIFY(sealer.tag() == expectedTag);
+    QCOMPARE(sealer.aad(std::as_bytes(std::span<const uint8_t>(aad))).error(), ChaCha20Poly1305Error::AadAfterText);
+
+    // Opened in place; one flipped bit anywhere fails the tag
+    ChaCha20Poly1305Cipher opener(key, nonce);
+    QVERIFY(opener.aad(std::as_bytes(std::span<const uint8_t>(aad))).has_value());
+    std::vector<std::byte> buffer = ct;
+    QVERIFY(opener.decrypt(buffer, buffer.data()).has_value());
+    QVERIFY(opener.verify(expectedTag));
+    QVERIFY(std::memcmp(buffer.data(), plaintext, len) == 0);
+
+    opener.restart(0);
+    QVERIFY(opener.aad(std::as_bytes(std::span<const uint8_t>(aad))).has_value());
+    buffer = ct;
+    buffer[77] ^= std::byte{ 0x10 };
+    QVERIFY(opener.decrypt(buffer, buffer.data()).has_value());
+    QVERIFY(!opener.verify(expectedTag));
+
+    // Another sequence number is another nonce
+    sealer.restart(1);
+    QVERIFY(sealer.aad(std::as_bytes(std::span<const uint8_t>(aad))).has_value());
+    QVERIFY(sealer.encrypt(pt, ct.data()).has_value());
+    QVERIFY(std::memcmp(ct.data(), expected, len) != 0);
+    QVERIFY(!(sealer.tag() == expectedTag));
+}
+
+QTEST_APPLESS_MAIN(ChaCha20CounterTest)
@@ -0,0 +1,14 @@
+#pragma once
+#include <QtTest/QtTest>
+
+class ChaCha20CounterTest : public QObject {
+    Q_OBJECT
+private slots:
+    void rfc8439BlockFunction();
+    void rfc8439Encryption();
+    void simdMatchesScalar();
+    void bulkMatchesGet();
+    void seekMatchesSequential();
+    void poly1305MatchesRfc8439();
+    void aeadMatchesRfc8439();
+};
@@ -0,0 +1,104 @@
+#include "test_mersenne.h"
+#include "Mersenne.hpp"
+#include "MersenneSIMD.hpp"
+#include "CpuFeatures.hpp"
+#include <cstring>
+
+namespace {
+
+// Textbook MT19937 twist, kept deliberately naive as the oracle
+void twistReference(uint32_t mt[MERSENNE_N]) {
+    for (uint32_t i = 0; i < MERSENNE_N; ++i) {
+        const uint32_t x = (mt[i] & MERSENNE_UPPER_MASK) | (mt[(i + 1) % MERSENNE_N] & MERSENNE_LOWER_MASK);
+        uint32_t xA = x >> 1;
+        if (x & 1u) xA ^= MERSENNE_MATRIX_A;
+        mt[i] = mt[(i + MERSENNE_M) % MERSENNE_N] ^ xA;
+    }
+}
+
+} // namespace
+
+void MersenneTest::referenceSequence() {
+    // Published MT19937 checks: first output for the default seed 5489, and the 10000th
+    Mersenne mt;
+    QCOMPARE(mt.Get(), 3499211612u);
+    for (int i = 2; i < 10000; ++i) mt.Get();
+    QCOMPARE(mt.Get(), 4123659995u);
+}
+
+void MersenneTest::simdTwistMatchesScalar() {
+    const CpuFeatures& cpu = GetCpuFeatures();
+    if (!cpu.avx2) QSKIP("no AVX2");
+
+    uint32_t reference[MERSENNE_N], avx2[MERSENNE_N], avx512[MERSENNE_N];
+    for (uint32_t i = 0; i < MERSENNE_N; ++i) reference[i] = 0x9E3779B9u * (i + 1) ^ (i << 17);
+    std::memcpy(avx2, reference, sizeof(reference));
+    std::memcpy(avx512, reference, sizeof(reference));
+
+    for (int round = 0; round < 4; ++round) {
+        twistReference(reference);
+        MersenneTwistAVX2(avx2);
+        QVERIFY(std::memcmp(reference, avx2, sizeof(reference)) == 0);
+        if (cpu.avx512f) {
+            MersenneTwistAVX512(avx512);
+            QVERIFY(std::memcmp(reference, avx512, sizeof(reference)) == 0);
+        }
+    }
+}
+
+void MersenneTest::fillMatchesGet() {
+    Mersenne a(1234u), b(1234u);
+    std::vector<uint32_t> expected(5000), actual(5000);
+    for (auto& v : expected) v = a.Get();
+
+    // Odd split points cross twist boundaries and leave vector remainders
+    b.Get();
+    actual[0] = expected[0];
+    b.Fill(std::span<uint32_t>(actual).subspan(1, 1247));
+    b.Fill(std::span<uint32_t>(actual).subspan(1248, 3));
+    b.Fill(std::span<uint32_t>(actual).subspan(1251));
+    QVERIFY(actual == expected);
+
+    // Get() carries on from where Fill() stopped
+    QCOMPARE(b.Get(), a.Get());
+}
+
+void MersenneTest::jumpMatchesSequential() {
+    // Start mid-block, at a block edge and right after seeding (index == N)
+    for (int consumed : { 0, 1, 623, 624, 1000 }) {
+        for (uint32_t log2Steps : { 0u, 3u, 10u, 13u }) {
+            Mersenne walked(42u), jumped(42u);
+            for (int i = 0; i < consumed; ++i) { walked.Get(); jumped.Get(); }
+            for (uint32_t i = 0; i < (1u << log2Steps); ++i) walked.Get();
+            jumped.Jump(log2Steps);
+            for (int i = 0; i < 2000; ++i) QCOMPARE(jumped.Get(), walked.Get());
+        }
+    }
+}
+
+void MersenneTest::jumpsCompose() {
+    // 2^100 + 2^100 = 2^101, and the polynomial is irreducible so 2^19937 steps act like 2^0
+    Mersenne twice(7u), once(7u);
+    twice.Jump(100);
+    twice.Jump(100);
+    once.Jump(101);
+    for (int i = 0; i < 1000; ++i) QCOMPARE(twice.Get(), once.Get());
+
+    Mersenne wrapped(7u), single(7u);
+    wrapped.Jump(19937);
+    single.Jump(0);
+    for (int i = 0; i < 1000; ++i) QCOMPARE(wrapped.Get(), single.Get());
+}
+
+void MersenneTest::splitStreamsAreContiguous() {
+    Mersenne source(99u), walked(99u);
+    source.Get();
+    walked.Get();
+    std::vector<Mersenne> streams = source.Split(3, 12);
+    QCOMPARE(streams.size(), size_t(3));
+    for (size_t s = 0; s < streams.size(); ++s) {
+        for (int i = 0; i < 4096; ++i) QCOMPARE(streams[s].Get(), walked.Get());
+    }
+}
+
+QTEST_APPLESS_MAIN(MersenneTest)
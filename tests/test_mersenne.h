@@ -0,0 +1,13 @@
+#pragma once
+#include <QtTest/QtTest>
+
+class MersenneTest : public QObject {
+    Q_OBJECT
+private slots:
+    void referenceSequence();
+    void simdTwistMatchesScalar();
+    void fillMatchesGet();
+    void jumpMatchesSequential();
+    void jumpsCompose();
+    void splitStreamsAreContiguous();
+};
@@ -0,0 +1,378 @@
+#include "test_pack_engine.h"
+#include "PackEngine.hpp"
+#include "DirectoryWalker.hpp"
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Fresh scratch directory per test, removed on scope exit
+struct ScratchDir {
+    fs::path path;
+    explicit ScratchDir(const char* name) : path(fs::temp_directory_path() / name) {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~ScratchDir() { std::error_code ec; fs::remove_all(path, ec); }
+};
+
+std::vector<char> writePattern(const fs::path& file, size_t size) {
+    std::vector<char> data(size);
+    for (size_t i = 0; i < size; ++i) data[i] = (char)(i * 31 + (i >> 9));
+    std::ofstream(file, std::ios::binary).write(data.data(), (std::streamsize)size);
+    return data;
+}
+
+std::vector<char> readAll(const fs::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+} // namespace
+
+void PackEngineTest::roundTrip() {
+    ScratchDir dir("hello-qt-pack-roundtrip");
+    fs::create_directories(dir.path / "packed");
+    fs::create_directories(dir.path / "restored");
+    const auto original = writePattern(dir.path / "data.bin", 3 * PACK_ENGINE_CHUNK + 12345);
+
+    PackEngine engine;
+    const auto packed = engine.Pack((dir.path / "data.bin").string(), (dir.path / "packed").string());
+    QVERIFY(packed.has_value());
+    QVERIFY(fs::exists(*packed));
+
+    // The payload is encrypted on disk
+    QVERIFY(readAll(*packed) != original);
+
+    const auto restored = engine.Unpack(*packed, (dir.path / "restored").string());
+    QVERIFY(restored.has_value());
+    QVERIFY(readAll(dir.path / "restored" / "data.bin") == original);
+}
+
+void PackEngineTest::reportsProgress() {
+    ScratchDir dir("hello-qt-pack-progress");
+    const size_t size = 2 * PACK_ENGINE_CHUNK + 1;
+    writePattern(dir.path / "data.bin", size);
+
+    std::vector<PackProgress> reports;
+    PackEngine engine;
+    engine.SetProgressCallback([&](const PackProgress& p) { reports.push_back(p); });
+    QVERIFY(engine.Pack((dir.path / "data.bin").string(), dir.path.string()).has_value());
+
+    // One report up front, one per chunk, monotonic, ending at the total
+    QCOMPARE(reports.size(), size_t(4));
+    QCOMPARE(reports.front().bytesDone, uint64_t(0));
+    for (size_t i = 1; i < reports.size(); ++i) QVERIFY(reports[i].bytesDone > reports[i - 1].bytesDone);
+    QCOMPARE(reports.back().bytesDone, uint64_t(size));
+    QCOMPARE(reports.back().bytesTotal, uint64_t(size));
+    QCOMPARE(reports.back().EtaSeconds(), 0.0);
+}
+
+void PackEngineTest::cancelRemovesOutput() {
+    ScratchDir dir("hello-qt-pack-cancel");
+    writePattern(dir.path / "data.bin", 4 * PACK_ENGINE_CHUNK);
+
+    // Cancel from inside the job, as the GUI thread would mid-run
+    PackEngine engine;
+    engine.SetProgressCallback([&](const PackProgress& p) {
+        if (p.bytesDone >= PACK_ENGINE_CHUNK) engine.Cancel();
+    });
+    const auto packed = engine.Pack((dir.path / "data.bin").string(), dir.path.string());
+    QVERIFY(!packed.has_value());
+    QCOMPARE(packed.error(), PackError::Cancelled);
+    QVERIFY(!fs::exists(dir.path / "data.bin.pack"));
+}
+
+void PackEngineTest::missingInputFails() {
+    ScratchDir dir("hello-qt-pack-missing");
+    PackEngine engine;
+    const auto packed = engine.Pack((dir.path / "nope.bin").string(), dir.path.string());
+    QVERIFY(!packed.has_value());
+    QCOMPARE(packed.error(), PackError::InputMissing);
+
+    const auto unpacked = engine.Unpack(dir.path.string(), dir.path.string());
+    QVERIFY(!unpacked.has_value());
+    QCOMPARE(unpacked.error(), PackError::UnsupportedInput);
+}
+
+void PackEngineTest::walkerListsTreeSorted() {
+    ScratchDir dir("hello-qt-pack-walk");
+    for (const char* sub : { "b/deep/er", "a", "c", "empty" }) fs::create_directories(dir.path / sub);
+    for (const char* file : { "z.txt", "b/deep/er/x.bin", "a/2", "a/1", "c/only", "b/top" }) {
+        writePattern(dir.path / file, 100);
+    }
+
+    ThreadPool pool(4);
+    const auto walked = DirectoryWalker(pool).Walk(dir.path);
+    QVERIFY(walked.has_value());
+    std::vector<std::string> paths;
+    for (const WalkedFile& f : *walked) {
+        paths.push_back(f.relativePath);
+        QCOMPARE(f.size, uint64_t(100));
+    }
+    const std::vector<std::string> expected{ "a/1", "a/2", "b/deep/er/x.bin", "b/top", "c/only", "z.txt" };
+    QVERIFY(paths == expected);
+
+    std::atomic<bool> cancel(true);
+    QVERIFY(!DirectoryWalker(pool).Walk(dir.path, &cancel).has_value());
+}
+
+void PackEngineTest::parallelPackIsDeterministic() {
+    ScratchDir dir("hello-qt-pack-parallel");
+    const fs::path tree = dir.path / "tree";
+    // Many files smaller than a chunk, plus one spanning several, so units both batch and split
+    for (int i = 0; i < 40; ++i) {
+        fs::create_directories(tree / ("d" + std::to_string(i % 5)));
+        writePattern(tree / ("d" + std::to_string(i % 5)) / ("f" + std::to_string(i)), 1000 + 7919 * (size_t)i);
+    }
+    const auto big = writePattern(tree / "big.bin", 3 * PACK_ENGINE_CHUNK + 99);
+
+    // The same tree through one worker and through four must lay out identically
+    std::vector<std::vector<PackEntry>> layouts;
+    for (size_t threads : { size_t(1), size_t(4) }) {
+        ThreadPool pool(threads);
+        PackEngine engine;
+        engine.SetThreadPool(pool);
+        const fs::path out = dir.path / ("out" + std::to_string(threads));
+        fs::create_directories(out);
+        const auto packed = engine.Pack(tree.string(), out.string());
+        QVERIFY(packed.has_value());
+
+        PackReader reader;
+        QVERIFY(reader.Open(*packed, engine.Options().key).has_value());
+        layouts.push_back(reader.Entries());
+
+        const auto restored = engine.Unpack(*packed, (out / "restored").string());
+        QVERIFY(restored.has_value());
+        QVERIFY(readAll(out / "restored" / "tree" / "big.bin") == big);
+        QVERIFY(readAll(out / "restored" / "tree" / "d3" / "f13") == readAll(tree / "d3" / "f13"));
+    }
+    QCOMPARE(layouts[0].size(), size_t(41));
+    QCOMPARE(layouts[0].size(), layouts[1].size());
+    for (size_t i = 0; i < layouts[0].size(); ++i) {
+        QCOMPARE(layouts[0][i].path, layouts[1][i].path);
+        QCOMPARE(layouts[0][i].offset, layouts[1][i].offset);
+        QCOMPARE(layouts[0][i].length, layouts[1][i].length);
+        if (i > 0) QVERIFY(layouts[0][i - 1].path < layouts[0][i].path);
+    }
+}
+
+void PackEngineTest::everyIoBackendRoundTrips() {
+    ScratchDir dir("hello-qt-pack-io");
+    const fs::path tree = dir.path / "tree";
+    fs::create_directories(tree);
+    for (int i = 0; i < 30; ++i) writePattern(tree / ("s" + std::to_string(i)), 500 + 3001 * (size_t)i);
+    writePattern(tree / "large", 2 * PACK_ENGINE_CHUNK + 5);
+
+    for (IoBackendKind kind : { IoBackendKind::Uring, IoBackendKind::Threads }) {
+        PackEngine engine;
+        engine.SetIoBackend(kind);
+        const fs::path out = dir.path / IoBackendKindName(kind);
+        fs::create_directories(out);
+        const auto packed = engine.Pack(tree.string(), out.string());
+        QVERIFY(packed.has_value());
+        QVERIFY(engine.Unpack(*packed, (out / "restored").string()).has_value());
+        for (const auto& file : fs::directory_iterator(tree)) {
+            QVERIFY(readAll(out / "restored" / "tree" / file.path().filename()) == readAll(file.path()));
+        }
+    }
+}
+
+void PackEngineTest::compressedPackIsDeterministic() {
+    ScratchDir dir("hello-qt-pack-compressed");
+    const fs::path tree = dir.path / "tree";
+    fs::create_directories(tree);
+    for (int i = 0; i < 60; ++i) writePattern(tree / ("s" + std::to_string(i)), 100 + 2039 * (size_t)i);
+    const auto big = writePattern(tree / "big.bin", 2 * PACK_ENGINE_CHUNK + 77);
+
+    // Small chunks, so many are sealed out of order and wait their turn to be committed; the
+    // chunk table must still come out the same for one worker and for four
+    std::vector<std::vector<PackChunk>> tables;
+    for (size_t threads : { size_t(1), size_t(4) }) {
+        ThreadPool pool(threads);
+        PackEngine engine;
+        engine.SetThreadPool(pool);
+        PackOptions options;
+        options.chunkSize = PACK_MIN_CHUNK;
+        options.compressionLevel = 3;
+        engine.SetOptions(options);
+        const fs::path out = dir.path / ("out" + std::to_string(threads));
+        fs::create_directories(out);
+        const auto packed = engine.Pack(tree.string(), out.string());
+        QVERIFY(packed.has_value());
+
+        PackReader reader;
+        QVERIFY(reader.Open(*packed, options.key).has_value());
+        tables.push_back(reader.Chunks());
+        QVERIFY(fs::file_size(*packed) < fs::file_size(tree / "big.bin"));
+
+        const auto restored = engine.Unpack(*packed, (out / "restored").string());
+        QVERIFY(restored.has_value());
+        QVERIFY(readAll(out / "restored" / "tree" / "big.bin") == big);
+        QVERIFY(readAll(out / "restored" / "tree" / "s59") == readAll(tree / "s59"));
+    }
+    QCOMPARE(tables[0].size(), tables[1].size());
+    for (size_t i = 0; i < tables[0].size(); ++i) {
+        QCOMPARE(tables[0][i].fileOffset, tables[1][i].fileOffset);
+        QCOMPARE(tables[0][i].storedSize, tables[1][i].storedSize);
+        QCOMPARE(tables[0][i].flags, PACK_CHUNK_COMPRESSED);
+        if (i > 0) QCOMPARE(tables[0][i].fileOffset, tables[0][i - 1].fileOffset + tables[0][i - 1].storedSize);
+    }
+}
+
+void PackEngineTest::dedupPackStoresRepeatsOnce() {
+    ScratchDir dir("hello-qt-pack-dedup");
+    const fs::path tree = dir.path / "tree";
+    fs::create_directories(tree / "copies");
+    // Last night's big file, tonight's with a few bytes inserted, and small files repeated
+    std::vector<char> big(3 * PACK_ENGINE_CHUNK);
+    uint32_t x = 7;
+    for (char& c : big) { x ^= x << 13; x ^= x >> 17; x ^= x << 5; c = (char)x; }
+    std::ofstream(tree / "night1.bin", std::ios::binary).write(big.data(), (std::streamsize)big.size());
+    big.insert(big.begin() + 12345, 100, 'x');
+    std::ofstream(tree / "night2.bin", std::ios::binary).write(big.data(), (std::streamsize)big.size());
+    for (int i = 0; i < 50; ++i) {
+        writePattern(tree / ("s" + std::to_string(i)), 100 + 997 * (size_t)(i % 10));
+        writePattern(tree / "copies" / ("s" + std::to_string(i)), 100 + 997 * (size_t)(i % 10));
+    }
+
+    // One worker and four must store the same chunks in the same order
+    std::vector<std::vector<PackChunk>> tables;
+    for (size_t threads : { size_t(1), size_t(4) }) {
+        ThreadPool pool(threads);
+        PackEngine engine;
+        engine.SetThreadPool(pool);
+        PackOptions options;
+        options.chunkSize = 64 << 10;
+        options.dedup = true;
+        options.compressionLevel = 1;
+        engine.SetOptions(options);
+        const fs::path out = dir.path / ("out" + std::to_string(threads));
+        fs::create_directories(out);
+        const auto packed = engine.Pack(tree.string(), out.string());
+        QVERIFY(packed.has_value());
+
+        // Little more than one night's file, and one copy of each distinct small file
+        uint64_t input = 0;
+        for (const auto& file : fs::recursive_directory_iterator(tree)) {
+            if (file.is_regular_file()) input += file.file_size();
+        }
+        QVERIFY(fs::file_size(*packed) < input / 2 + 200000);
+
+        PackReader reader;
+        QVERIFY(reader.Open(*packed, options.key).has_value());
+        QVERIFY(reader.Refs().size() > reader.Chunks().size());
+        tables.push_back(reader.Chunks());
+
+        const auto restored = engine.Unpack(*packed, (out / "restored").string());
+        QVERIFY(restored.has_value());
+        QVERIFY(readAll(out / "restored" / "tree" / "night2.bin") == big);
+        QVERIFY(readAll(out / "restored" / "tree" / "night1.bin") == readAll(tree / "night1.bin"));
+        QVERIFY(readAll(out / "restored" / "tree" / "copies" / "s37") == readAll(tree / "s37"));
+    }
+    QCOMPARE(tables[0].size(), tables[1].size());
+    for (size_t i = 0; i < tables[0].size(); ++i) {
+        QCOMPARE(tables[0][i].fileOffset, tables[1][i].fileOffset);
+        QVERIFY(tables[0][i].digest == tables[1][i].digest);
+    }
+}
+
+void PackEngineTest::unpackSelectsEntries() {
+    ScratchDir dir("hello-qt-pack-select");
+    const fs::path tree = dir.path / "tree";
+    for (int i = 0; i < 30; ++i) {
+        fs::create_directories(tree / ("d" + std::to_string(i % 3)));
+        writePattern(tree / ("d" + std::to_string(i % 3)) / ("f" + std::to_string(i) + (i % 2 ? ".txt" : ".bin")),
+                     500 + 4001 * (size_t)i);
+    }
+    const auto big = writePattern(tree / "big.bin", 2 * PACK_ENGINE_CHUNK + 777);
+
+    // Plain, compressed and deduplicated archives, each unpacked by one thread and by four
+    for (int layout = 0; layout < 3; ++layout) {
+        PackOptions options;
+        options.chunkSize = 64 << 10;
+        options.compressionLevel = layout == 0 ? 0 : 1;
+        options.dedup = layout == 2;
+        for (size_t threads : { size_t(1), size_t(4) }) {
+            ThreadPool pool(threads);
+            PackEngine engine;
+            engine.SetThreadPool(pool);
+            engine.SetOptions(options);
+            const fs::path out = dir.path / ("out" + std::to_string(layout) + "_" + std::to_string(threads));
+            fs::create_directories(out);
+            const auto packed = engine.Pack(tree.string(), out.string());
+            QVERIFY(packed.has_value());
+
+            // Everything, with progress adding up to the payload
+            uint64_t done = 0, total = 0;
+            engine.SetProgressCallback([&](const PackProgress& p) { done = p.bytesDone; total = p.bytesTotal; });
+            QVERIFY(engine.Unpack(*packed, (out / "all").string()).has_value());
+            QCOMPARE(done, total);
+            QVERIFY(readAll(out / "all" / "tree" / "big.bin") == big);
+            for (const auto& file : fs::recursive_directory_iterator(tree)) {
+                if (!file.is_regular_file()) continue;
+                QVERIFY(readAll(out / "all" / "tree" / fs::relative(file.path(), tree)) == readAll(file.path()));
+            }
+
+            // A directory and a glob: only what they select is written
+            const std::string patterns[] = { "tree/d1", "tree/**/f2?.txt" };
+            QVERIFY(engine.Unpack(*packed, (out / "some").string(), patterns).has_value());
+            size_t written = 0;
+            for (const auto& file : fs::recursive_directory_iterator(out / "some")) {
+                if (!file.is_regular_file()) continue;
+                ++written;
+                const fs::path relative = fs::relative(file.path(), out / "some" / "tree");
+                const std::string name = relative.filename().string();
+                QVERIFY(relative.parent_path() == "d1" || (name.size() == 7 && name.rfind("f2", 0) == 0 && relative.extension() == ".txt"));
+                QVERIFY(readAll(file.path()) == readAll(tree / relative));
+            }
+            QCOMPARE(written, size_t(10 + 4));   // d1 holds 10, and f25 with them; f21, f23, f27, f29 are elsewhere
+
+            const std::string nothing[] = { "tree/none*" };
+            const auto missing = engine.Unpack(*packed, (out / "none").string(), nothing);
+            QVERIFY(!missing.has_value());
+            QCOMPARE(missing.error(), PackError::EntryNotFound);
+        }
+    }
+}
+
+void PackEngineTest::verifyFindsCorruption() {
+    ScratchDir dir("hello-qt-pack-verify");
+    const fs::path tree = dir.path / "tree";
+    fs::create_directories(tree);
+    for (int i = 0; i < 20; ++i) writePattern(tree / ("f" + std::to_string(i)), 3000 + 40009 * (size_t)i);
+
+    for (int layout = 0; layout < 3; ++layout) {
+        ThreadPool pool(4);
+        PackEngine engine;
+        engine.SetThreadPool(pool);
+        PackOptions options;
+        options.chunkSize = 64 << 10;
+        options.compressionLevel = layout == 0 ? 0 : 1;
+        options.dedup = layout == 2;
+        options.tree = true;
+        engine.SetOptions(options);
+        const fs::path out = dir.path / ("out" + std::to_string(layout));
+        fs::create_directories(out);
+        const auto packed = engine.Pack(tree.string(), out.string());
+        QVERIFY(packed.has_value());
+        QVERIFY(engine.Verify(*packed).has_value());
+
+        // One flipped bit anywhere in the payload fails the chunk that holds it
+        {
+            std::fstream file(*packed, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(PACK_HEADER_SIZE + 100);
+            file.put('\x01' ^ (char)file.peek());
+        }
+        const auto verified = engine.Verify(*packed);
+        QVERIFY(!verified.has_value());
+        QCOMPARE(verified.error(), PackError::ChecksumMismatch);
+        const auto unpacked = engine.Unpack(*packed, (out / "restored").string());
+        QVERIFY(!unpacked.has_value());
+        QCOMPARE(unpacked.error(), PackError::ChecksumMismatch);
+    }
+}
+
+QTEST_APPLESS_MAIN(PackEngineTest)
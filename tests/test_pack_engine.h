@@ -0,0 +1,18 @@
+#pragma once
+#include <QtTest/QtTest>
+
+class PackEngineTest : public QObject {
+    Q_OBJECT
+private slots:
+    void roundTrip();
+    void reportsProgress();
+    void cancelRemovesOutput();
+    void missingInputFails();
+    void walkerListsTreeSorted();
+    void parallelPackIsDeterministic();
+    void everyIoBackendRoundTrips();
+    void compressedPackIsDeterministic();
+    void dedupPackStoresRepeatsOnce();
+    void unpackSelectsEntries();
+    void verifyFindsCorruption();
+};
@@ -0,0 +1,842 @@
+#include "test_pack_format.h"
+#include "PackFormat.hpp"
+#include "PackEngine.hpp"
+#include "Crc32c.hpp"
+#include "MappedFile.hpp"
+#include "IoBackend.hpp"
+#include "BufferPool.hpp"
+#include "Lz77.hpp"
+#include "Sha256.hpp"
+#include "FastCdc.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct ScratchDir {
+    fs::path path;
+    explicit ScratchDir(const char* name) : path(fs::temp_directory_path() / name) {
+        fs::remove_all(path);
+        fs::create_directories(path);
+    }
+    ~ScratchDir() { std::error_code ec; fs::remove_all(path, ec); }
+};
+
+std::vector<char> makeData(size_t size, uint32_t seed) {
+    std::vector<char> data(size);
+    uint32_t x = seed * 2654435761u + 1;
+    for (size_t i = 0; i < size; ++i) { x ^= x << 13; x ^= x >> 17; x ^= x << 5; data[i] = (char)x; }
+    return data;
+}
+
+void writeFile(const fs::path& file, const std::vector<char>& data) {
+    fs::create_directories(file.parent_path());
+    std::ofstream(file, std::ios::binary).write(data.data(), (std::streamsize)data.size());
+}
+
+std::vector<char> readAll(const fs::path& file) {
+    std::ifstream in(file, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// A small tree whose files straddle 4 KiB chunk boundaries, including an empty file
+std::map<std::string, std::vector<char>> makeTree(const fs::path& root) {
+    std::map<std::string, std::vector<char>> files;
+    files["a.txt"] = makeData(100, 1);
+    files["empty.bin"] = {};
+    files["sub/b.bin"] = makeData(4096 * 3 + 7, 2);
+    files["sub/deeper/c.bin"] = makeData(4096, 3);
+    files["z.bin"] = makeData(9000, 4);
+    for (const auto& [path, data] : files) writeFile(root / path, data);
+    return files;
+}
+
+// Log-like text: short repeats near each other, longer ones further back
+std::vector<char> makeText(size_t size, uint32_t seed) {
+    static const char* words[] = { "pack ", "chunk ", "cipher ", "index ", "footer ", "entry ", "= ", "ok\n" };
+    std::vector<char> text;
+    uint32_t x = seed * 2654435761u + 1;
+    while (text.size() < size) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        const char* word = words[x % 8];
+        text.insert(text.end(), word, word + std::strlen(word));
+        if (x % 5 == 0) text.push_back((char)('0' + x % 10));
+    }
+    text.resize(size);
+    return text;
+}
+
+void putLe(std::vector<char>& bytes, size_t at, uint64_t value, int size) {
+    for (int i = 0; i < size; ++i) bytes[at + i] = (char)(value >> (8 * i));
+}
+
+uint64_t getLe(const std::vector<char>& bytes, size_t at, int size) {
+    uint64_t value = 0;
+    for (int i = 0; i < size; ++i) value |= (uint64_t)(uint8_t)bytes[at + i] << (8 * i);
+    return value;
+}
+
+PackOptions smallChunks(PackCipher cipher) {
+    PackOptions options;
+    options.cipher = cipher;
+    options.chunkSize = PACK_MIN_CHUNK;
+    for (uint8_t i = 0; i < PACK_KEY_SIZE; ++i) options.key[i] = (uint8_t)(i * 7 + 1);
+    return options;
+}
+
+} // namespace
+
+void PackFormatTest::crc32cCheckValue() {
+    const char* check = "123456789";
+    QCOMPARE(Crc32c(std::as_bytes(std::span<const char>(check, 9))), 0xE3069283u);
+
+    // Continuing a CRC equals one pass over the whole buffer
+    const std::vector<char> data = makeData(1000, 9);
+    const auto bytes = std::as_bytes(std::span<const char>(data));
+    QCOMPARE(Crc32c(bytes.subspan(333), Crc32c(bytes.first(333))), Crc32c(bytes));
+}
+
+void PackFormatTest::crc32cMatchesBitwise() {
+    auto bitwise = [](std::span<const std::byte> data, uint32_t crc) {
+        crc = ~crc;
+        for (std::byte b : data) {
+            crc ^= (uint8_t)b;
+            for (int k = 0; k < 8; ++k) crc = (crc >> 1) ^ ((0u - (crc & 1u)) & 0x82F63B78u);
+        }
+        return ~crc;
+    };
+    // Either side of the three-stream strides, at every alignment
+    const std::vector<char> data = makeData(60000, 10);
+    const auto bytes = std::as_bytes(std::span<const char>(data));
+    for (size_t length : { 0, 1, 7, 8, 767, 768, 769, 24575, 24576, 24577, 50000 }) {
+        for (size_t offset = 0; offset < 8; ++offset) {
+            const auto slice = bytes.subspan(offset, length);
+            QCOMPARE(Crc32c(slice, 0x1234u), bitwise(slice, 0x1234u));
+        }
+    }
+}
+
+void PackFormatTest::directoryRoundTrip() {
+    ScratchDir dir("hello-qt-format-tree");
+    const auto files = makeTree(dir.path / "tree");
+
+    PackEngine engine;
+    engine.SetOptions(smallChunks(PackCipher::ChaCha20));
+    const auto packed = engine.Pack((dir.path / "tree").string(), dir.path.string());
+    QVERIFY(packed.has_value());
+
+    PackReader reader;
+    QVERIFY(reader.Open(*packed, engine.Options().key).has_value());
+    QCOMPARE(reader.Entries().size(), files.size());
+    QCOMPARE(reader.Entries().front().path, std::string("tree/a.txt"));   // sorted, deterministic
+
+    QVERIFY(engine.Unpack(*packed, (dir.path / "out").string()).has_value());
+    for (const auto& [path, data] : files) {
+        QVERIFY(readAll(dir.path / "out" / "tree" / path) == data);
+    }
+}
+
+void PackFormatTest::everyCipherRoundTrips() {
+    for (PackCipher cipher : { PackCipher::None, PackCipher::ChaCha20, PackCipher::AesCtr, PackCipher::ChaCha20Poly1305 }) {
+        ScratchDir dir("hello-qt-format-cipher");
+        const std::vector<char> data = makeData(3 * PACK_MIN_CHUNK + 5, 11);
+        writeFile(dir.path / "f.bin", data);
+
+        PackEngine engine;
+        engine.SetOptions(smallChunks(cipher));
+        const auto packed = engine.Pack((dir.path / "f.bin").string(), dir.path.string());
+        QVERIFY(packed.has_value());
+        QVERIFY(engine.Unpack(*packed, (dir.path / "out").string()).has_value());
+        QVERIFY(readAll(dir.path / "out" / "f.bin") == data);
+
+        // The wrong key does not decrypt (the chunk CRCs cover the stored bytes, so they pass);
+        // the authenticated cipher says so
+        if (cipher != PackCipher::None) {
+            PackOptions wrong = smallChunks(cipher);
+            wrong.key[0] ^= 1;
+            engine.SetOptions(wrong);
+            const auto unpacked = engine.Unpack(*packed, (dir.path / "wrong").string());
+            if (cipher == PackCipher::ChaCha20Poly1305) {
+                QCOMPARE(unpacked.error(), PackError::AuthenticationFailed);
+                QVERIFY(!fs::exists(dir.path / "wrong" / "f.bin"));
+            } else {
+                QVERIFY(unpacked.has_value());
+                QVERIFY(readAll(dir.path / "wrong" / "f.bin") != data);
+            }
+        }
+    }
+}
+
+void PackFormatTest::extractsOneFileByIndex() {
+    ScratchDir dir("hello-qt-format-extract");
+    const auto files = makeTree(dir.path / "tree");
+
+    PackEngine engine;
+    engine.SetOptions(smallChunks(PackCipher::AesCtr));
+    const auto packed = engine.Pack((dir.path / "tree").string(), dir.path.string());
+    QVERIFY(packed.has_value());
+
+    PackReader reader;
+    QVERIFY(reader.Open(*packed, engine.Options().key).has_value());
+    const PackEntry* entry = reader.Find("tree/sub/b.bin");
+    QVERIFY(entry != nullptr);
+    QCOMPARE(entry->chunkCount, uint32_t(4));   // 3 * 4096 + 7 bytes starting at offset 100
+
+    std::vector<char> got;
+    QVERIFY(reader.Read(*entry, [&](std::span<const std::byte> slice) -> std::expected<void, PackError> {
+        got.insert(got.end(), (const char*)slice.data(), (const char*)slice.data() + slice.size());
+        return {};
+    }).has_value());
+    QVERIFY(got == files.at("sub/b.bin"));
+
+    const auto extracted = engine.ExtractFile(*packed, "tree/z.bin", (dir.path / "one").string());
+    QVERIFY(extracted.has_value());
+    QVERIFY(readAll(*extracted) == files.at("z.bin"));
+    QVERIFY(!fs::exists(dir.path / "one" / "tree" / "a.txt"));
+
+    const auto missing = engine.ExtractFile(*packed, "tree/nope", (dir.path / "one").string());
+    QCOMPARE(missing.error(), PackError::EntryNotFound);
+}
+
+void PackFormatTest::detectsCorruptChunk() {
+    ScratchDir dir("hello-qt-format-corrupt");
+    writeFile(dir.path / "f.bin", makeData(3 * PACK_MIN_CHUNK, 5));
+
+    PackEngine engine;
+    engine.SetOptions(smallChunks(PackCipher::ChaCha20));
+    const auto packed = engine.Pack((dir.path / "f.bin").string(), dir.path.string());
+    QVERIFY(packed.has_value());
+
+    // Flip one byte inside the second chunk
+    {
+        std::fstream file(*packed, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(PACK_HEADER_SIZE + PACK_MIN_CHUNK + 17);
+        file.put('\x5A' ^ (char)file.peek());
+    }
+    const auto unpacked = engine.Unpack(*packed, (dir.path / "out").string());
+    QVERIFY(!unpacked.has_value());
+    QCOMPARE(unpacked.error(), PackError::ChecksumMismatch);
+    QVERIFY(!fs::exists(dir.path / "out" / "f.bin"));
+}
+
+void PackFormatTest::rejectsCorruptIndex() {
+    ScratchDir dir("hello-qt-format-index");
+    writeFile(dir.path / "f.bin", makeData(3 * PACK_MIN_CHUNK, 7));
+    PackEngine engine;
+    engine.SetOptions(smallChunks(PackCipher::ChaCha20));
+    const auto packed = engine.Pack((dir.path / "f.bin").string(), dir.path.string());
+    QVERIFY(packed.has_value());
+    const std::vector<char> good = readAll(*packed);
+    const size_t footer = good.size() - PACK_FOOTER_SIZE;
+    const size_t indexOffset = (size_t)getLe(good, footer, 8), indexSize = (size_t)getLe(good, footer + 8, 8);
+
+    // Chunk 0's file offset (after the entry count, the one entry and the chunk count) made to
+    // run past the end of the address space, under a CRC that matches again
+    std::vector<char> bad = good;
+    putLe(bad, indexOffset + 8 + 2 + std::strlen("f.bin") + 24 + 8, UINT64_MAX - 1, 8);
+    putLe(bad, footer + 16, Crc32c(std::as_bytes(std::span<const char>(bad).subspan(indexOffset, indexSize))), 4);
+    writeFile(*packed, bad);
+    PackReader reader;
+    const auto opened = reader.Open(*packed);
+    QVERIFY(!opened.has_value());
+    QCOMPARE(opened.error(), PackError::BadFormat);
+    QVERIFY(!engine.Verify(*packed).has_value());
+}
+
+void PackFormatTest::rejectsForeignFiles() {
+    ScratchDir dir("hello-qt-format-foreign");
+    writeFile(dir.path / "junk.pack", makeData(500, 6));
+
+    PackReader reader;
+    const auto opened = reader.Open((dir.path / "junk.pack").string());
+    QVERIFY(!opened.has_value());
+    QCOMPARE(opened.error(), PackError::BadFormat);
+
+    // A footer whose index offset and size only add up to the file size by wrapping around
+    writeFile(dir.path / "f.bin", makeData(PACK_MIN_CHUNK, 8));
+    PackEngine engine;
+    engine.SetOptions(smallChunks(PackCipher::None));
+    const auto packed = engine.Pack((dir.path / "f.bin").string(), dir.path.string());
+    QVERIFY(packed.has_value());
+    std::vector<char> bytes = readAll(*packed);
+    const size_t footer = bytes.size() - PACK_FOOTER_SIZE;
+    putLe(bytes, footer, (uint64_t)0 - PACK_FOOTER_SIZE, 8);
+    putLe(bytes, footer + 8, bytes.size(), 8);
+    writeFile(*packed, bytes);
+    const auto wrapped = reader.Open(*packed);
+    QVERIFY(!wrapped.has_value());
+    QCOMPARE(wrapped.error(), PackError::BadFormat);
+}
+
+void PackFormatTest::rejectsUnsafePaths() {
+    QVERIFY(PackPathIsSafe("a/b/c.txt"));
+    QVERIFY(!PackPathIsSafe(""));
+    QVERIFY(!PackPathIsSafe("/etc/passwd"));
+    QVERIFY(!PackPathIsSafe("a/../../b"));
+    QVERIFY(!PackPathIsSafe("a//b"));
+    QVERIFY(!PackPathIsSafe("a/b/"));
+    QVERIFY(!PackPathIsSafe("c:/windows"));
+    QVERIFY(!PackPathIsSafe("a\\b"));
+}
+
+void PackFormatTest::matchesPathsAndGlobs() {
+    QVERIFY(PackPathMatches("tree/a.txt", "tree/a.txt"));
+    QVERIFY(PackPathMatches("tree", "tree/sub/a.txt"));
+    QVERIFY(PackPathMatches("tree/sub/", "tree/sub/a.txt"));
+    QVERIFY(!PackPathMatches("tre", "tree/a.txt"));
+    QVERIFY(PackPathMatches("tree/*.txt", "tree/a.txt"));
+    QVERIFY(!PackPathMatches("tree/*.txt", "tree/sub/a.txt"));
+    QVERIFY(PackPathMatches("tree/**/*.txt", "tree/a.txt"));
+    QVERIFY(PackPathMatches("tree/**/*.txt", "tree/sub/deeper/a.txt"));
+    QVERIFY(PackPathMatches("**.bin", "a/b/c.bin"));
+    QVERIFY(PackPathMatches("tree/?.txt", "tree/a.txt"));
+    QVERIFY(!PackPathMatches("tree/?.txt", "tree/ab.txt"));
+    QVERIFY(PackPathMatches("tree/[a-c].txt", "tree/b.txt"));
+    QVERIFY(!PackPathMatches("tree/[!a-c].txt", "tree/b.txt"));
+    QVERIFY(PackPathMatches("tree/[]x].txt", "tree/].txt"));
+    QVERIFY(PackPathMatches("*/sub", "tree/sub/a.txt"));   // a glob naming a directory
+    QVERIFY(!PackPathMatches("", "tree/a.txt"));
+}
+
+void PackFormatTest::mappedFileBasics() {
+    ScratchDir dir("hello-qt-format-mapped");
+    const std::string path = (dir.path / "m.bin").string();
+    {
+        MappedFile out;
+        QVERIFY(out.Create(path, 10000).has_value());
+        QCOMPARE(out.MutableData().size(), size_t(10000));
+        for (size_t i = 0; i < 10000; ++i) out.MutableData()[i] = std::byte(i * 3);
+        QVERIFY(out.Flush().has_value());
+    }
+    MappedFile in;
+    QVERIFY(in.OpenRead(path).has_value());
+    QCOMPARE(in.Size(), uint64_t(10000));
+    QVERIFY(in.MutableData().empty());   // read-only
+    for (size_t i = 0; i < 10000; ++i) QCOMPARE(in.Data()[i], std::byte(i * 3));
+
+    // Empty files map to an empty span; missing files fail
+    MappedFile empty;
+    QVERIFY(empty.Create((dir.path / "e.bin").string(), 0).has_value());
+    QVERIFY(empty.Data().empty());
+    MappedFile missing;
+    QCOMPARE(missing.OpenRead((dir.path / "nope").string()).error(), MappedFileError::OpenFailed);
+}
+
+void PackFormatTest::chacha20PayloadIsCapped() {
+    ScratchDir dir("hello-qt-format-cap");
+    QCOMPARE(PackPayloadLimit(PackCipher::ChaCha20), (uint64_t)64 << 32);   // 2^32 blocks of 64 bytes
+    QCOMPARE(PackPayloadLimit(PackCipher::AesCtr), UINT64_MAX);
+    QCOMPARE(PackPayloadLimit(PackCipher::ChaCha20Poly1305), UINT64_MAX);   // a nonce per chunk
+
+    // One byte more than the keystream holds is refused before anything is created
+    PackWriter writer;
+    const fs::path big = dir.path / "big.pack";
+    const auto opened = writer.OpenMapped(big.string(), smallChunks(PackCipher::ChaCha20), PACK_CHACHA20_MAX_PAYLOAD + 1);
+    QVERIFY(!opened.has_value());
+    QCOMPARE(opened.error(), PackError::TooLarge);
+    QVERIFY(!fs::exists(big));
+}
+
+void PackFormatTest::streamingAndMappedWriters() {
+    ScratchDir dir("hello-qt-format-writers");
+    const std::vector<char> a = makeText(5000, 21), b = makeData(7, 22);
+    PackOptions options = smallChunks(PackCipher::ChaCha20);
+
+    // Same entries through both writers (data arrives in odd-sized pieces), stored and compressed
+    auto fill = [&](PackWriter& writer) {
+        QVERIFY(writer.BeginFile("a").has_value());
+        QVERIFY(writer.Write(std::as_bytes(std::span<const char>(a)).first(1234)).has_value());
+        QVERIFY(writer.Write(std::as_bytes(std::span<const char>(a)).subspan(1234)).has_value());
+        QVERIFY(writer.EndFile().has_value());
+        QVERIFY(writer.BeginFile("b").has_value());
+        QVERIFY(writer.Write(std::as_bytes(std::span<const char>(b))).has_value());
+        QVERIFY(writer.Finish().has_value());
+    };
+    for (int level : { 0, 1 }) {
+        options.compressionLevel = level;
+        PackWriter streaming, mapped;
+        QVERIFY(streaming.Open((dir.path / "s.pack").string(), options).has_value());
+        fill(streaming);
+        QVERIFY(mapped.OpenMapped((dir.path / "m.pack").string(), options, a.size() + b.size()).has_value());
+        fill(mapped);
+
+        for (const char* name : { "s.pack", "m.pack" }) {
+            PackReader reader;
+            QVERIFY(reader.Open((dir.path / name).string(), options.key).has_value());
+            QCOMPARE(reader.Chunks().size(), size_t(2));
+            QCOMPARE(reader.Chunks()[0].flags, level ? PACK_CHUNK_COMPRESSED : 0u);
+            std::vector<std::byte> got(a.size());
+            QVERIFY(reader.ReadInto(*reader.Find("a"), got).has_value());
+            QVERIFY(std::memcmp(got.data(), a.data(), a.size()) == 0);
+            QVERIFY(reader.ReadInto(*reader.Find("b"), got).has_value());
+            QVERIFY(std::memcmp(got.data(), b.data(), b.size()) == 0);
+        }
+        // The mapped output is cut back to what the compressed chunks took
+        QCOMPARE(fs::file_size(dir.path / "m.pack"), fs::file_size(dir.path / "s.pack"));
+    }
+
+    // A mapped writer sized for more payload than it received refuses to finish
+    options.compressionLevel = 0;
+    PackWriter shortfall;
+    QVERIFY(shortfall.OpenMapped((dir.path / "x.pack").string(), options, 100).has_value());
+    QVERIFY(shortfall.BeginFile("x").has_value());
+    QVERIFY(shortfall.Write(std::as_bytes(std::span<const char>(b))).has_value());
+    QCOMPARE(shortfall.Finish().error(), PackError::InputChanged);
+    QVERIFY(!fs::exists(dir.path / "x.pack"));
+}
+
+void PackFormatTest::ioBackendsTransfer() {
+    ScratchDir dir("hello-qt-io-backends");
+    const size_t blocks = 3 * IO_BACKEND_DEPTH;   // more than one ring's worth in flight
+    const uint32_t block = 3000;                   // unaligned on purpose
+    const auto data = makeData(blocks * block, 21);
+
+    for (IoBackendKind kind : { IoBackendKind::Uring, IoBackendKind::Threads }) {
+        BufferPool buffers(64 << 10, 2);
+        const std::span<std::byte> arena = buffers.Arena();
+        auto io = IoBackend::Create(kind, ThreadPool::Shared(), std::span<const std::span<std::byte>>(&arena, 1));
+        QVERIFY(io != nullptr);
+        const PooledBuffer first = buffers.Acquire(), second = buffers.Acquire();
+        const fs::path file = dir.path / IoBackendKindName(io->Kind());
+
+        // Scattered writes, in reverse to make sure offsets and not order place the data
+        IoFile out;
+        QVERIFY(out.Create(file.string(), data.size()).has_value());
+        std::vector<IoRequest> writes;
+        for (size_t i = blocks; i-- > 0;) {
+            writes.push_back({ &out, i * block, (std::byte*)data.data() + i * block, block, -1 });
+        }
+        QVERIFY(io->Write(writes).has_value());
+        out.Close();
+        QVERIFY(readAll(file) == data);
+
+        // Reads into the registered arena and into caller memory in one batch
+        IoFile in;
+        QVERIFY(in.OpenRead(file.string()).has_value());
+        std::vector<char> back(data.size());
+        std::vector<IoRequest> reads;
+        for (size_t i = 0; i < blocks; ++i) reads.push_back({ &in, i * block, (std::byte*)back.data() + i * block, block, -1 });
+        reads.push_back({ &in, 5, first.Data(), 40000, 0 });
+        QVERIFY(io->Read(reads).has_value());
+        QVERIFY(back == data);
+        QVERIFY(std::memcmp(first.Data(), data.data() + 5, 40000) == 0);
+
+        // Past the end is a short read, not silently zero-filled
+        const IoRequest tail{ &in, data.size() - 10, second.Data(), 20, 0 };
+        const auto shortRead = io->Read(std::span<const IoRequest>(&tail, 1));
+        QVERIFY(!shortRead.has_value());
+        QCOMPARE(shortRead.error(), IoError::ShortRead);
+    }
+}
+
+void PackFormatTest::lz77RoundTrips() {
+    Lz77Compressor lz;
+    std::vector<std::vector<char>> inputs = {
+        makeText(100000, 31),
+        makeData(50000, 32),
+        std::vector<char>(70000, 'x'),   // one long overlapping match
+        makeText(13, 33),                // too short for any match
+        { 'a' },
+    };
+    // A repeat from beyond the 64 KiB window, then one inside it
+    std::vector<char> far = makeData(20000, 34), filler = makeData(70000, 35);
+    far.insert(far.end(), filler.begin(), filler.end());
+    far.insert(far.end(), far.begin(), far.begin() + 20000);
+    far.insert(far.end(), filler.begin(), filler.begin() + 5000);
+    inputs.push_back(far);
+
+    for (const std::vector<char>& input : inputs) {
+        const auto in = std::as_bytes(std::span<const char>(input));
+        for (int level : { 1, 4, LZ77_MAX_LEVEL }) {
+            std::vector<std::byte> packed(input.size() * 2 + 16), back(input.size());
+            const size_t size = lz.Compress(in, packed, level);
+            QVERIFY(size > 0);
+            QVERIFY(Lz77Decompress(std::span<const std::byte>(packed).first(size), back).has_value());
+            QVERIFY(std::memcmp(back.data(), input.data(), input.size()) == 0);
+        }
+    }
+
+    // Text shrinks, harder levels at least as much; noise does not fit in fewer bytes
+    const auto text = std::as_bytes(std::span<const char>(inputs[0]));
+    std::vector<std::byte> packed(text.size());
+    const size_t fast = lz.Compress(text, packed, 1), best = lz.Compress(text, packed, LZ77_MAX_LEVEL);
+    QVERIFY(fast > 0 && fast < text.size() / 2);
+    QVERIFY(best > 0 && best <= fast);
+    const auto noise = std::as_bytes(std::span<const char>(inputs[1]));
+    QCOMPARE(lz.Compress(noise, std::span<std::byte>(packed).first(noise.size() - 1), 1), size_t(0));
+
+    // Flushed in order and in strides, the output is what one call makes; a block that stops
+    // fitting comes back 0 even after some of it went out
+    const size_t whole = lz.Compress(text, packed, 4);
+    std::vector<std::byte> streamed(text.size()), flushed;
+    size_t pieces = 0, shortPieces = 0;
+    QCOMPARE(lz.Compress(text, streamed, 4, 1000, [&](std::span<std::byte> finished) {
+        flushed.insert(flushed.end(), finished.begin(), finished.end());
+        shortPieces += finished.size() < 1000 && flushed.size() < whole;
+        ++pieces;
+        return true;
+    }), whole);
+    QVERIFY(pieces > 1 && shortPieces == 0);
+    QVERIFY(flushed.size() == whole && std::memcmp(flushed.data(), packed.data(), whole) == 0);
+    std::vector<char> mixed = makeText(20000, 36), tail = makeData(40000, 37);
+    mixed.insert(mixed.end(), tail.begin(), tail.end());
+    const auto mixedIn = std::as_bytes(std::span<const char>(mixed));
+    std::vector<std::byte> tight(mixed.size() / 2);
+    pieces = 0;
+    QCOMPARE(lz.Compress(mixedIn, tight, 1, 1000, [&](std::span<std::byte>) {
+        return ++pieces, true;
+    }), size_t(0));
+    QVERIFY(pieces > 0);
+    QCOMPARE(lz.Compress(text, packed, 1, 1000, [](std::span<std::byte>) { return false; }), size_t(0));
+
+    // Truncated, overlong or out-of-window input is refused, never overrun
+    const size_t size = lz.Compress(text, packed, 1);
+    std::vector<std::byte> back(text.size());
+    QVERIFY(!Lz77Decompress(std::span<const std::byte>(packed).first(size - 1), back).has_value());
+    QVERIFY(!Lz77Decompress(std::span<const std::byte>(packed).first(size), std::span<std::byte>(back).first(back.size() - 1)).has_value());
+    const std::byte badOffset[] = { std::byte(0x10), std::byte('a'), std::byte(9), std::byte(0), std::byte(0x00) };
+    QVERIFY(!Lz77Decompress(badOffset, back).has_value());
+}
+
+void PackFormatTest::compressedPackRoundTrips() {
+    ScratchDir dir("hello-qt-format-compressed");
+    std::map<std::string, std::vector<char>> files;
+    files["log.txt"] = makeText(200000, 41);
+    files["noise.bin"] = makeData(30000, 42);
+    files["small/a.txt"] = makeText(300, 43);
+    files["small/b.txt"] = makeText(5000, 44);
+    files["small/empty"] = {};
+    for (const auto& [path, data] : files) writeFile(dir.path / "tree" / path, data);
+
+    uint64_t sizes[2] = {};
+    for (int level : { 0, 6 }) {
+        const std::string out = "out" + std::to_string(level);
+        fs::create_directories(dir.path / out);
+        PackEngine engine;
+        PackOptions options = smallChunks(PackCipher::AesCtr);
+        options.compressionLevel = level;
+        engine.SetOptions(options);
+        auto packed = engine.Pack((dir.path / "tree").string(), (dir.path / out).string());
+        QVERIFY(packed.has_value());
+        sizes[level ? 1 : 0] = fs::file_size(*packed);
+
+        // Text chunks are stored compressed, noise chunks raw
+        PackReader reader;
+        QVERIFY(reader.Open(*packed, options.key).has_value());
+        QCOMPARE(reader.Compression(), level ? PackCompression::Lz77 : PackCompression::None);
+        size_t compressed = 0;
+        for (const PackChunk& chunk : reader.Chunks()) compressed += (chunk.flags & PACK_CHUNK_COMPRESSED) != 0;
+        if (level) {
+            QVERIFY(compressed > 0 && compressed < reader.Chunks().size());
+        } else {
+            QCOMPARE(compressed, size_t(0));
+        }
+
+        // Unpack, plus a partial read out of a chunk shared by several small files
+        QVERIFY(engine.Unpack(*packed, (dir.path / out / "unpacked").string()).has_value());
+        for (const auto& [path, data] : files) QVERIFY(readAll(dir.path / out / "unpacked" / "tree" / path) == data);
+        std::vector<char> got;
+        QVERIFY(reader.Read(*reader.Find("tree/small/b.txt"), [&](std::span<const std::byte> slice) -> std::expected<void, PackError> {
+            got.insert(got.end(), (const char*)slice.data(), (const char*)slice.data() + slice.size());
+            return {};
+        }).has_value());
+        QVERIFY(got == files.at("small/b.txt"));
+
+        // Under the wrong key a compressed chunk does not decode
+        if (level) {
+            PackOptions wrong = options;
+            wrong.key[0] ^= 1;
+            engine.SetOptions(wrong);
+            const auto unpacked = engine.Unpack(*packed, (dir.path / out / "wrong").string());
+            QVERIFY(!unpacked.has_value());
+            QCOMPARE(unpacked.error(), PackError::DecompressFailed);
+        }
+    }
+    QVERIFY(sizes[1] < sizes[0] * 3 / 4);
+
+    // Out-of-range levels are refused up front
+    PackWriter writer;
+    PackOptions options = smallChunks(PackCipher::None);
+    options.compressionLevel = LZ77_MAX_LEVEL + 1;
+    QCOMPARE(writer.Open((dir.path / "bad.pack").string(), options).error(), PackError::BadFormat);
+}
+
+void PackFormatTest::sha256MatchesVectors() {
+    auto hex = [](const Sha256Digest& digest) {
+        static const char* digits = "0123456789abcdef";
+        std::string s;
+        for (uint8_t b : digest) { s += digits[b >> 4]; s += digits[b & 15]; }
+        return s;
+    };
+    auto hash = [&](const std::string& text) {
+        return hex(Sha256::Hash(std::as_bytes(std::span<const char>(text.data(), text.size()))));
+    };
+    // FIPS 180-4 examples: empty, one block, two blocks
+    QCOMPARE(hash(""), std::string("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    QCOMPARE(hash("abc"), std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    QCOMPARE(hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+             std::string("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+
+    // A million 'a', fed in uneven pieces that straddle block boundaries
+    const std::vector<std::byte> as(1000000, std::byte('a'));
+    Sha256 incremental;
+    for (size_t at = 0, step = 1; at < as.size(); at += step, step = step * 3 % 1000 + 1) {
+        incremental.Update(std::span<const std::byte>(as).subspan(at, std::min(step, as.size() - at)));
+    }
+    QCOMPARE(hex(incremental.Final()), std::string("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+}
+
+void PackFormatTest::fastCdcCutsFollowContent() {
+    const FastCdc cdc(64 << 10);
+    QCOMPARE(cdc.AverageSize(), uint32_t(16 << 10));
+    auto cuts = [&](const std::vector<char>& data) {
+        std::vector<size_t> ends;
+        const std::span<const std::byte> bytes = std::as_bytes(std::span<const char>(data));
+        for (size_t at = 0; at < bytes.size();) {
+            const size_t length = cdc.Cut(bytes.subspan(at));
+            if (length == 0 || length > cdc.MaxSize()) return std::vector<size_t>();
+            if (at + length < bytes.size() && length < cdc.MinSize()) return std::vector<size_t>();
+            at += length;
+            ends.push_back(at);
+        }
+        return ends;
+    };
+    const std::vector<char> data = makeData(2 << 20, 51);
+    const std::vector<size_t> before = cuts(data);
+    QVERIFY(before.size() > 64 && before.size() < 256);   // about the average, not every max
+
+    // Bytes inserted near the front move only the cuts next to them
+    std::vector<char> edited = data;
+    const std::vector<char> inserted = makeData(777, 52);
+    edited.insert(edited.begin() + 5000, inserted.begin(), inserted.end());
+    const std::vector<size_t> after = cuts(edited);
+    size_t kept = 0;
+    for (size_t end : before) kept += std::binary_search(after.begin(), after.end(), end + inserted.size());
+    QVERIFY(kept >= before.size() - 2);
+}
+
+void PackFormatTest::dedupPackStoresChunksOnce() {
+    ScratchDir dir("hello-qt-format-dedup");
+    const std::vector<char> a = makeData(3000, 61);
+    const std::vector<char> b = makeData(4000, 62);
+    const std::vector<std::pair<std::string, const std::vector<char>*>> files = {
+        { "a", &a }, { "copy/a", &a }, { "b", &b }, { "copy/again/a", &a } };
+    const std::string path = (dir.path / "d.pack").string();
+    PackOptions options = smallChunks(PackCipher::ChaCha20);
+    options.dedup = true;
+    options.compressionLevel = 1;
+
+    // Deduplicating archives only take the piece-at-a-time fill
+    PackWriter streaming;
+    QCOMPARE(streaming.Open(path, options).error(), PackError::BadFormat);
+
+    PackWriter writer;
+    QVERIFY(writer.OpenMapped(path, options, 3 * a.size() + b.size()).has_value());
+    QCOMPARE(writer.BeginFile("x").error(), PackError::WriteFailed);
+    for (const auto& [name, data] : files) QVERIFY(writer.AddFile(name, data->size()).has_value());
+    QCOMPARE(writer.BeginParallel().value(), uint32_t(0));
+
+    // Every piece sealed, as racing workers might; repeats are dropped at commit
+    Lz77Compressor lz;
+    std::vector<std::byte> out(PACK_MIN_CHUNK);
+    uint64_t payload = 0;
+    for (const auto& [name, data] : files) {
+        const std::span<const std::byte> raw = std::as_bytes(std::span<const char>(*data));
+        const Sha256Digest digest = writer.Fingerprint(raw);
+        const auto sealed = writer.SealPiece(payload, raw, out, &lz);
+        QVERIFY(sealed.has_value());
+        QCOMPARE(sealed->keystreamOffset, payload);
+        QVERIFY(writer.CommitPiece((uint32_t)raw.size(), digest, &*sealed, std::span<const std::byte>(out).first(sealed->storedSize)).has_value());
+        payload += raw.size();
+    }
+    QVERIFY(writer.Finish().has_value());
+
+    PackReader reader;
+    QVERIFY(reader.Open(path, options.key).has_value());
+    QCOMPARE(reader.Version(), uint16_t(PACK_VERSION_DEDUP));
+    QCOMPARE(reader.Chunks().size(), size_t(2));
+    QCOMPARE(reader.Refs().size(), size_t(4));
+    QCOMPARE(reader.Refs()[3].chunk, uint32_t(0));
+    QCOMPARE(reader.Refs()[3].payloadOffset, uint64_t(2 * a.size() + b.size()));
+    for (const auto& [name, data] : files) {
+        const PackEntry* entry = reader.Find(name);
+        QVERIFY(entry);
+        std::vector<char> got(data->size());
+        QVERIFY(reader.ReadInto(*entry, std::as_writable_bytes(std::span<char>(got))).has_value());
+        QVERIFY(got == *data);
+    }
+
+    // A repeat can only refer back; a piece never seen before must come sealed
+    PackWriter missing;
+    QVERIFY(missing.OpenMapped(path, options, a.size()).has_value());
+    QVERIFY(missing.AddFile("a", a.size()).has_value());
+    QVERIFY(missing.BeginParallel().has_value());
+    const Sha256Digest digest = missing.Fingerprint(std::as_bytes(std::span<const char>(a)));
+    QCOMPARE(missing.CommitPiece((uint32_t)a.size(), digest, nullptr, {}).error(), PackError::WriteFailed);
+    missing.Abandon();
+}
+
+void PackFormatTest::treeRootCoversChunks() {
+    ScratchDir dir("hello-qt-format-tree-root");
+    writeFile(dir.path / "f.bin", makeData(5 * PACK_MIN_CHUNK + 300, 11));
+
+    // A lone leaf is the root; an odd one out moves up unchanged
+    const Sha256Digest a = Sha256::Hash(std::as_bytes(std::span<const char>("a", 1)));
+    const Sha256Digest b = Sha256::Hash(std::as_bytes(std::span<const char>("b", 1)));
+    QVERIFY(PackTreeRoot(std::span<const Sha256Digest>(&a, 1)) == a);
+    const Sha256Digest ab[] = { a, b }, aba[] = { a, b, a };
+    QVERIFY(PackTreeRoot(aba) != PackTreeRoot(ab));
+
+    for (int compressed = 0; compressed < 2; ++compressed) {
+        PackOptions options = smallChunks(PackCipher::AesCtr);
+        options.tree = true;
+        options.compressionLevel = compressed;
+        PackEngine engine;
+        engine.SetOptions(options);
+        const fs::path out = dir.path / ("out" + std::to_string(compressed));
+        fs::create_directories(out);
+        const auto packed = engine.Pack((dir.path / "f.bin").string(), out.string());
+        QVERIFY(packed.has_value());
+
+        // The root in the index is the one over the chunks as stored, checked without the key
+        std::vector<Sha256Digest> leaves;
+        {
+            PackReader reader;
+            QVERIFY(reader.Open(*packed).has_value());
+            QVERIFY(reader.HasTree());
+            QCOMPARE(reader.Chunks().size(), size_t(6));
+            for (uint32_t i = 0; i < reader.Chunks().size(); ++i) {
+                const auto leaf = reader.CheckChunk(i);
+                QVERIFY(leaf.has_value());
+                leaves.push_back(*leaf);
+            }
+            QVERIFY(PackTreeRoot(leaves) == reader.TreeRoot());
+        }
+
+        {
+            std::fstream file(*packed, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(PACK_HEADER_SIZE + 40);
+            file.put('\x5A' ^ (char)file.peek());
+        }
+        PackReader reader;
+        QVERIFY(reader.Open(*packed).has_value());
+        const auto leaf = reader.CheckChunk(0);
+        QVERIFY(!leaf.has_value());
+        QCOMPARE(leaf.error(), PackError::ChecksumMismatch);
+    }
+}
+
+void PackFormatTest::authenticatedChunksCatchTampering() {
+    ScratchDir dir("hello-qt-format-aead");
+    const std::vector<char> data = makeText(6 * PACK_MIN_CHUNK + 300, 12);
+    writeFile(dir.path / "f.txt", data);
+
+    // XORing the CRC-32C polynomial (x^32 term first) into the stored bytes leaves the CRC as it was
+    const uint8_t crcBlind[5] = { 0xf1, 0x76, 0xec, 0x05, 0x01 };
+
+    for (int layout = 0; layout < 3; ++layout) {   // plain, compressed, compressed + deduplicated
+        PackOptions options = smallChunks(PackCipher::ChaCha20Poly1305);
+        options.compressionLevel = layout > 0 ? 1 : 0;
+        options.dedup = layout == 2;
+        PackEngine engine;
+        engine.SetOptions(options);
+        const fs::path out = dir.path / ("out" + std::to_string(layout));
+        fs::create_directories(out);
+        const auto packed = engine.Pack((dir.path / "f.txt").string(), out.string());
+        QVERIFY(packed.has_value());
+        QVERIFY(engine.Unpack(*packed, (out / "ok").string()).has_value());
+        QVERIFY(readAll(out / "ok" / "f.txt") == data);
+
+        uint64_t target = 0;
+        {
+            PackReader reader;
+            QVERIFY(reader.Open(*packed, options.key).has_value());
+            QVERIFY(reader.Chunks().size() > 1);
+            QVERIFY(reader.Chunks()[1].storedSize > 20);
+            QVERIFY(!(reader.Chunks()[1].tag == Poly1305Tag{}));
+            target = reader.Chunks()[1].fileOffset + 10;
+        }
+        {
+            std::fstream file(*packed, std::ios::binary | std::ios::in | std::ios::out);
+            for (int i = 0; i < 5; ++i) {
+                file.seekg((std::streamoff)(target + i));
+                const char stored = (char)file.peek();
+                file.seekp((std::streamoff)(target + i));
+                file.put((char)(stored ^ crcBlind[i]));
+            }
+        }
+
+        // The CRC is fooled; the tag is not, whichever way the chunk is read, and nothing it
+        // decrypts to reaches the caller's buffer
+        QVERIFY(engine.Verify(*packed).has_value());
+        {
+            PackReader reader;
+            QVERIFY(reader.Open(*packed, options.key).has_value());
+            const std::vector<std::byte> untouched(options.chunkSize, std::byte{ 0xAA });
+            std::vector<std::byte> raw = untouched, scratch;
+            PackCipherStream stream = reader.Stream();
+            const auto read = reader.ReadChunk(1, raw, stream, scratch);
+            QVERIFY(!read.has_value());
+            QCOMPARE(read.error(), PackError::AuthenticationFailed);
+            QVERIFY(raw == untouched);
+        }
+        const auto unpacked = engine.Unpack(*packed, (out / "bad").string());
+        QVERIFY(!unpacked.has_value());
+        QCOMPARE(unpacked.error(), PackError::AuthenticationFailed);
+        QVERIFY(!fs::exists(out / "bad" / "f.txt"));
+        const auto extracted = engine.ExtractFile(*packed, "f.txt", (out / "one").string());
+        QVERIFY(!extracted.has_value());
+        QCOMPARE(extracted.error(), PackError::AuthenticationFailed);
+    }
+}
+
+void PackFormatTest::fusedSealMatchesAcrossSteps() {
+    ScratchDir dir("hello-qt-format-fused");
+    // Text, then a chunk whose one repeat is flushed (at the smallest step) before the noise
+    // after it overflows the chunk, then text again
+    std::vector<char> data = makeText(PACK_MIN_CHUNK, 13), repeat = makeData(12, 14), noise = makeData(PACK_MIN_CHUNK - 24, 15);
+    data.insert(data.end(), repeat.begin(), repeat.end());
+    data.insert(data.end(), repeat.begin(), repeat.end());
+    data.insert(data.end(), noise.begin(), noise.end());
+    const std::vector<char> more = makeText(2 * PACK_MIN_CHUNK + 100, 16);
+    data.insert(data.end(), more.begin(), more.end());
+    writeFile(dir.path / "f.txt", data);
+    QVERIFY(PackSealBlock() >= PACK_SEAL_BLOCK_MIN && PackSealBlock() <= PACK_SEAL_BLOCK_MAX);
+
+    for (PackCipher cipher : { PackCipher::AesCtr, PackCipher::ChaCha20Poly1305 }) {
+        std::vector<std::pair<uint32_t, uint32_t>> layout;   // stored size and flags per chunk, first run
+        for (uint32_t step : { 8u, 1000u, 0u }) {
+            PackOptions options = smallChunks(cipher);
+            options.compressionLevel = 4;
+            options.sealBlock = step;
+            options.tree = true;
+            PackEngine engine;
+            engine.SetOptions(options);
+            const fs::path out = dir.path / ("out" + std::to_string((int)cipher) + "-" + std::to_string(step));
+            fs::create_directories(out);
+            const auto packed = engine.Pack((dir.path / "f.txt").string(), out.string());
+            QVERIFY(packed.has_value());
+
+            // The step size is invisible in the archive: same chunks, which open and verify
+            PackReader reader;
+            QVERIFY(reader.Open(*packed, options.key).has_value());
+            QCOMPARE(reader.Chunks().size(), size_t(5));
+            QVERIFY(reader.Chunks()[0].flags & PACK_CHUNK_COMPRESSED);
+            QCOMPARE(reader.Chunks()[1].flags, uint32_t(0));
+            QCOMPARE(reader.Chunks()[1].storedSize, uint32_t(PACK_MIN_CHUNK));
+            std::vector<std::pair<uint32_t, uint32_t>> chunks;
+            for (const PackChunk& chunk : reader.Chunks()) chunks.emplace_back(chunk.storedSize, chunk.flags);
+            if (layout.empty()) layout = chunks;
+            QVERIFY(chunks == layout);
+            QVERIFY(engine.Verify(*packed).has_value());
+            QVERIFY(engine.Unpack(*packed, (out / "unpacked").string()).has_value());
+            QVERIFY(readAll(out / "unpacked" / "f.txt") == data);
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(PackFormatTest)
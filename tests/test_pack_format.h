@@ -0,0 +1,29 @@
+#pragma once
+#include <QtTest/QtTest>
+
+class PackFormatTest : public QObject {
+    Q_OBJECT
+private slots:
+    void crc32cCheckValue();
+    void crc32cMatchesBitwise();
+    void directoryRoundTrip();
+    void everyCipherRoundTrips();
+    void extractsOneFileByIndex();
+    void detectsCorruptChunk();
+    void rejectsCorruptIndex();
+    void rejectsForeignFiles();
+    void rejectsUnsafePaths();
+    void matchesPathsAndGlobs();
+    void mappedFileBasics();
+    void chacha20PayloadIsCapped();
+    void streamingAndMappedWriters();
+    void ioBackendsTransfer();
+    void lz77RoundTrips();
+    void compressedPackRoundTrips();
+    void sha256MatchesVectors();
+    void fastCdcCutsFollowContent();
+    void dedupPackStoresChunksOnce();
+    void treeRootCoversChunks();
+    void authenticatedChunksCatchTampering();
+    void fusedSealMatchesAcrossSteps();
+};
@@ -0,0 +1,188 @@
+#include "test_parallel_cipher.h"
+#include "ParallelCipher.h"
+#include "CopyCipher.h"
+#include "ChaCha20Cipher.h"
+#include "AesCtrCipher.h"
+#include "BufferPool.hpp"
+#include <cstring>
+#include <set>
+
+namespace {
+
+const uint8_t kKey[32] = {
+    0x03,0x0a,0x11,0x18,0x1f,0x26,0x2d,0x34,0x3b,0x42,0x49,0x50,0x57,0x5e,0x65,0x6c,
+    0x73,0x7a,0x81,0x88,0x8f,0x96,0x9d,0xa4,0xab,0xb2,0xb9,0xc0,0xc7,0xce,0xd5,0xdc
+};
+const uint8_t kIV[16] = { 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16 };
+
+ChaCha20Cipher makeChaCha() { return ChaCha20Cipher(kKey, kIV); }
+AesCtrCipher makeAes() { return AesCtrCipher(kKey, kIV); }
+
+// Fails on any chunk that contains a 0xEE byte
+enum class PickyError { None, Rejected };
+
+struct PickyCipher {
+    using error_type = PickyError;
+    std::expected<void, error_type> encrypt(std::span<const std::byte> s, std::byte* d) {
+        for (size_t i = 0; i < s.size(); ++i) {
+            if (s[i] == std::byte{0xEE}) return std::unexpected(PickyError::Rejected);
+            d[i] = s[i];
+        }
+        return {};
+    }
+    std::expected<void, error_type> decrypt(std::span<const std::byte> s, std::byte* d) { return encrypt(s, d); }
+    void seek(uint64_t) {}
+};
+
+std::vector<std::byte> pattern(size_t n) {
+    std::vector<std::byte> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = (std::byte)((i * 131 + (i >> 9)) & 0xFF);
+    return v;
+}
+
+} // namespace
+
+static_assert(SeekableCipher<ParallelCipher<ChaCha20Cipher>>);
+static_assert(SeekableCipher<ParallelCipher<AesCtrCipher>>);
+
+template<class CipherType, class Make>
+static bool parallelMatchesSingle(ThreadPool& pool, Make make) {
+    for (size_t size : { size_t(0), size_t(1), size_t(4095), size_t(4096 * 37 + 11) }) {
+        const std::vector<std::byte> plain = pattern(size);
+
+        CipherType single = make();
+        std::vector<std::byte> expected(size);
+        if (!single.encrypt(plain, expected.data())) return false;
+
+        // Odd chunk size so chunk boundaries fall mid-block
+        ParallelCipher<CipherType> engine(make(), pool, 4096 + 5);
+        std::vector<std::byte> got(size);
+        if (!engine.encrypt(plain, got.data()) || got != expected) return false;
+        if (engine.tell() != size) return false;
+
+        // Decrypt in two calls: the engine continues the stream offset
+        ParallelCipher<CipherType> back(make(), pool, 1000);
+        std::vector<std::byte> round(size);
+        const size_t half = size / 2;
+        if (!back.decrypt(std::span<const std::byte>(got.data(), half), round.data())) return false;
+        if (!back.decrypt(std::span<const std::byte>(got.data() + half, size - half), round.data() + half)) return false;
+        if (round != plain) return false;
+    }
+    return true;
+}
+
+void ParallelCipherTest::matchesSingleThreaded() {
+    ThreadPool pool(4);
+    QVERIFY(parallelMatchesSingle<ChaCha20Cipher>(pool, makeChaCha));
+    QVERIFY(parallelMatchesSingle<AesCtrCipher>(pool, makeAes));
+}
+
+void ParallelCipherTest::unkeyedCipherFails() {
+    const std::vector<std::byte> plain = pattern(100);
+    std::vector<std::byte> out(plain.size());
+
+    ChaCha20Cipher chacha;
+    QCOMPARE(chacha.encrypt(plain, out.data()).error(), ChaCha20CipherError::NotKeyed);
+    AesCtrCipher aes;
+    QCOMPARE(aes.decrypt(plain, out.data()).error(), AesCtrCipherError::NotKeyed);
+
+    // A keyed cipher is a real stream cipher: ciphertext differs and decrypts back
+    ChaCha20Cipher enc = makeChaCha(), dec = makeChaCha();
+    QVERIFY(enc.encrypt(plain, out.data()).has_value());
+    QVERIFY(out != plain);
+    std::vector<std::byte> back(plain.size());
+    QVERIFY(dec.decrypt(out, back.data()).has_value());
+    QVERIFY(back == plain);
+}
+
+void ParallelCipherTest::copyCipherPassthrough() {
+    ThreadPool pool(3);
+    const std::vector<std::byte> plain = pattern(100000);
+    ParallelCipher<CopyCipher> engine(CopyCipher{}, pool, 7000);
+    std::vector<std::byte> out(plain.size());
+    QVERIFY(engine.encrypt(plain, out.data()).has_value());
+    QVERIFY(out == plain);
+}
+
+void ParallelCipherTest::copyCipherModes() {
+    // Odd length past the streaming threshold exercises head, body and tail
+    const std::vector<std::byte> plain = pattern(COPY_CIPHER_STREAMING_MIN + 4099);
+    for (CopyCipherMode mode : { CopyCipherMode::ByteByByte, CopyCipherMode::Wide,
+                                 CopyCipherMode::Streaming }) {
+        CopyCipher copy{ mode };
+        for (size_t offset : { size_t(0), size_t(1), size_t(13) }) {
+            std::vector<std::byte> out(plain.size() + offset);
+            QVERIFY(copy.encrypt(plain, out.data() + offset).has_value());
+            QVERIFY(std::equal(plain.begin(), plain.end(), out.begin() + offset));
+        }
+
+        // In place is a no-op; an overlapping shift behaves like memmove
+        std::vector<std::byte> buffer = plain;
+        QVERIFY(copy.decrypt(buffer, buffer.data()).has_value());
+        QVERIFY(buffer == plain);
+        QVERIFY(copy.decrypt(std::span<const std::byte>(buffer).first(plain.size() - 5),
+                             buffer.data() + 5).has_value());
+        QVERIFY(std::equal(plain.begin(), plain.end() - 5, buffer.begin() + 5));
+    }
+}
+
+void ParallelCipherTest::reportsLowestFailingChunk() {
+    ThreadPool pool(4);
+    std::vector<std::byte> plain = pattern(64 * 1024);
+    for (auto& b : plain) if (b == std::byte{0xEE}) b = std::byte{0};
+    plain[10 * 1024 + 3] = std::byte{0xEE};
+    plain[50 * 1024] = std::byte{0xEE};
+
+    ParallelCipher<PickyCipher> engine(PickyCipher{}, pool, 1024);
+    std::vector<std::byte> out(plain.size());
+    const auto result = engine.encrypt(plain, out.data());
+    QVERIFY(!result.has_value());
+    QCOMPARE(result.error(), PickyError::Rejected);
+}
+
+void ParallelCipherTest::nestedParallelFor() {
+    ThreadPool pool(2);
+    std::atomic<size_t> sum(0);
+    pool.ParallelFor(8, [&](size_t i) {
+        pool.ParallelFor(8, [&](size_t j) { sum.fetch_add(i * 8 + j); });
+    });
+    QCOMPARE(sum.load(), size_t(64 * 63 / 2));
+}
+
+void ParallelCipherTest::bufferPoolRecycles() {
+    BufferPool pool(1000, 3);
+    QCOMPARE(pool.BufferSize(), size_t(1024));   // rounded up to whole cache lines
+    QCOMPARE(pool.Arena().size(), size_t(3 * 1024));
+
+    // Exactly Capacity() distinct, aligned buffers inside the arena, then none
+    std::set<std::byte*> seen;
+    {
+        PooledBuffer a = pool.Acquire(), b = pool.Acquire(), c = pool.Acquire();
+        for (const PooledBuffer* p : { &a, &b, &c }) {
+            QVERIFY((uintptr_t)p->Data() % BUFFER_POOL_ALIGNMENT == 0);
+            QVERIFY(p->Data() >= pool.Arena().data() && p->Data() < pool.Arena().data() + pool.Arena().size());
+            seen.insert(p->Data());
+        }
+        QCOMPARE(seen.size(), size_t(3));
+        QVERIFY(!pool.TryAcquire());
+        QCOMPARE(pool.Available(), size_t(0));
+    }
+    QCOMPARE(pool.Available(), size_t(3));
+
+    // Blocked acquirers wake as buffers come back; nothing is ever handed out twice at once
+    ThreadPool threads(4);
+    std::atomic<int> holders(0), worst(0);
+    threads.ParallelFor(64, [&](size_t i) {
+        PooledBuffer buffer = pool.Acquire();
+        const int now = holders.fetch_add(1) + 1;
+        int seenWorst = worst.load();
+        while (now > seenWorst && !worst.compare_exchange_weak(seenWorst, now)) {}
+        std::memset(buffer.Data(), (int)i, buffer.Size());
+        for (size_t k = 0; k < buffer.Size(); ++k) QCOMPARE(buffer.Data()[k], std::byte((uint8_t)i));
+        holders.fetch_sub(1);
+    });
+    QVERIFY(worst.load() <= 3);
+    QCOMPARE(pool.Available(), size_t(3));
+}
+
+QTEST_APPLESS_MAIN(ParallelCipherTest)
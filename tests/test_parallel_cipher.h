@@ -0,0 +1,14 @@
+#pragma once
+#include <QtTest/QtTest>
+
+class ParallelCipherTest : public QObject {
+    Q_OBJECT
+private slots:
+    void matchesSingleThreaded();
+    void unkeyedCipherFails();
+    void copyCipherPassthrough();
+    void copyCipherModes();
+    void reportsLowestFailingChunk();
+    void nestedParallelFor();
+    void bufferPoolRecycles();
+};